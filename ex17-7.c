@@ -1,8 +1,13 @@
 #include <assert.h>
 #include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/file.h>
+#include <time.h>
+#include <unistd.h>
 
 struct Connection *global_conn;
 
@@ -13,15 +18,31 @@ struct Address {
   char *email;
 };
 
+// Rows share seqlock counters in stripes, row `id` uses stripe
+// id % DB_SEQ_STRIPES, so writers to different rows don't make each other's
+// readers retry.
+#define DB_SEQ_STRIPES 64
+
+// Each counter on a cache line of its own, away from its neighbours and
+// from the read-mostly fields every reader loads.
+struct SeqStripe {
+  _Alignas(64) unsigned int seq;
+};
+
 struct Database {
   int max_data;
   int max_rows;
   struct Address *rows;
+  // seqlocks guarding `rows` for in-process readers: odd while a writer is
+  // updating a row, readers retry when it changed under them. Not persisted.
+  struct SeqStripe seqs[DB_SEQ_STRIPES];
 };
 
 struct Connection {
   FILE *file;
   struct Database *db;
+  // serializes in-process writers, readers never take it.
+  pthread_mutex_t write_lock;
 };
 
 void Database_close();
@@ -42,7 +63,14 @@ void Address_print(struct Address *addr) {
   printf("%d %s %s\n", addr->id, addr->name, addr->email);
 }
 
+// Seconds the last Database_load took, the list scan reports it apart from
+// its own rate.
+static double load_seconds = 0;
+
 void Database_load() {
+  struct timespec start, end;
+  clock_gettime(CLOCK_MONOTONIC, &start);
+
   fread(&global_conn->db->max_data, sizeof(int), 1, global_conn->file);
   fread(&global_conn->db->max_rows, sizeof(int), 1, global_conn->file);
 
@@ -62,6 +90,10 @@ void Database_load() {
     fread(addr->name, global_conn->db->max_data, 1, global_conn->file);
     fread(addr->email, global_conn->db->max_data, 1, global_conn->file);
   }
+
+  clock_gettime(CLOCK_MONOTONIC, &end);
+  load_seconds =
+      (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
 }
 
 void Database_open(const char *filename, char mode) {
@@ -69,16 +101,42 @@ void Database_open(const char *filename, char mode) {
   if (!global_conn)
     die("Memory error");
 
-  global_conn->db = malloc(sizeof(struct Database));
+  // everything Database_close looks at is valid before anything can die
+  global_conn->file = NULL;
+  global_conn->db = NULL;
+  pthread_mutex_init(&global_conn->write_lock, NULL);
+
+  // aligned so the seqlock stripes really get a cache line each
+  global_conn->db = aligned_alloc(64, sizeof(struct Database));
   if (!global_conn->db)
     die("Memory error");
 
+  memset(global_conn->db, 0, sizeof(struct Database));
+
+  // Across processes we use flock(2): get/list/read-bench share the file,
+  // create/set/delete hold it exclusively until Database_close.
+  int shared = (mode == 'g' || mode == 'l' || mode == 'r');
+
   if (mode == 'c') {
-    global_conn->file = fopen(filename, "w");
+    // don't truncate with fopen("w") before we own the lock, a concurrent
+    // reader would see a half-written file.
+    int fd = open(filename, O_RDWR | O_CREAT, 0644);
+    if (fd == -1)
+      die("Failed to open the file");
+
+    if (flock(fd, LOCK_EX) == -1 || ftruncate(fd, 0) == -1) {
+      close(fd);
+      die("Failed to lock the file");
+    }
+
+    global_conn->file = fdopen(fd, "w");
   } else {
     global_conn->file = fopen(filename, "r+");
 
     if (global_conn->file) {
+      if (flock(fileno(global_conn->file), shared ? LOCK_SH : LOCK_EX) == -1)
+        die("Failed to lock the file");
+
       Database_load();
     }
   }
@@ -89,6 +147,7 @@ void Database_open(const char *filename, char mode) {
 
 void Database_close() {
   if (global_conn) {
+    // closing the last fd also drops the flock
     if (global_conn->file)
       fclose(global_conn->file);
     if (global_conn->db) {
@@ -101,6 +160,7 @@ void Database_close() {
       }
       free(global_conn->db);
     }
+    pthread_mutex_destroy(&global_conn->write_lock);
     free(global_conn);
   }
 }
@@ -141,56 +201,393 @@ void Database_create(int max_data, int max_rows) {
   }
 }
 
+static inline unsigned int *Database_seq(int id) {
+  return &global_conn->db->seqs[id % DB_SEQ_STRIPES].seq;
+}
+
+// Tells the CPU we're spinning, so it backs off the pipeline and leaves the
+// core to its sibling hyperthread, which may be the writer we wait for.
+static inline void cpu_relax() {
+#if defined(__x86_64__) || defined(__i386__)
+  __builtin_ia32_pause();
+#elif defined(__aarch64__)
+  __asm__ __volatile__("yield");
+#else
+  __asm__ __volatile__("" : : : "memory");
+#endif
+}
+
+static void Database_write_begin(int id) {
+  unsigned int *seq = Database_seq(id);
+
+  pthread_mutex_lock(&global_conn->write_lock);
+  __atomic_store_n(seq, *seq + 1, __ATOMIC_RELAXED);
+  __atomic_thread_fence(__ATOMIC_RELEASE);
+}
+
+static void Database_write_end(int id) {
+  unsigned int *seq = Database_seq(id);
+
+  __atomic_store_n(seq, *seq + 1, __ATOMIC_RELEASE);
+  pthread_mutex_unlock(&global_conn->write_lock);
+}
+
+static unsigned int Database_read_begin(int id) {
+  unsigned int *stripe = Database_seq(id);
+  unsigned int seq;
+
+  // an odd sequence means a writer is in the middle of an update
+  while ((seq = __atomic_load_n(stripe, __ATOMIC_ACQUIRE)) & 1)
+    cpu_relax();
+
+  return seq;
+}
+
+static int Database_read_retry(int id, unsigned int seq) {
+  __atomic_thread_fence(__ATOMIC_ACQUIRE);
+  return __atomic_load_n(Database_seq(id), __ATOMIC_RELAXED) != seq;
+}
+
+// Rows are updated in place (never reallocated) so a reader racing with a
+// writer only ever sees stale bytes, which the seqlock makes it retry.
+static void Database_update_row(int id, int set, const char *name,
+                                const char *email) {
+  struct Address *addr = &global_conn->db->rows[id];
+  int max_data = global_conn->db->max_data;
+
+  Database_write_begin(id);
+
+  memset(addr->name, 0, max_data);
+  memset(addr->email, 0, max_data);
+  if (set) {
+    strncpy(addr->name, name, max_data - 1);
+    strncpy(addr->email, email, max_data - 1);
+  }
+  addr->set = set;
+
+  Database_write_end(id);
+}
+
+/**
+ * Copy row `id` into `out`, whose name/email must point at buffers of at least
+ * max_data bytes. Safe to call from many threads while another thread writes.
+ *
+ * @return the row's `set` flag.
+ */
+int Database_read_row(int id, struct Address *out) {
+  struct Address *addr = &global_conn->db->rows[id];
+  int max_data = global_conn->db->max_data;
+  unsigned int seq;
+
+  do {
+    seq = Database_read_begin(id);
+
+    out->id = addr->id;
+    out->set = addr->set;
+    memcpy(out->name, addr->name, max_data);
+    memcpy(out->email, addr->email, max_data);
+  } while (Database_read_retry(id, seq));
+
+  out->name[max_data - 1] = '\0';
+  out->email[max_data - 1] = '\0';
+
+  return out->set;
+}
+
 void Database_set(int id, const char *name, const char *email) {
   struct Address *addr = &global_conn->db->rows[id];
   if (addr->set)
     die("Already set, delete it first");
 
-  addr->set = 1;
-  char *res = strncpy(addr->name, name, global_conn->db->max_data);
-  if (!res)
-    die("Name copy failed");
-  else
-    res[global_conn->db->max_data - 1] = '\0';
-
-  res = strncpy(addr->email, email, global_conn->db->max_data - 1);
-  if (!res)
-    die("Email copy failed");
-  else
-    res[global_conn->db->max_data - 1] = '\0';
+  Database_update_row(id, 1, name, email);
 }
 
 void Database_get(int id) {
-  struct Address *addr = &global_conn->db->rows[id];
+  int max_data = global_conn->db->max_data;
+  char name[max_data];
+  char email[max_data];
+  struct Address addr = {.name = name, .email = email};
 
-  if (addr->set) {
-    Address_print(addr);
+  if (Database_read_row(id, &addr)) {
+    Address_print(&addr);
   } else {
     die("ID is not set");
   }
 }
 
-void Database_delete(int id) {
-  struct Address addr = {.id = id, .set = 0};
-  addr.name = malloc(global_conn->db->max_data);
-  addr.email = malloc(global_conn->db->max_data);
-  if (!addr.name || !addr.email)
-    die("Memory error");
+void Database_delete(int id) { Database_update_row(id, 0, NULL, NULL); }
+
+// Rows per scan chunk. Threads claim chunks in order and at most
+// LIST_WINDOW chunks per thread are scanned ahead of the output, so the
+// matches held in memory stay bounded however many rows match.
+#define LIST_CHUNK_ROWS 1024
+#define LIST_WINDOW 2
+
+// Output of one chunk, formatted by the thread that scanned it and written
+// to stdout once every chunk before it was.
+struct ListChunk {
+  char *out;
+  size_t out_len;
+  size_t out_cap;
+  int done;
+};
+
+struct ListScan {
+  pthread_mutex_t lock;
+  pthread_cond_t flushed_cond;
+  const char *pattern;
+  int chunks;
+  int next;    // Next chunk to claim.
+  int flushed; // Chunks written out, always a prefix.
+  int window;
+  struct ListChunk *slots; // Chunk c is formatted into slots[c % window].
+};
+
+// `pattern` matches a row when it is a substring of its name or email, a
+// leading '^' turns it into a prefix match. NULL matches every row.
+static int Address_match(struct Address *addr, const char *pattern) {
+  if (pattern == NULL)
+    return 1;
+
+  if (pattern[0] == '^') {
+    size_t len = strlen(pattern + 1);
+    return strncmp(addr->name, pattern + 1, len) == 0 ||
+           strncmp(addr->email, pattern + 1, len) == 0;
+  }
+
+  return strstr(addr->name, pattern) != NULL ||
+         strstr(addr->email, pattern) != NULL;
+}
+
+static void ListChunk_append(struct ListChunk *chunk, struct Address *addr) {
+  // "<id> <name> <email>\n" fits in two max_data strings plus the id
+  size_t need = 2 * global_conn->db->max_data + 16;
 
-  free(global_conn->db->rows[id].name);
-  free(global_conn->db->rows[id].email);
+  if (chunk->out_len + need > chunk->out_cap) {
+    size_t cap = chunk->out_cap ? chunk->out_cap * 2 : 64 * 1024;
+    while (cap < chunk->out_len + need)
+      cap *= 2;
 
-  global_conn->db->rows[id] = addr;
+    char *out = realloc(chunk->out, cap);
+    if (!out)
+      die("Memory error");
+
+    chunk->out = out;
+    chunk->out_cap = cap;
+  }
+
+  chunk->out_len += snprintf(chunk->out + chunk->out_len,
+                             chunk->out_cap - chunk->out_len, "%d %s %s\n",
+                             addr->id, addr->name, addr->email);
 }
 
-void Database_list() {
-  for (int i = 0; i < global_conn->db->max_rows; i++) {
-    struct Address *cur = &global_conn->db->rows[i];
+static void *Database_list_scan(void *arg) {
+  struct ListScan *scan = arg;
+  int max_rows = global_conn->db->max_rows;
+  int max_data = global_conn->db->max_data;
+  char name[max_data];
+  char email[max_data];
+  struct Address addr = {.name = name, .email = email};
+
+  pthread_mutex_lock(&scan->lock);
+
+  for (;;) {
+    // don't run further ahead of the output than the window
+    while (scan->next < scan->chunks &&
+           scan->next - scan->flushed >= scan->window)
+      pthread_cond_wait(&scan->flushed_cond, &scan->lock);
+
+    if (scan->next == scan->chunks)
+      break;
+
+    int c = scan->next++;
+    struct ListChunk *chunk = &scan->slots[c % scan->window];
+    pthread_mutex_unlock(&scan->lock);
+
+    int end = (c + 1) * LIST_CHUNK_ROWS < max_rows ? (c + 1) * LIST_CHUNK_ROWS
+                                                   : max_rows;
+    for (int i = c * LIST_CHUNK_ROWS; i < end; i++) {
+      // skip the seqlock copy for unset rows, racing a writer here is the
+      // same as having scanned the row just before it was set.
+      if (!__atomic_load_n(&global_conn->db->rows[i].set, __ATOMIC_RELAXED))
+        continue;
+
+      if (Database_read_row(i, &addr) && Address_match(&addr, scan->pattern))
+        ListChunk_append(chunk, &addr);
+    }
 
-    if (cur->set) {
-      Address_print(cur);
+    pthread_mutex_lock(&scan->lock);
+    chunk->done = 1;
+
+    // whoever finishes the oldest chunk writes out every finished one after
+    // it, the slots are free to be claimed again
+    struct ListChunk *front = &scan->slots[scan->flushed % scan->window];
+    if (front->done) {
+      while (scan->flushed < scan->next && front->done) {
+        if (front->out_len > 0)
+          fwrite(front->out, 1, front->out_len, stdout);
+        front->out_len = 0;
+        front->done = 0;
+        scan->flushed++;
+        front = &scan->slots[scan->flushed % scan->window];
+      }
+      pthread_cond_broadcast(&scan->flushed_cond);
     }
   }
+
+  pthread_mutex_unlock(&scan->lock);
+  return NULL;
+}
+
+/**
+ * List the set rows matching `pattern` (see Address_match), scanning with
+ * `threads` threads. Rows are scanned in chunks whose output is written in
+ * row order with one fwrite each, instead of a printf per row. The scan
+ * rate is reported on stderr, next to the time Database_open took to load
+ * the rows.
+ */
+void Database_list(int threads, const char *pattern) {
+  int max_rows = global_conn->db->max_rows;
+  struct ListScan scan = {.pattern = pattern};
+  struct timespec start, end;
+
+  scan.chunks = (max_rows + LIST_CHUNK_ROWS - 1) / LIST_CHUNK_ROWS;
+  if (threads > scan.chunks)
+    threads = scan.chunks;
+  if (threads < 1)
+    threads = 1;
+  scan.window = threads * LIST_WINDOW;
+
+  pthread_t *workers = calloc(threads, sizeof(pthread_t));
+  scan.slots = calloc(scan.window, sizeof(struct ListChunk));
+  if (!workers || !scan.slots)
+    die("Memory error");
+
+  pthread_mutex_init(&scan.lock, NULL);
+  pthread_cond_init(&scan.flushed_cond, NULL);
+
+  clock_gettime(CLOCK_MONOTONIC, &start);
+
+  int started = 0;
+  if (threads > 1) {
+    // the chunks are shared out, so whichever threads started finish them
+    while (started < threads &&
+           pthread_create(&workers[started], NULL, Database_list_scan,
+                          &scan) == 0)
+      started++;
+  }
+  if (started == 0)
+    Database_list_scan(&scan);
+  threads = started > 0 ? started : 1;
+
+  for (int i = 0; i < started; i++) {
+    if (pthread_join(workers[i], NULL) != 0)
+      die("Failed to join a list thread.");
+  }
+  fflush(stdout);
+
+  clock_gettime(CLOCK_MONOTONIC, &end);
+
+  double elapsed =
+      (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+  fprintf(stderr,
+          "loaded %d rows in %.3fs, then scanned them with %d threads in "
+          "%.3fs, %.0f rows/s (scan only)\n",
+          max_rows, load_seconds, threads, elapsed,
+          elapsed > 0 ? max_rows / elapsed : 0);
+
+  for (int i = 0; i < scan.window; i++)
+    free(scan.slots[i].out);
+  free(scan.slots);
+  free(workers);
+  pthread_cond_destroy(&scan.flushed_cond);
+  pthread_mutex_destroy(&scan.lock);
+}
+
+// One per reader, on cache lines of its own so the readers' results don't
+// bounce a shared line between them.
+struct ReadBench {
+  _Alignas(64) pthread_t thread;
+  unsigned int seed;
+  long lookups;
+  long hits;
+};
+
+static volatile int read_bench_done = 0;
+
+static void *Database_read_bench_reader(void *arg) {
+  struct ReadBench *bench = arg;
+  int max_data = global_conn->db->max_data;
+  char name[max_data];
+  char email[max_data];
+  struct Address addr = {.name = name, .email = email};
+  unsigned int seed = bench->seed;
+  long hits = 0;
+
+  for (long i = 0; i < bench->lookups; i++) {
+    int id = rand_r(&seed) % global_conn->db->max_rows;
+    hits += Database_read_row(id, &addr);
+  }
+
+  bench->hits = hits;
+  return NULL;
+}
+
+// Keeps one row flipping while the readers run, the updates stay in memory
+// since we only hold a shared lock on the file.
+static void *Database_read_bench_writer(void *arg) {
+  (void)arg;
+  int id = global_conn->db->max_rows - 1;
+
+  while (!__atomic_load_n(&read_bench_done, __ATOMIC_RELAXED)) {
+    Database_update_row(id, 1, "writer", "writer@example.com");
+    Database_update_row(id, 0, NULL, NULL);
+  }
+
+  return NULL;
+}
+
+void Database_read_bench(int threads, long lookups) {
+  struct ReadBench *benches =
+      aligned_alloc(64, threads * sizeof(struct ReadBench));
+  pthread_t writer;
+  struct timespec start, end;
+  long hits = 0;
+
+  if (!benches)
+    die("Memory error");
+  memset(benches, 0, threads * sizeof(struct ReadBench));
+
+  clock_gettime(CLOCK_MONOTONIC, &start);
+
+  if (pthread_create(&writer, NULL, Database_read_bench_writer, NULL) != 0)
+    die("Failed to start the writer.");
+  for (int i = 0; i < threads; i++) {
+    benches[i].seed = i + 1;
+    benches[i].lookups = lookups / threads;
+    if (pthread_create(&benches[i].thread, NULL, Database_read_bench_reader,
+                       &benches[i]) != 0)
+      die("Failed to start a reader.");
+  }
+
+  for (int i = 0; i < threads; i++) {
+    if (pthread_join(benches[i].thread, NULL) != 0)
+      die("Failed to join a reader.");
+    hits += benches[i].hits;
+  }
+
+  clock_gettime(CLOCK_MONOTONIC, &end);
+  __atomic_store_n(&read_bench_done, 1, __ATOMIC_RELAXED);
+  if (pthread_join(writer, NULL) != 0)
+    die("Failed to join the writer.");
+
+  double elapsed =
+      (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+  long total = (lookups / threads) * threads;
+  printf("%d threads: %ld lookups (%ld set) in %.3fs, %.0f lookups/s\n",
+         threads, total, hits, elapsed, total / elapsed);
+
+  free(benches);
 }
 
 int main(int argc, char *argv[]) {
@@ -242,11 +639,27 @@ int main(int argc, char *argv[]) {
     break;
 
   case 'l':
-    Database_list();
+    if (argc > 5)
+      die("Need at most threads and a pattern to list");
+
+    Database_list(argc > 3 ? atoi(argv[3]) : 1, argc > 4 ? argv[4] : NULL);
+    break;
+
+  case 'r':
+    if (argc != 5)
+      die("Need threads and lookups to run the read benchmark");
+
+    int threads = atoi(argv[3]);
+    long lookups = atol(argv[4]);
+    if (threads <= 0 || lookups <= 0)
+      die("threads and lookups must be greater than 0");
+
+    Database_read_bench(threads, lookups);
     break;
 
   default:
-    die("Invalid action, only: c=create, g=get, s=set, d=del, l=list");
+    die("Invalid action, only: c=create, g=get, s=set, d=del, l=list, "
+        "r=read bench");
   }
 
   Database_close();
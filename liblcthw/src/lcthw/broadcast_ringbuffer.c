@@ -0,0 +1,227 @@
+#include <lcthw/broadcast_ringbuffer.h>
+#include <lcthw/dbg.h>
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+
+BroadcastRingBuffer *BroadcastRingBuffer_create(size_t capacity,
+                                                int consumers, int flags) {
+  BroadcastRingBuffer *ring = NULL;
+
+  check(consumers > 0, "Need at least one consumer, not %d.", consumers);
+  check(posix_memalign((void **)&ring, 64, sizeof(*ring)) == 0,
+        "Out of memory.");
+  memset(ring, 0, sizeof(*ring));
+
+  check(posix_memalign((void **)&ring->cursors, 64,
+                       sizeof(BroadcastCursor) * consumers) == 0,
+        "Out of memory.");
+  memset(ring->cursors, 0, sizeof(BroadcastCursor) * consumers);
+
+  ring->ring = PosixRingBuffer_create_pow2(capacity);
+  check(ring->ring != NULL, "Failed to map the ring.");
+
+  ring->buffer = ring->ring->buffer;
+  ring->capacity = ring->ring->capacity;
+  ring->mask = ring->ring->mask;
+  ring->flags = flags;
+  ring->consumers = consumers;
+  WaitQueue_init(&ring->data, 0);
+  WaitQueue_init(&ring->space, 0);
+
+  return ring;
+
+error:
+  BroadcastRingBuffer_destroy(ring);
+  return NULL;
+}
+
+void BroadcastRingBuffer_destroy(BroadcastRingBuffer *ring) {
+  if (ring) {
+    PosixRingBuffer_destroy(ring->ring);
+    free(ring->cursors);
+    free(ring);
+  }
+}
+
+static inline int BroadcastRingBuffer_clamp(uint64_t n) {
+  return n > INT_MAX ? INT_MAX : (int)n;
+}
+
+// Head of the slowest consumer still in, `tail` when they were all dropped.
+// A consumer rejoining stores its head before it clears `dropped`, so a
+// cleared flag comes with the new head.
+static uint64_t BroadcastRingBuffer_slowest(BroadcastRingBuffer *ring,
+                                            uint64_t tail) {
+  uint64_t slowest = tail;
+
+  for (int i = 0; i < ring->consumers; i++) {
+    BroadcastCursor *cursor = &ring->cursors[i];
+    if (!__atomic_load_n(&cursor->dropped, __ATOMIC_ACQUIRE)) {
+      uint64_t head = __atomic_load_n(&cursor->head, __ATOMIC_ACQUIRE);
+      if (tail - head > tail - slowest) {
+        slowest = head;
+      }
+    }
+  }
+
+  return slowest;
+}
+
+// Marks every consumer that hasn't read up to `need` dropped. The flags are
+// visible before any overwriting store, so a consumer that checks its flag
+// after copying knows whether its copy is intact.
+static void BroadcastRingBuffer_drop(BroadcastRingBuffer *ring, uint64_t need) {
+  for (int i = 0; i < ring->consumers; i++) {
+    BroadcastCursor *cursor = &ring->cursors[i];
+    uint64_t head = __atomic_load_n(&cursor->head, __ATOMIC_ACQUIRE);
+    if ((int64_t)(need - head) > 0) {
+      __atomic_store_n(&cursor->dropped, 1, __ATOMIC_RELAXED);
+    }
+  }
+  __atomic_thread_fence(__ATOMIC_SEQ_CST);
+}
+
+int BroadcastRingBuffer_write(BroadcastRingBuffer *ring, const char *data,
+                              int length) {
+  uint64_t tail = ring->tail;
+
+  check(length >= 0 && (size_t)length <= ring->capacity,
+        "Write of %d bytes can't fit a %zu byte ring.", length, ring->capacity);
+
+  if (tail + length - ring->gate > ring->capacity) {
+    ring->gate = BroadcastRingBuffer_slowest(ring, tail);
+
+    if (tail + length - ring->gate > ring->capacity) {
+      if (!(ring->flags & BROADCAST_DROP_SLOW)) {
+        return 0;
+      }
+      BroadcastRingBuffer_drop(ring, tail + length - ring->capacity);
+      ring->gate = BroadcastRingBuffer_slowest(ring, tail);
+    }
+  }
+
+  memcpy(ring->buffer + (tail & ring->mask), data, length);
+  __atomic_store_n(&ring->tail, tail + length, __ATOMIC_RELEASE);
+
+  WaitQueue_wake(&ring->data);
+  return length;
+
+error:
+  return -1;
+}
+
+int BroadcastRingBuffer_available(BroadcastRingBuffer *ring, int consumer) {
+  BroadcastCursor *cursor = &ring->cursors[consumer];
+
+  if (__atomic_load_n(&cursor->dropped, __ATOMIC_ACQUIRE)) {
+    return -1;
+  }
+  return BroadcastRingBuffer_clamp(
+      __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE) - cursor->head);
+}
+
+int BroadcastRingBuffer_peek(BroadcastRingBuffer *ring, int consumer,
+                             const char **data) {
+  BroadcastCursor *cursor = &ring->cursors[consumer];
+  int available = BroadcastRingBuffer_available(ring, consumer);
+
+  *data = ring->buffer + (cursor->head & ring->mask);
+  return available;
+}
+
+int BroadcastRingBuffer_consume(BroadcastRingBuffer *ring, int consumer,
+                                int amount) {
+  BroadcastCursor *cursor = &ring->cursors[consumer];
+
+  // the writer raised the flag before it overwrote anything read so far
+  __atomic_thread_fence(__ATOMIC_ACQUIRE);
+  if (__atomic_load_n(&cursor->dropped, __ATOMIC_RELAXED)) {
+    return -1;
+  }
+  check(amount >= 0 &&
+            (uint64_t)amount <=
+                __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE) - cursor->head,
+        "Consumer %d can't consume %d bytes it doesn't have.", consumer,
+        amount);
+
+  __atomic_store_n(&cursor->head, cursor->head + amount, __ATOMIC_RELEASE);
+  if (!(ring->flags & BROADCAST_DROP_SLOW)) {
+    WaitQueue_wake(&ring->space);
+  }
+  return amount;
+
+error:
+  return -1;
+}
+
+int BroadcastRingBuffer_read(BroadcastRingBuffer *ring, int consumer,
+                             char *target, int amount) {
+  const char *data = NULL;
+  int available = BroadcastRingBuffer_peek(ring, consumer, &data);
+
+  if (available < 0) {
+    return -1;
+  }
+  if (amount > available) {
+    amount = available;
+  }
+
+  memcpy(target, data, amount);
+  return BroadcastRingBuffer_consume(ring, consumer, amount);
+}
+
+void BroadcastRingBuffer_rejoin(BroadcastRingBuffer *ring, int consumer) {
+  BroadcastCursor *cursor = &ring->cursors[consumer];
+
+  __atomic_store_n(&cursor->head,
+                   __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE),
+                   __ATOMIC_RELEASE);
+  __atomic_store_n(&cursor->dropped, 0, __ATOMIC_RELEASE);
+}
+
+typedef struct {
+  BroadcastRingBuffer *ring;
+  int consumer;
+} BroadcastWaiter;
+
+// WaitQueue_count adapters, a dropped consumer has nothing left to wait for.
+static int BroadcastRingBuffer_data_count(void *ctx) {
+  BroadcastWaiter *waiter = ctx;
+  int available = BroadcastRingBuffer_available(waiter->ring, waiter->consumer);
+  return available < 0 ? INT_MAX : available;
+}
+
+static int BroadcastRingBuffer_space_count(void *ctx) {
+  BroadcastRingBuffer *ring = ctx;
+  uint64_t tail = ring->tail;
+  return BroadcastRingBuffer_clamp(
+      ring->capacity - (tail - BroadcastRingBuffer_slowest(ring, tail)));
+}
+
+int BroadcastRingBuffer_wait_data(BroadcastRingBuffer *ring, int consumer,
+                                  int amount, int timeout_ms) {
+  BroadcastWaiter waiter = {ring, consumer};
+
+  check(amount > 0 && (size_t)amount <= ring->capacity,
+        "Can't wait for %d bytes of a %zu byte ring.", amount, ring->capacity);
+  if (WaitQueue_wait(&ring->data, BroadcastRingBuffer_data_count, &waiter,
+                     amount, timeout_ms) < 0) {
+    return -2;
+  }
+  return BroadcastRingBuffer_available(ring, consumer);
+
+error:
+  return -2;
+}
+
+int BroadcastRingBuffer_wait_space(BroadcastRingBuffer *ring, int amount,
+                                   int timeout_ms) {
+  check(amount > 0 && (size_t)amount <= ring->capacity,
+        "Can't wait for %d bytes of a %zu byte ring.", amount, ring->capacity);
+  return WaitQueue_wait(&ring->space, BroadcastRingBuffer_space_count, ring,
+                        amount, timeout_ms);
+
+error:
+  return -1;
+}
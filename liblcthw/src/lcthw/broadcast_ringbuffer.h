@@ -0,0 +1,125 @@
+#ifndef lcthw_BroadcastRingBuffer_h
+#define lcthw_BroadcastRingBuffer_h
+
+#include <lcthw/posix_ringbuffer.h>
+#include <lcthw/waitq.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// BroadcastRingBuffer_create flags
+#define BROADCAST_DROP_SLOW 0x1 // Overtake consumers that fall a ring behind
+
+/**
+ * One consumer's position, on its own cache line so consumers don't slow
+ * each other down.
+ */
+typedef struct BroadcastCursor {
+  _Alignas(64) uint64_t head; // Bytes this consumer has read.
+  int dropped; // Set by the writer when it overtook this consumer.
+} BroadcastCursor;
+
+/**
+ * One writer, many readers, one copy: the writer publishes each write once
+ * into a mirrored power-of-two region and every consumer reads the same
+ * bytes at its own cursor, so fanning a stream out to N consumers costs one
+ * memcpy instead of N rings and N copies.
+ *
+ * By default the writer is gated by the slowest consumer: a write that
+ * would overwrite bytes someone hasn't read yet doesn't happen. With
+ * BROADCAST_DROP_SLOW it never waits, it marks such consumers dropped and
+ * goes ahead; they get -1 from then on until they rejoin at the newest
+ * data. The writer caches the slowest cursor and only scans them all when
+ * that cache says it's out of space.
+ *
+ * Safe for one writer thread and one thread per consumer.
+ */
+typedef struct BroadcastRingBuffer {
+  PosixRingBuffer *ring; // The mirrored mapping, its own indices unused.
+  char *buffer;
+  uint64_t mask;
+  size_t capacity;
+  int flags;
+  int consumers;
+  BroadcastCursor *cursors;
+
+  _Alignas(64) uint64_t tail; // Bytes written so far.
+  uint64_t gate; // Writer's cached head of the slowest consumer.
+
+  WaitQueue data;  // Consumers sleep here.
+  WaitQueue space; // The writer sleeps here.
+} BroadcastRingBuffer;
+
+/**
+ * Creates a ring of at least `capacity` bytes, rounded up to a power of
+ * two of at least a page, read by `consumers` consumers numbered from 0.
+ */
+BroadcastRingBuffer *BroadcastRingBuffer_create(size_t capacity,
+                                                int consumers, int flags);
+
+void BroadcastRingBuffer_destroy(BroadcastRingBuffer *ring);
+
+/**
+ * Writer side: publishes all of `data` to every consumer.
+ *
+ * @return `length`, 0 if the slowest consumer leaves no room for it (never
+ * with BROADCAST_DROP_SLOW), -1 if it could never fit.
+ */
+int BroadcastRingBuffer_write(BroadcastRingBuffer *ring, const char *data,
+                              int length);
+
+/**
+ * @return the bytes `consumer` can read, -1 if it was dropped.
+ */
+int BroadcastRingBuffer_available(BroadcastRingBuffer *ring, int consumer);
+
+/**
+ * Copies up to `amount` bytes out for `consumer` and moves its cursor.
+ *
+ * @return the bytes read, -1 if it was dropped (possibly during the copy,
+ * `target` is then garbage).
+ */
+int BroadcastRingBuffer_read(BroadcastRingBuffer *ring, int consumer,
+                             char *target, int amount);
+
+/**
+ * Points `*data` at what `consumer` can read, contiguous thanks to the
+ * mirror, without moving its cursor. Under BROADCAST_DROP_SLOW the writer
+ * may overwrite it at any time, BroadcastRingBuffer_consume tells.
+ *
+ * @return the bytes there, -1 if it was dropped.
+ */
+int BroadcastRingBuffer_peek(BroadcastRingBuffer *ring, int consumer,
+                             const char **data);
+
+/**
+ * Moves `consumer` past `amount` bytes it read in place.
+ *
+ * @return `amount`, -1 if it was dropped, before or while it read them, or
+ * if `amount` is negative or more than it has.
+ */
+int BroadcastRingBuffer_consume(BroadcastRingBuffer *ring, int consumer,
+                                int amount);
+
+/**
+ * Puts a dropped `consumer` back in, skipping to the newest data.
+ */
+void BroadcastRingBuffer_rejoin(BroadcastRingBuffer *ring, int consumer);
+
+/**
+ * Consumer side: waits until `consumer` can read `amount` bytes or is
+ * dropped, for at most `timeout_ms` (negative waits forever).
+ *
+ * @return as BroadcastRingBuffer_available, -2 on timeout.
+ */
+int BroadcastRingBuffer_wait_data(BroadcastRingBuffer *ring, int consumer,
+                                  int amount, int timeout_ms);
+
+/**
+ * Writer side: waits until `amount` bytes can be written.
+ *
+ * @return the bytes of space, -1 on timeout.
+ */
+int BroadcastRingBuffer_wait_space(BroadcastRingBuffer *ring, int amount,
+                                   int timeout_ms);
+
+#endif
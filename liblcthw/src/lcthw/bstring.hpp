@@ -0,0 +1,130 @@
+#ifndef lcthw_BString_hpp
+#define lcthw_BString_hpp
+
+#include <lcthw/bstrlib.h>
+#include <new>
+#include <string_view>
+#include <utility>
+
+namespace lcthw {
+
+/**
+ * Owning C++ handle on a bstring. Converts to std::string_view without a
+ * copy, copies with bstrcpy and moves by taking the pointer. Building one
+ * from text allocates, so those constructors are explicit.
+ */
+class BString {
+public:
+  BString() : BString(std::string_view()) {}
+
+  explicit BString(std::string_view text)
+      : b_(blk2bstr(text.data() != nullptr ? text.data() : "",
+                    static_cast<int>(text.size()))) {
+    if (b_ == nullptr) {
+      throw std::bad_alloc();
+    }
+  }
+
+  explicit BString(const char *text) : BString(std::string_view(text)) {}
+
+  /**
+   * Takes ownership of `b`, which may be NULL.
+   */
+  static BString adopt(bstring b) noexcept {
+    BString s(nullptr, 0);
+    s.b_ = b;
+    return s;
+  }
+
+  BString(const BString &other) : b_(bstrcpy(other.b_)) {
+    if (b_ == nullptr && other.b_ != nullptr) {
+      throw std::bad_alloc();
+    }
+  }
+
+  BString &operator=(const BString &other) {
+    BString copy(other);
+    swap(copy);
+    return *this;
+  }
+
+  BString(BString &&other) noexcept : b_(std::exchange(other.b_, nullptr)) {}
+
+  BString &operator=(BString &&other) noexcept {
+    swap(other);
+    return *this;
+  }
+
+  ~BString() { bdestroy(b_); }
+
+  void swap(BString &other) noexcept { std::swap(b_, other.b_); }
+
+  BString &operator+=(std::string_view text) {
+    if (bcatblk(b_, text.data(), static_cast<int>(text.size())) != BSTR_OK) {
+      throw std::bad_alloc();
+    }
+    return *this;
+  }
+
+  std::string_view view() const {
+    return std::string_view(data(), size());
+  }
+  operator std::string_view() const { return view(); }
+
+  // bstrlib keeps a NUL after the data
+  const char *c_str() const { return b_ != nullptr ? data() : ""; }
+  const char *data() const { return bdata(b_); }
+  char *data() { return bdata(b_); }
+  std::size_t size() const { return blength(b_); }
+  bool empty() const { return blength(b_) == 0; }
+
+  char &operator[](std::size_t i) { return data()[i]; }
+  char operator[](std::size_t i) const { return data()[i]; }
+
+  char *begin() { return data(); }
+  char *end() { return data() + size(); }
+  const char *begin() const { return data(); }
+  const char *end() const { return data() + size(); }
+
+  /**
+   * The underlying bstring, still owned by this object.
+   */
+  bstring get() const { return b_; }
+
+  /**
+   * Gives up ownership, the caller must bdestroy the result.
+   */
+  bstring release() { return std::exchange(b_, nullptr); }
+
+  friend bool operator==(const BString &a, const BString &b) {
+    return a.view() == b.view();
+  }
+  friend bool operator==(const BString &a, std::string_view b) {
+    return a.view() == b;
+  }
+  friend bool operator==(std::string_view a, const BString &b) {
+    return a == b.view();
+  }
+  friend bool operator!=(const BString &a, const BString &b) {
+    return !(a == b);
+  }
+  friend bool operator!=(const BString &a, std::string_view b) {
+    return !(a == b);
+  }
+  friend bool operator!=(std::string_view a, const BString &b) {
+    return !(a == b);
+  }
+  friend bool operator<(const BString &a, const BString &b) {
+    return a.view() < b.view();
+  }
+
+private:
+  // Empty handle, for adopt.
+  BString(std::nullptr_t, int) noexcept : b_(nullptr) {}
+
+  bstring b_;
+};
+
+} // namespace lcthw
+
+#endif
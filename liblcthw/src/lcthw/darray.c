@@ -52,24 +52,32 @@ void DArray_clear(DArray *array) {
   array->end = 0;
 }
 
-// Expand the dynamic array when needed
-int DArray_expand(DArray *array) {
-  size_t old_max = array->max;
-  array->max += array->expand_rate;
+// Grow the contents to `max` slots, zeroing the new ones
+int DArray_resize(DArray *array, int max) {
+  int old_max = array->max;
+  check(max > array->end, "Can't resize to %d below end %d.", max, array->end);
 
-  void **contents = realloc(array->contents, array->max * sizeof(void *));
+  void **contents = realloc(array->contents, max * sizeof(void *));
   check(contents != NULL, "Failed to expand DArray.");
 
   array->contents = contents;
+  array->max = max;
 
   // initialize newly allocated memory
-  memset(array->contents + old_max, 0, array->expand_rate * sizeof(void *));
+  if (max > old_max) {
+    memset(array->contents + old_max, 0, (max - old_max) * sizeof(void *));
+  }
   return 0;
 
 error:
   return -1;
 }
 
+// Expand the dynamic array when needed
+int DArray_expand(DArray *array) {
+  return DArray_resize(array, array->max + array->expand_rate);
+}
+
 // Contract the dynamic array to save memory
 int DArray_contract(DArray *array) {
   // keep at least the expand rate amount of slots
@@ -119,6 +127,49 @@ error:
   return NULL;
 }
 
+// Push `n` elements with one resize and one copy
+int DArray_push_n(DArray *array, void **els, int n) {
+  if (n <= 0) {
+    return 0;
+  }
+
+  // keeps the empty slot after `end` that DArray_push relies on. Batches
+  // grow the array geometrically, adding expand_rate slots per batch would
+  // make steady batch pushes realloc almost every time.
+  if (array->end + n >= array->max) {
+    int max = array->end + n + array->expand_rate;
+    if (max < array->max * 2) {
+      max = array->max * 2;
+    }
+    check(DArray_resize(array, max) == 0, "Failed to expand DArray.");
+  }
+
+  memcpy(array->contents + array->end, els, n * sizeof(void *));
+  array->end += n;
+
+  return 0;
+
+error:
+  return -1;
+}
+
+// Pop up to `n` elements in one copy, they keep their order in the array
+int DArray_pop_n(DArray *array, void **els, int n) {
+  int taken = n < array->end ? n : array->end;
+
+  if (taken <= 0) {
+    return 0;
+  }
+
+  array->end -= taken;
+  memcpy(els, array->contents + array->end, taken * sizeof(void *));
+
+  // popped slots go back to NULL, as DArray_remove leaves them
+  memset(array->contents + array->end, 0, taken * sizeof(void *));
+
+  return taken;
+}
+
 // Clear and destroy the dynamic array
 void DArray_clear_destroy(DArray *array) {
   DArray_clear(array);
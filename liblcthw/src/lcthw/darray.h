@@ -4,6 +4,10 @@
 #include <lcthw/dbg.h>
 #include <stdlib.h>
 
+#ifdef __cplusplus
+extern "C" {
+#endif
+
 // clang-format off
 typedef struct DArray {
     int end;                  // The current number of elements in the array (index of the next free slot).
@@ -22,12 +26,20 @@ void DArray_clear(DArray *array);
 
 int DArray_expand(DArray *array);
 
+// Resize to exactly `max` slots in one realloc, to grow for a known count.
+// `max` must stay above `end` so the slot past the end is kept.
+int DArray_resize(DArray *array, int max);
+
 int DArray_contract(DArray *array);
 
 int DArray_push(DArray *array, void *el);
 
 void *DArray_pop(DArray *array);
 
+int DArray_push_n(DArray *array, void **els, int n);
+
+int DArray_pop_n(DArray *array, void **els, int n);
+
 void DArray_clear_destroy(DArray *array);
 
 #define DArray_last(A) ((A)->contents[(A)->end - 1])
@@ -77,4 +89,8 @@ error:
   for (int i = 0; i < DArray_end(Arr); i++)                                    \
     for (Ty E = (Ty)DArray_get(Arr, i); E != NULL; E = NULL)
 
+#ifdef __cplusplus
+}
+#endif
+
 #endif
@@ -0,0 +1,145 @@
+#ifndef lcthw_DArray_hpp
+#define lcthw_DArray_hpp
+
+#include <initializer_list>
+#include <lcthw/darray.h>
+#include <lcthw/value_slot.hpp>
+#include <new>
+#include <stdexcept>
+#include <utility>
+
+namespace lcthw {
+
+/**
+ * Owning C++ handle on a DArray of T. Trivially copyable values no bigger
+ * than a pointer are stored in the array's slots, so `DArray<int64_t>` does
+ * exactly what DArray_push of a cast value would; other types are boxed.
+ * Iterators are random access and work with <algorithm>, std::sort included.
+ *
+ * Allocation failures throw std::bad_alloc. Moved-from arrays may only be
+ * assigned to or destroyed.
+ */
+template <typename T> class DArray {
+  using Slot = detail::ValueSlot<T>;
+
+public:
+  using value_type = T;
+  using size_type = std::size_t;
+  using reference = T &;
+  using const_reference = const T &;
+  using iterator = detail::SlotIterator<T>;
+  using const_iterator = detail::SlotIterator<const T>;
+
+  explicit DArray(size_t initial_max = 100)
+      : array_(DArray_create(sizeof(T), initial_max)) {
+    if (array_ == nullptr) {
+      throw std::bad_alloc();
+    }
+  }
+
+  DArray(std::initializer_list<T> values) : DArray(values.size() + 1) {
+    for (const T &value : values) {
+      push_back(value);
+    }
+  }
+
+  DArray(DArray &&other) noexcept
+      : array_(std::exchange(other.array_, nullptr)) {}
+
+  DArray &operator=(DArray &&other) noexcept {
+    std::swap(array_, other.array_);
+    return *this;
+  }
+
+  DArray(const DArray &) = delete;
+  DArray &operator=(const DArray &) = delete;
+
+  ~DArray() {
+    if (array_ != nullptr) {
+      clear();
+      DArray_destroy(array_);
+    }
+  }
+
+  template <typename... Args> T &emplace_back(Args &&...args) {
+    // grow first: DArray_push stores the slot before it expands, and a
+    // failed expand would leave the slot in the array
+    if (array_->end + 1 >= array_->max && DArray_expand(array_) != 0) {
+      throw std::bad_alloc();
+    }
+    DArray_push(array_, Slot::make(std::forward<Args>(args)...));
+    return back();
+  }
+
+  void push_back(const T &value) { emplace_back(value); }
+  void push_back(T &&value) { emplace_back(std::move(value)); }
+
+  /**
+   * Removes and returns the last value, std::out_of_range when empty.
+   */
+  T pop_back() {
+    if (empty()) {
+      throw std::out_of_range("pop_back on an empty DArray");
+    }
+    return Slot::take(DArray_pop(array_));
+  }
+
+  void clear() {
+    for (int i = 0; i < array_->end; i++) {
+      Slot::destroy(array_->contents[i]);
+      array_->contents[i] = nullptr;
+    }
+    array_->end = 0;
+  }
+
+  T &operator[](size_type i) { return Slot::ref(array_->contents[i]); }
+  const T &operator[](size_type i) const {
+    return Slot::ref(array_->contents[i]);
+  }
+
+  T &at(size_type i) {
+    if (i >= size()) {
+      throw std::out_of_range("DArray index out of range");
+    }
+    return (*this)[i];
+  }
+  const T &at(size_type i) const {
+    return const_cast<DArray *>(this)->at(i);
+  }
+
+  T &front() { return (*this)[0]; }
+  const T &front() const { return (*this)[0]; }
+  T &back() { return (*this)[size() - 1]; }
+  const T &back() const { return (*this)[size() - 1]; }
+
+  size_type size() const { return DArray_count(array_); }
+  size_type capacity() const { return DArray_max(array_); }
+  bool empty() const { return DArray_count(array_) == 0; }
+
+  iterator begin() { return iterator(array_->contents); }
+  iterator end() { return iterator(array_->contents + array_->end); }
+  const_iterator begin() const { return const_iterator(array_->contents); }
+  const_iterator end() const {
+    return const_iterator(array_->contents + array_->end);
+  }
+  const_iterator cbegin() const { return begin(); }
+  const_iterator cend() const { return end(); }
+
+  /**
+   * The underlying DArray, still owned by this object.
+   */
+  ::DArray *get() const { return array_; }
+
+  /**
+   * Gives up ownership of the DArray. Boxed values become the caller's to
+   * `delete`.
+   */
+  ::DArray *release() { return std::exchange(array_, nullptr); }
+
+private:
+  ::DArray *array_;
+};
+
+} // namespace lcthw
+
+#endif
@@ -0,0 +1,161 @@
+#ifndef lcthw_DArrayTyped_h
+#define lcthw_DArrayTyped_h
+
+#include <lcthw/dbg.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * Type-specialized dynamic arrays and stacks, generated by macro.
+ *
+ * DArray stores `void *`, so small values are boxed in their own allocation
+ * and every access is another dereference. `DARRAY_DEFINE(I64Array, int64_t)`
+ * instead emits an `I64Array` holding an `int64_t *` and static inline
+ * functions for it, which the compiler sees through entirely:
+ *
+ * ```
+ * DARRAY_DEFINE(I64Array, int64_t)
+ *
+ * I64Array *a = I64Array_create(100);
+ * I64Array_push(a, 42);
+ * int64_t v;
+ * I64Array_pop(a, &v);
+ * I64Array_destroy(a);
+ * ```
+ *
+ * Use it once per type, at file scope. Errors are reported through dbg.h
+ * and a -1 return, as DArray does. Arrays grow by doubling.
+ */
+
+#define DARRAY_DEFINE(N, T)                                                    \
+  typedef struct N {                                                           \
+    int end; /* Number of elements. */                                         \
+    int max; /* Allocated slots. */                                            \
+    T *contents;                                                               \
+  } N;                                                                         \
+                                                                               \
+  static inline N *N##_create(int initial_max) {                               \
+    N *array = NULL;                                                           \
+                                                                               \
+    check(initial_max >= 1, "Initial max must be at least 1");                 \
+                                                                               \
+    array = malloc(sizeof(N));                                                 \
+    check_mem(array);                                                          \
+                                                                               \
+    array->end = 0;                                                            \
+    array->max = initial_max;                                                  \
+    array->contents = malloc(sizeof(T) * initial_max);                         \
+    check_mem(array->contents);                                                \
+                                                                               \
+    return array;                                                              \
+                                                                               \
+  error:                                                                       \
+    free(array);                                                               \
+    return NULL;                                                               \
+  }                                                                            \
+                                                                               \
+  static inline void N##_destroy(N *array) {                                   \
+    if (array) {                                                               \
+      free(array->contents);                                                   \
+      free(array);                                                             \
+    }                                                                          \
+  }                                                                            \
+                                                                               \
+  /* Makes room for at least `max` elements. */                                \
+  static inline int N##_reserve(N *array, int max) {                           \
+    if (max <= array->max) {                                                   \
+      return 0;                                                                \
+    }                                                                          \
+                                                                               \
+    if (max < array->max * 2) {                                                \
+      max = array->max * 2;                                                    \
+    }                                                                          \
+                                                                               \
+    T *contents = realloc(array->contents, sizeof(T) * max);                   \
+    check(contents != NULL, "Failed to expand " #N ".");                       \
+                                                                               \
+    array->contents = contents;                                                \
+    array->max = max;                                                          \
+    return 0;                                                                  \
+                                                                               \
+  error:                                                                       \
+    return -1;                                                                 \
+  }                                                                            \
+                                                                               \
+  static inline int N##_push(N *array, T el) {                                 \
+    if (array->end == array->max && N##_reserve(array, array->end + 1) != 0) { \
+      return -1;                                                               \
+    }                                                                          \
+                                                                               \
+    array->contents[array->end++] = el;                                        \
+    return 0;                                                                  \
+  }                                                                            \
+                                                                               \
+  static inline int N##_push_n(N *array, const T *els, int n) {                \
+    if (n <= 0) {                                                              \
+      return 0;                                                                \
+    }                                                                          \
+                                                                               \
+    if (N##_reserve(array, array->end + n) != 0) {                             \
+      return -1;                                                               \
+    }                                                                          \
+                                                                               \
+    memcpy(array->contents + array->end, els, sizeof(T) * n);                  \
+    array->end += n;                                                           \
+    return 0;                                                                  \
+  }                                                                            \
+                                                                               \
+  /* Pops the last element into `out`, -1 if the array is empty. */            \
+  static inline int N##_pop(N *array, T *out) {                                \
+    check(array->end > 0, "Attempt to pop from empty array.");                 \
+    *out = array->contents[--array->end];                                      \
+    return 0;                                                                  \
+                                                                               \
+  error:                                                                       \
+    return -1;                                                                 \
+  }                                                                            \
+                                                                               \
+  static inline T N##_get(N *array, int i) { return array->contents[i]; }      \
+                                                                               \
+  static inline void N##_set(N *array, int i, T el) {                          \
+    array->contents[i] = el;                                                   \
+  }                                                                            \
+                                                                               \
+  static inline int N##_count(N *array) { return array->end; }
+
+/**
+ * A typed Stack over DARRAY_DEFINE, with Stack's interface. `T` comes back
+ * through an out parameter from pop and peek, -1 when the stack is empty.
+ */
+#define STACK_DEFINE(N, T)                                                     \
+  DARRAY_DEFINE(N##Array, T)                                                   \
+                                                                               \
+  typedef struct N##Array N;                                                   \
+                                                                               \
+  static inline N *N##_create() { return N##Array_create(100); }               \
+                                                                               \
+  static inline void N##_destroy(N *stack) { N##Array_destroy(stack); }        \
+                                                                               \
+  static inline int N##_push(N *stack, T value) {                              \
+    return N##Array_push(stack, value);                                        \
+  }                                                                            \
+                                                                               \
+  static inline int N##_push_n(N *stack, const T *values, int n) {             \
+    return N##Array_push_n(stack, values, n);                                  \
+  }                                                                            \
+                                                                               \
+  static inline int N##_pop(N *stack, T *out) {                                \
+    return N##Array_pop(stack, out);                                           \
+  }                                                                            \
+                                                                               \
+  static inline int N##_peek(N *stack, T *out) {                               \
+    if (stack->end == 0) {                                                     \
+      return -1;                                                               \
+    }                                                                          \
+    *out = stack->contents[stack->end - 1];                                    \
+    return 0;                                                                  \
+  }                                                                            \
+                                                                               \
+  static inline int N##_count(N *stack) { return stack->end; }
+
+#endif
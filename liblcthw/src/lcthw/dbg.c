@@ -0,0 +1,78 @@
+#define _GNU_SOURCE
+#include <lcthw/dbg.h>
+#include <stdlib.h>
+#include <time.h>
+
+int dbg_log_level = LOG_LEVEL_DEBUG;
+
+void dbg_set_log_level(int level) {
+  __atomic_store_n(&dbg_log_level, level, __ATOMIC_RELAXED);
+}
+
+// Call sites with suppressed messages, only ever pushed to.
+static DbgRateLimit *dbg_rate_sites = NULL;
+static int dbg_rate_flush_registered = 0;
+
+// Seconds, from the clock the vDSO reads without a system call or
+// hardware timer read.
+static long dbg_rate_now() {
+#ifdef CLOCK_MONOTONIC_COARSE
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC_COARSE, &now);
+  return (long)now.tv_sec;
+#else
+  return (long)time(NULL);
+#endif
+}
+
+static void dbg_rate_list(DbgRateLimit *limit) {
+  // sites without a name, e.g. ones on the stack, can't be reported
+  if (limit->file == NULL ||
+      __atomic_exchange_n(&limit->listed, 1, __ATOMIC_RELAXED))
+    return;
+
+  DbgRateLimit *head = __atomic_load_n(&dbg_rate_sites, __ATOMIC_RELAXED);
+  do {
+    limit->next = head;
+  } while (!__atomic_compare_exchange_n(&dbg_rate_sites, &head, limit, 0,
+                                        __ATOMIC_RELEASE, __ATOMIC_RELAXED));
+
+  if (!__atomic_exchange_n(&dbg_rate_flush_registered, 1, __ATOMIC_RELAXED))
+    atexit(dbg_rate_flush);
+}
+
+void dbg_rate_flush(void) {
+  DbgRateLimit *limit = __atomic_load_n(&dbg_rate_sites, __ATOMIC_ACQUIRE);
+
+  for (; limit != NULL; limit = limit->next) {
+    unsigned long n =
+        __atomic_exchange_n(&limit->suppressed, 0, __ATOMIC_RELAXED);
+    if (n)
+      fprintf(stderr, "[%s] (%s:%d) suppressed %lu messages\n", limit->tag,
+              limit->file, limit->line, n);
+  }
+}
+
+int dbg_rate_allow(DbgRateLimit *limit, unsigned long *suppressed) {
+  if (limit->burst == 0)
+    return 1;
+
+  long now = dbg_rate_now();
+  long window = __atomic_load_n(&limit->window, __ATOMIC_RELAXED);
+
+  // first message of a new second, whoever swaps the window reports
+  if (window != now &&
+      __atomic_compare_exchange_n(&limit->window, &window, now, 0,
+                                  __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+    __atomic_store_n(&limit->count, 1, __ATOMIC_RELAXED);
+    *suppressed = __atomic_exchange_n(&limit->suppressed, 0, __ATOMIC_RELAXED);
+    return 1;
+  }
+
+  if (__atomic_fetch_add(&limit->count, 1, __ATOMIC_RELAXED) < limit->burst)
+    return 1;
+
+  if (__atomic_fetch_add(&limit->suppressed, 1, __ATOMIC_RELAXED) == 0)
+    dbg_rate_list(limit);
+  return 0;
+}
@@ -1,4 +1,3 @@
-
 #ifndef __dbg_h__
 #define __dbg_h__
 
@@ -6,25 +5,130 @@
 #include <stdio.h>
 #include <string.h>
 
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define LOG_LEVEL_DEBUG 0
+#define LOG_LEVEL_INFO 1
+#define LOG_LEVEL_WARN 2
+#define LOG_LEVEL_ERR 3
+#define LOG_LEVEL_NONE 4
+
+// Calls below this level are compiled out, arguments and all.
+#ifndef LOG_MIN_LEVEL
 #ifdef NDEBUG
-#define debug(M, ...)
+#define LOG_MIN_LEVEL LOG_LEVEL_INFO
 #else
-#define debug(M, ...)                                                          \
-  fprintf(stderr, "DEBUG %s:%d: " M "\n", __FILE__, __LINE__, ##__VA_ARGS__)
+#define LOG_MIN_LEVEL LOG_LEVEL_DEBUG
 #endif
+#endif
+
+// How many messages one call site may write per second before the rest are
+// counted and reported as "suppressed N messages". 0 turns the limit off.
+// Each call site takes it where it expands, so defining it before including
+// this header sets it for that file.
+#ifndef LOG_RATE_BURST
+#define LOG_RATE_BURST 10
+#endif
+
+typedef struct DbgRateLimit {
+  unsigned long burst; // Messages per second, 0 for no limit.
+  long window;
+  unsigned long count;
+  unsigned long suppressed;
+  // The call site, for reporting a count no later message picked up.
+  const char *file;
+  int line;
+  const char *tag;
+  struct DbgRateLimit *next; // Next call site that suppressed something.
+  int listed;
+} DbgRateLimit;
+
+#define DBG_RATE_LIMIT_INIT(TAG)                                               \
+  {LOG_RATE_BURST, 0, 0, 0, __FILE__, __LINE__, #TAG, NULL, 0}
+
+/**
+ * Runtime minimum level, checked on top of LOG_MIN_LEVEL. Starts at
+ * LOG_LEVEL_DEBUG so by default only the compile-time level filters.
+ */
+extern int dbg_log_level;
+
+void dbg_set_log_level(int level);
+
+/**
+ * Decides if a call site may log now. When it may and earlier messages
+ * were suppressed, their number is stored in `suppressed` so the caller
+ * can report it first.
+ */
+int dbg_rate_allow(DbgRateLimit *limit, unsigned long *suppressed);
+
+/**
+ * Reports the suppressed messages of every call site that hasn't logged
+ * since, so a storm that just stops isn't lost. Runs at exit once anything
+ * was suppressed.
+ */
+void dbg_rate_flush(void);
 
 #define clean_errno() (errno == 0 ? "None" : strerror(errno))
 
-#define log_err(M, ...)                                                        \
-  fprintf(stderr, "[ERROR] (%s:%d: errno: %s) " M "\n", __FILE__, __LINE__,    \
-          clean_errno(), ##__VA_ARGS__)
+#ifdef LCTHW_ASYNC_LOG
+// Hand the message to the background logger instead of formatting it here.
+#include <lcthw/fastlog.h>
+
+#define log_emit(L, TAG, M, ...) FASTLOG((L), M, ##__VA_ARGS__)
+#else
+
+#define log_prefix_DEBUG "DEBUG %s:%d: "
+#define log_prefix_INFO "[INFO] (%s:%d) "
+#define log_prefix_WARN "[WARN] (%s:%d: errno: %s) "
+#define log_prefix_ERROR "[ERROR] (%s:%d: errno: %s) "
 
-#define log_warn(M, ...)                                                       \
-  fprintf(stderr, "[WARN] (%s:%d: errno: %s) " M "\n", __FILE__, __LINE__,     \
-          clean_errno(), ##__VA_ARGS__)
+#define log_args_DEBUG __FILE__, __LINE__
+#define log_args_INFO __FILE__, __LINE__
+#define log_args_WARN __FILE__, __LINE__, clean_errno()
+#define log_args_ERROR __FILE__, __LINE__, clean_errno()
 
-#define log_info(M, ...)                                                       \
-  fprintf(stderr, "[INFO] (%s:%d) " M "\n", __FILE__, __LINE__, ##__VA_ARGS__)
+#define log_emit(L, TAG, M, ...)                                               \
+  fprintf(stderr, log_prefix_##TAG M "\n", log_args_##TAG, ##__VA_ARGS__)
+#endif
+
+#define log_at(L, TAG, M, ...)                                                 \
+  do {                                                                         \
+    if ((L) >= __atomic_load_n(&dbg_log_level, __ATOMIC_RELAXED)) {           \
+      static DbgRateLimit _log_limit = DBG_RATE_LIMIT_INIT(TAG);               \
+      unsigned long _log_suppressed = 0;                                       \
+      if (dbg_rate_allow(&_log_limit, &_log_suppressed)) {                     \
+        if (_log_suppressed)                                                   \
+          log_emit(L, TAG, "suppressed %lu messages", _log_suppressed);        \
+        log_emit(L, TAG, M, ##__VA_ARGS__);                                    \
+      }                                                                        \
+    }                                                                          \
+  } while (0)
+
+#if LOG_MIN_LEVEL <= LOG_LEVEL_DEBUG
+#define debug(M, ...) log_at(LOG_LEVEL_DEBUG, DEBUG, M, ##__VA_ARGS__)
+#else
+#define debug(M, ...)
+#endif
+
+#if LOG_MIN_LEVEL <= LOG_LEVEL_ERR
+#define log_err(M, ...) log_at(LOG_LEVEL_ERR, ERROR, M, ##__VA_ARGS__)
+#else
+#define log_err(M, ...)
+#endif
+
+#if LOG_MIN_LEVEL <= LOG_LEVEL_WARN
+#define log_warn(M, ...) log_at(LOG_LEVEL_WARN, WARN, M, ##__VA_ARGS__)
+#else
+#define log_warn(M, ...)
+#endif
+
+#if LOG_MIN_LEVEL <= LOG_LEVEL_INFO
+#define log_info(M, ...) log_at(LOG_LEVEL_INFO, INFO, M, ##__VA_ARGS__)
+#else
+#define log_info(M, ...)
+#endif
 
 #define check(A, M, ...)                                                       \
   if (!(A)) {                                                                  \
@@ -49,4 +153,8 @@
     goto error;                                                                \
   }
 
+#ifdef __cplusplus
+}
+#endif
+
 #endif
@@ -0,0 +1,442 @@
+#include <lcthw/fastlog.h>
+#include <errno.h>
+#include <pthread.h>
+#include <stdarg.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+// This file can't use dbg.h: with LCTHW_ASYNC_LOG its macros come back here.
+
+#define FASTLOG_RING_MASK (FASTLOG_RING_SIZE - 1)
+#define FASTLOG_ALIGN 16
+#define FASTLOG_LINE_MAX 4096
+#define FASTLOG_IDLE_US 1000
+
+typedef union FastLogArg {
+  long l;
+  double d;
+  void *p;
+  size_t len; // FASTLOG_ARG_STR, the bytes follow the argument slots
+} FastLogArg;
+
+// A record in a ring, always FASTLOG_ALIGN aligned. A NULL site marks the
+// padding written when a record doesn't fit before the end of the ring.
+typedef struct FastLogRecord {
+  uint32_t size;
+  int32_t err;
+  FastLogSite *site;
+  FastLogArg args[];
+} FastLogRecord;
+
+// One per logging thread. Only the owner moves head and only the consumer
+// moves tail, both count bytes and never wrap.
+typedef struct FastLogRing {
+  uint64_t head;
+  uint64_t tail;
+  int dead;
+  struct FastLogRing *next;
+  unsigned char data[FASTLOG_RING_SIZE];
+} FastLogRing;
+
+static __thread FastLogRing *fastlog_ring = NULL;
+
+static pthread_once_t fastlog_once = PTHREAD_ONCE_INIT;
+static pthread_key_t fastlog_key;
+static pthread_t fastlog_thread;
+static int fastlog_started = 0;
+static int fastlog_stopping = 0;
+
+// Guards the ring list, the output and every read of a ring.
+static pthread_mutex_t fastlog_lock = PTHREAD_MUTEX_INITIALIZER;
+static FastLogRing *fastlog_rings = NULL;
+static FILE *fastlog_out = NULL;
+static uint64_t fastlog_dropped = 0;
+
+static const char *fastlog_prefixes[] = {
+    "DEBUG %s:%d: ",
+    "[INFO] (%s:%d) ",
+    "[WARN] (%s:%d: errno: %s) ",
+    "[ERROR] (%s:%d: errno: %s) ",
+};
+
+static size_t FastLog_prefix(char *out, size_t room, FastLogSite *site,
+                             int err) {
+  const char *fmt = fastlog_prefixes[site->level];
+  int rc = 0;
+
+  if (site->level >= FASTLOG_WARN) {
+    rc = snprintf(out, room, fmt, site->file, site->line,
+                  err == 0 ? "None" : strerror(err));
+  } else {
+    rc = snprintf(out, room, fmt, site->file, site->line);
+  }
+
+  return rc < 0 ? 0 : ((size_t)rc < room ? (size_t)rc : room - 1);
+}
+
+static void FastLog_emit(char *line, size_t len) {
+  line[len++] = '\n';
+  fwrite(line, 1, len, fastlog_out ? fastlog_out : stderr);
+}
+
+// Works out once per site what each conversion takes, or that it can't be
+// deferred at all.
+static void FastLog_parse(FastLogSite *site) {
+  unsigned char kinds[FASTLOG_MAX_ARGS];
+  int nargs = 0;
+  const char *p = site->fmt;
+
+  while ((p = strchr(p, '%')) != NULL) {
+    int longs = 0;
+
+    p++;
+    if (*p == '%') {
+      p++;
+      continue;
+    }
+
+    p += strspn(p, "-+ #0'");
+    p += strspn(p, "0123456789");
+    if (*p == '.') {
+      p++;
+      p += strspn(p, "0123456789");
+    }
+    if (*p == '*' || nargs == FASTLOG_MAX_ARGS)
+      goto sync;
+
+    for (; *p && strchr("hlzjtqL", *p); p++) {
+      if (*p == 'L' || *p == 'q')
+        goto sync;
+      longs += *p != 'h';
+    }
+
+    switch (*p) {
+    case 'd':
+    case 'i':
+    case 'u':
+    case 'o':
+    case 'x':
+    case 'X':
+    case 'c':
+      kinds[nargs++] = longs ? FASTLOG_ARG_LONG : FASTLOG_ARG_INT;
+      break;
+    case 'f':
+    case 'F':
+    case 'e':
+    case 'E':
+    case 'g':
+    case 'G':
+    case 'a':
+    case 'A':
+      kinds[nargs++] = FASTLOG_ARG_DOUBLE;
+      break;
+    case 's':
+      if (longs)
+        goto sync;
+      kinds[nargs++] = FASTLOG_ARG_STR;
+      break;
+    case 'p':
+      kinds[nargs++] = FASTLOG_ARG_PTR;
+      break;
+    default:
+      goto sync;
+    }
+    p++;
+  }
+
+  memcpy(site->kinds, kinds, nargs);
+  __atomic_store_n(&site->nargs, nargs, __ATOMIC_RELEASE);
+  return;
+
+sync:
+  __atomic_store_n(&site->nargs, FASTLOG_SYNC, __ATOMIC_RELEASE);
+}
+
+// Replays a record's format one conversion at a time.
+static size_t FastLog_format(char *out, size_t room, FastLogRecord *rec) {
+  FastLogSite *site = rec->site;
+  const char *strs = (const char *)&rec->args[site->nargs];
+  const char *p = site->fmt;
+  size_t len = 0;
+  int arg = 0;
+
+  while (*p && len < room - 1) {
+    const char *spec = p;
+    char conv[32];
+    int rc = 0;
+
+    if (*p != '%') {
+      out[len++] = *p++;
+      continue;
+    } else if (p[1] == '%') {
+      out[len++] = '%';
+      p += 2;
+      continue;
+    }
+
+    // the parse above already vetted every spec, find where this one ends
+    p++;
+    p += strspn(p, "-+ #0'0123456789.hlzjt");
+    p++;
+
+    size_t n = p - spec;
+    if (n >= sizeof(conv))
+      n = sizeof(conv) - 1;
+    memcpy(conv, spec, n);
+    conv[n] = '\0';
+
+    FastLogArg *a = &rec->args[arg];
+    switch (site->kinds[arg++]) {
+    case FASTLOG_ARG_INT:
+      rc = snprintf(out + len, room - len, conv, (int)a->l);
+      break;
+    case FASTLOG_ARG_LONG:
+      rc = snprintf(out + len, room - len, conv, a->l);
+      break;
+    case FASTLOG_ARG_DOUBLE:
+      rc = snprintf(out + len, room - len, conv, a->d);
+      break;
+    case FASTLOG_ARG_PTR:
+      rc = snprintf(out + len, room - len, conv, a->p);
+      break;
+    case FASTLOG_ARG_STR:
+      rc = snprintf(out + len, room - len, conv, strs);
+      strs += a->len + 1;
+      break;
+    }
+
+    if (rc > 0)
+      len += (size_t)rc < room - len ? (size_t)rc : room - len - 1;
+  }
+
+  return len;
+}
+
+// Formats everything published in `ring`. Called with fastlog_lock held.
+static int FastLog_drain(FastLogRing *ring) {
+  uint64_t head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+  uint64_t tail = ring->tail;
+  char line[FASTLOG_LINE_MAX];
+  int drained = 0;
+
+  while (tail != head) {
+    FastLogRecord *rec =
+        (FastLogRecord *)&ring->data[tail & FASTLOG_RING_MASK];
+
+    if (rec->site != NULL) {
+      size_t len = FastLog_prefix(line, sizeof(line) - 1, rec->site, rec->err);
+      len += FastLog_format(line + len, sizeof(line) - 1 - len, rec);
+      FastLog_emit(line, len);
+      drained++;
+    }
+
+    tail += rec->size;
+  }
+
+  __atomic_store_n(&ring->tail, tail, __ATOMIC_RELEASE);
+  return drained;
+}
+
+// Drains every ring and frees the ones whose thread has exited.
+static int FastLog_drain_all() {
+  FastLogRing **cur = &fastlog_rings;
+  int drained = 0;
+
+  while (*cur) {
+    FastLogRing *ring = *cur;
+    int dead = __atomic_load_n(&ring->dead, __ATOMIC_ACQUIRE);
+
+    drained += FastLog_drain(ring);
+
+    if (dead) {
+      *cur = ring->next;
+      free(ring);
+    } else {
+      cur = &ring->next;
+    }
+  }
+
+  return drained;
+}
+
+static void *FastLog_consumer(void *arg) {
+  (void)arg;
+
+  while (!__atomic_load_n(&fastlog_stopping, __ATOMIC_ACQUIRE)) {
+    pthread_mutex_lock(&fastlog_lock);
+    int drained = FastLog_drain_all();
+    pthread_mutex_unlock(&fastlog_lock);
+
+    if (drained == 0)
+      usleep(FASTLOG_IDLE_US);
+  }
+
+  return NULL;
+}
+
+static void FastLog_thread_exit(void *ring) {
+  // a later destructor that logs gets a fresh ring
+  fastlog_ring = NULL;
+  __atomic_store_n(&((FastLogRing *)ring)->dead, 1, __ATOMIC_RELEASE);
+}
+
+static void FastLog_shutdown() {
+  __atomic_store_n(&fastlog_stopping, 1, __ATOMIC_RELEASE);
+  if (fastlog_started)
+    pthread_join(fastlog_thread, NULL);
+
+  FastLog_flush();
+}
+
+static void FastLog_init() {
+  pthread_key_create(&fastlog_key, FastLog_thread_exit);
+  fastlog_started = pthread_create(&fastlog_thread, NULL, FastLog_consumer,
+                                   NULL) == 0;
+  atexit(FastLog_shutdown);
+}
+
+static FastLogRing *FastLog_ring() {
+  FastLogRing *ring = NULL;
+
+  pthread_once(&fastlog_once, FastLog_init);
+
+  ring = calloc(1, sizeof(FastLogRing));
+  if (ring == NULL)
+    return NULL;
+
+  pthread_setspecific(fastlog_key, ring);
+
+  pthread_mutex_lock(&fastlog_lock);
+  ring->next = fastlog_rings;
+  fastlog_rings = ring;
+  pthread_mutex_unlock(&fastlog_lock);
+
+  return ring;
+}
+
+static void FastLog_write_sync(FastLogSite *site, int err, va_list args) {
+  char line[FASTLOG_LINE_MAX];
+  size_t len = FastLog_prefix(line, sizeof(line) - 1, site, err);
+  int rc = vsnprintf(line + len, sizeof(line) - 1 - len, site->fmt, args);
+
+  if (rc > 0)
+    len += (size_t)rc < sizeof(line) - 1 - len ? (size_t)rc
+                                                 : sizeof(line) - 2 - len;
+
+  pthread_mutex_lock(&fastlog_lock);
+  FastLog_emit(line, len);
+  pthread_mutex_unlock(&fastlog_lock);
+}
+
+void FastLog_write(FastLogSite *site, int err, ...) {
+  FastLogArg args[FASTLOG_MAX_ARGS];
+  const char *strs[FASTLOG_MAX_ARGS];
+  size_t size = sizeof(FastLogRecord);
+  FastLogRing *ring = fastlog_ring;
+  va_list ap;
+
+  int nargs = __atomic_load_n(&site->nargs, __ATOMIC_ACQUIRE);
+  if (nargs == FASTLOG_UNPARSED) {
+    FastLog_parse(site);
+    nargs = site->nargs;
+  }
+
+  if (ring == NULL && nargs != FASTLOG_SYNC &&
+      !__atomic_load_n(&fastlog_stopping, __ATOMIC_ACQUIRE)) {
+    ring = fastlog_ring = FastLog_ring();
+  }
+
+  va_start(ap, err);
+
+  if (ring == NULL || nargs == FASTLOG_SYNC ||
+      __atomic_load_n(&fastlog_stopping, __ATOMIC_RELAXED)) {
+    FastLog_write_sync(site, err, ap);
+    va_end(ap);
+    return;
+  }
+
+  // pull the arguments first, strings decide how big the record is
+  for (int i = 0; i < nargs; i++) {
+    switch (site->kinds[i]) {
+    case FASTLOG_ARG_INT:
+      args[i].l = va_arg(ap, int);
+      break;
+    case FASTLOG_ARG_LONG:
+      args[i].l = va_arg(ap, long);
+      break;
+    case FASTLOG_ARG_DOUBLE:
+      args[i].d = va_arg(ap, double);
+      break;
+    case FASTLOG_ARG_PTR:
+      args[i].p = va_arg(ap, void *);
+      break;
+    case FASTLOG_ARG_STR:
+      strs[i] = va_arg(ap, const char *);
+      if (strs[i] == NULL)
+        strs[i] = "(null)";
+      args[i].len = strnlen(strs[i], FASTLOG_MAX_STR);
+      size += args[i].len + 1;
+      break;
+    }
+  }
+  va_end(ap);
+
+  size += nargs * sizeof(FastLogArg);
+  size = (size + FASTLOG_ALIGN - 1) & ~(size_t)(FASTLOG_ALIGN - 1);
+
+  uint64_t head = ring->head;
+  uint64_t tail = __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE);
+  size_t offset = head & FASTLOG_RING_MASK;
+  size_t contig = FASTLOG_RING_SIZE - offset;
+  size_t need = size > contig ? size + contig : size;
+
+  if (head + need - tail > FASTLOG_RING_SIZE) {
+    __atomic_fetch_add(&fastlog_dropped, 1, __ATOMIC_RELAXED);
+    return;
+  }
+
+  if (size > contig) {
+    FastLogRecord *pad = (FastLogRecord *)&ring->data[offset];
+    pad->size = contig;
+    pad->site = NULL;
+    head += contig;
+    offset = 0;
+  }
+
+  FastLogRecord *rec = (FastLogRecord *)&ring->data[offset];
+  rec->size = size;
+  rec->err = err;
+  rec->site = site;
+  memcpy(rec->args, args, nargs * sizeof(FastLogArg));
+
+  char *out = (char *)&rec->args[nargs];
+  for (int i = 0; i < nargs; i++) {
+    if (site->kinds[i] == FASTLOG_ARG_STR) {
+      memcpy(out, strs[i], args[i].len);
+      out[args[i].len] = '\0';
+      out += args[i].len + 1;
+    }
+  }
+
+  __atomic_store_n(&ring->head, head + size, __ATOMIC_RELEASE);
+}
+
+void FastLog_flush() {
+  pthread_mutex_lock(&fastlog_lock);
+  FastLog_drain_all();
+  fflush(fastlog_out ? fastlog_out : stderr);
+  pthread_mutex_unlock(&fastlog_lock);
+}
+
+void FastLog_set_output(FILE *out) {
+  pthread_mutex_lock(&fastlog_lock);
+  FastLog_drain_all();
+  fflush(fastlog_out ? fastlog_out : stderr);
+  fastlog_out = out;
+  pthread_mutex_unlock(&fastlog_lock);
+}
+
+uint64_t FastLog_dropped() {
+  return __atomic_load_n(&fastlog_dropped, __ATOMIC_RELAXED);
+}
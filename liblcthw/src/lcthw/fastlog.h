@@ -0,0 +1,79 @@
+#ifndef lcthw_FastLog_h
+#define lcthw_FastLog_h
+
+#include <stdint.h>
+#include <stdio.h>
+
+/**
+ * Asynchronous binary logger behind the dbg.h macros when LCTHW_ASYNC_LOG is
+ * defined.
+ *
+ * A call site only copies a pointer to its static FastLogSite (which acts as
+ * the format string ID), errno and the raw arguments into a per-thread
+ * single-producer ring, and never parses the format or takes a lock. A
+ * background thread drains every ring and does the formatting. When a ring
+ * is full the message is dropped and counted rather than blocking the caller.
+ */
+
+#define FASTLOG_MAX_ARGS 8
+#define FASTLOG_MAX_STR 256            // Longest %s argument kept, in bytes.
+#define FASTLOG_RING_SIZE (64 * 1024) // Per thread, must be a power of two.
+
+enum {
+  FASTLOG_DEBUG = 0,
+  FASTLOG_INFO,
+  FASTLOG_WARN,
+  FASTLOG_ERR,
+};
+
+// What a captured argument is, decided once per site from its format.
+enum {
+  FASTLOG_ARG_INT = 0,
+  FASTLOG_ARG_LONG,
+  FASTLOG_ARG_DOUBLE,
+  FASTLOG_ARG_STR,
+  FASTLOG_ARG_PTR,
+};
+
+#define FASTLOG_UNPARSED -1
+// The format uses something we can't replay later ('*' widths, %n, too many
+// arguments), such sites are formatted synchronously instead.
+#define FASTLOG_SYNC -2
+
+typedef struct FastLogSite {
+  int level;
+  const char *file;
+  int line;
+  const char *fmt;
+  int nargs; // FASTLOG_UNPARSED until the first call.
+  unsigned char kinds[FASTLOG_MAX_ARGS];
+} FastLogSite;
+
+/**
+ * Captures one message. Use the FASTLOG macro, which supplies the site.
+ */
+void FastLog_write(FastLogSite *site, int err, ...);
+
+/**
+ * Blocks until every message logged so far has been written out.
+ */
+void FastLog_flush();
+
+/**
+ * Redirects the formatted output (stderr by default). Flushes first.
+ */
+void FastLog_set_output(FILE *out);
+
+/**
+ * Number of messages dropped because a thread's ring was full.
+ */
+uint64_t FastLog_dropped();
+
+#define FASTLOG(L, M, ...)                                                     \
+  do {                                                                         \
+    static FastLogSite _fastlog_site = {(L), __FILE__, __LINE__, (M),          \
+                                        FASTLOG_UNPARSED, {0}};                \
+    FastLog_write(&_fastlog_site, errno, ##__VA_ARGS__);                       \
+  } while (0)
+
+#endif
@@ -0,0 +1,200 @@
+#include <lcthw/dbg.h>
+#include <lcthw/heap.h>
+#include <stdlib.h>
+
+#define Heap_node(H, I) ((HeapNode *)(H)->nodes->contents[(I)])
+
+static inline void Heap_set(Heap *heap, int i, HeapNode *node) {
+  heap->nodes->contents[i] = node;
+  node->index = i;
+}
+
+static int Heap_sift_up(Heap *heap, int i) {
+  HeapNode *node = Heap_node(heap, i);
+
+  // move the hole up instead of swapping at every level
+  while (i > 0) {
+    int parent = (i - 1) / heap->d;
+    HeapNode *p = Heap_node(heap, parent);
+
+    if (heap->cmp(node->value, p->value) >= 0) {
+      break;
+    }
+
+    Heap_set(heap, i, p);
+    i = parent;
+  }
+
+  Heap_set(heap, i, node);
+  return i;
+}
+
+static int Heap_sift_down(Heap *heap, int i) {
+  HeapNode *node = Heap_node(heap, i);
+  int count = Heap_count(heap);
+
+  for (;;) {
+    int first = heap->d * i + 1;
+    if (first >= count) {
+      break;
+    }
+
+    int last = first + heap->d;
+    if (last > count) {
+      last = count;
+    }
+
+    int min = first;
+    for (int c = first + 1; c < last; c++) {
+      if (heap->cmp(Heap_node(heap, c)->value, Heap_node(heap, min)->value) <
+          0) {
+        min = c;
+      }
+    }
+
+    if (heap->cmp(Heap_node(heap, min)->value, node->value) >= 0) {
+      break;
+    }
+
+    Heap_set(heap, i, Heap_node(heap, min));
+    i = min;
+  }
+
+  Heap_set(heap, i, node);
+  return i;
+}
+
+Heap *Heap_create(int d, Heap_compare cmp) {
+  Heap *heap = NULL;
+
+  check(d >= 2, "Heap arity must be at least 2, got %d.", d);
+  check(cmp != NULL, "Heap needs a compare function.");
+
+  heap = calloc(1, sizeof(Heap));
+  check_mem(heap);
+
+  heap->nodes = DArray_create(sizeof(HeapNode), HEAP_DEFAULT_CAPACITY);
+  check_mem(heap->nodes);
+
+  heap->d = d;
+  heap->cmp = cmp;
+
+  return heap;
+
+error:
+  free(heap);
+  return NULL;
+}
+
+Heap *Heap_from_array(void **values, int count, int d, Heap_compare cmp) {
+  Heap *heap = Heap_create(d, cmp);
+  check(heap != NULL, "Failed to create heap.");
+  check(count >= 0, "Count can't be negative.");
+
+  // one resize, keeping the DArray invariant of one free slot past the end
+  if (heap->nodes->max <= count) {
+    check(DArray_resize(heap->nodes, count + 1) == 0, "Failed to grow heap.");
+  }
+
+  for (int i = 0; i < count; i++) {
+    HeapNode *node = DArray_new(heap->nodes);
+    check_mem(node);
+
+    node->value = values[i];
+    Heap_set(heap, i, node);
+    heap->nodes->end = i + 1;
+  }
+
+  // every node past the last parent is already a valid heap
+  for (int i = (count - 2) / heap->d; count > 1 && i >= 0; i--) {
+    Heap_sift_down(heap, i);
+  }
+
+  return heap;
+
+error:
+  Heap_destroy(heap);
+  return NULL;
+}
+
+void Heap_destroy(Heap *heap) {
+  if (heap) {
+    for (int i = 0; i < Heap_count(heap); i++) {
+      DArray_free(Heap_node(heap, i));
+    }
+
+    DArray_destroy(heap->nodes);
+    free(heap);
+  }
+}
+
+HeapNode *Heap_push(Heap *heap, void *value) {
+  HeapNode *node = NULL;
+
+  // grow before storing anything, DArray_push stores the node before it
+  // expands and a failed expand would leave it in the heap
+  if (heap->nodes->end + 1 >= heap->nodes->max) {
+    check(DArray_expand(heap->nodes) == 0, "Failed to grow heap.");
+  }
+
+  node = DArray_new(heap->nodes);
+  check_mem(node);
+
+  node->value = value;
+  node->index = Heap_count(heap);
+
+  DArray_push(heap->nodes, node);
+  Heap_sift_up(heap, node->index);
+
+  return node;
+
+error:
+  return NULL;
+}
+
+void *Heap_pop(Heap *heap) {
+  if (Heap_count(heap) == 0) {
+    return NULL;
+  }
+
+  return Heap_remove(heap, Heap_node(heap, 0));
+}
+
+int Heap_update(Heap *heap, HeapNode *node) {
+  check(node != NULL, "Node can't be NULL.");
+  check(node->index < Heap_count(heap) && Heap_node(heap, node->index) == node,
+        "Node is not in this heap.");
+
+  int i = node->index;
+  if (Heap_sift_up(heap, i) == i) {
+    Heap_sift_down(heap, i);
+  }
+
+  return 0;
+
+error:
+  return -1;
+}
+
+void *Heap_remove(Heap *heap, HeapNode *node) {
+  void *value = NULL;
+
+  check(node != NULL, "Node can't be NULL.");
+  check(node->index < Heap_count(heap) && Heap_node(heap, node->index) == node,
+        "Node is not in this heap.");
+
+  int i = node->index;
+  HeapNode *last = DArray_pop(heap->nodes);
+
+  if (last != node) {
+    // fill the hole with the last node and let it find its place
+    Heap_set(heap, i, last);
+    Heap_update(heap, last);
+  }
+
+  value = node->value;
+  DArray_free(node);
+
+error:
+  return value;
+}
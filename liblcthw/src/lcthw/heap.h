@@ -0,0 +1,79 @@
+#ifndef lcthw_Heap_h
+#define lcthw_Heap_h
+
+#include <lcthw/darray.h>
+
+// 4 children per node keeps a node's children in one or two cache lines and
+// halves the tree height compared to a binary heap.
+#define HEAP_DEFAULT_ARITY 4
+#define HEAP_DEFAULT_CAPACITY 100
+
+typedef int (*Heap_compare)(const void *a, const void *b);
+
+/**
+ * Handle returned by Heap_push. It stays valid until the value leaves the
+ * heap, and lets the caller change the value's priority in O(log n).
+ */
+typedef struct HeapNode {
+  void *value;
+  int index; // Position in the heap's DArray.
+} HeapNode;
+
+/**
+ * A d-ary min-heap (by `cmp`) stored in a DArray of HeapNode pointers.
+ */
+typedef struct Heap {
+  DArray *nodes;
+  int d;
+  Heap_compare cmp;
+} Heap;
+
+/**
+ * Creates an empty heap whose nodes have `d` children.
+ *
+ * @param d The arity, at least 2. Use HEAP_DEFAULT_ARITY if unsure.
+ * @param cmp Orders values, the smallest one is at the top.
+ */
+Heap *Heap_create(int d, Heap_compare cmp);
+
+/**
+ * Builds a heap from `count` values in O(n) with a bottom-up heapify.
+ */
+Heap *Heap_from_array(void **values, int count, int d, Heap_compare cmp);
+
+/**
+ * Destroys the heap and its handles, the values are not freed.
+ */
+void Heap_destroy(Heap *heap);
+
+/**
+ * Adds a value in O(log n).
+ *
+ * @return The value's handle, or NULL on error.
+ */
+HeapNode *Heap_push(Heap *heap, void *value);
+
+/**
+ * Removes and returns the smallest value, NULL if the heap is empty.
+ */
+void *Heap_pop(Heap *heap);
+
+/**
+ * Restores the heap order after the caller changed the priority of the value
+ * behind `node`, which covers both decrease-key and increase-key.
+ *
+ * @return 0 on success, -1 on error.
+ */
+int Heap_update(Heap *heap, HeapNode *node);
+
+/**
+ * Removes an arbitrary value by its handle and returns it.
+ */
+void *Heap_remove(Heap *heap, HeapNode *node);
+
+#define Heap_count(H) DArray_count((H)->nodes)
+
+#define Heap_peek(H)                                                           \
+  (Heap_count(H) > 0 ? ((HeapNode *)DArray_first((H)->nodes))->value : NULL)
+
+#endif
@@ -0,0 +1,160 @@
+#include <lcthw/ilist.h>
+
+void IList_init(IList *list) {
+  list->count = 0;
+  list->first = NULL;
+  list->last = NULL;
+}
+
+void IList_push(IList *list, IListNode *node) {
+  node->next = NULL;
+  node->prev = list->last;
+
+  if (list->last == NULL) {
+    list->first = node;
+  } else {
+    list->last->next = node;
+  }
+
+  list->last = node;
+  list->count++;
+}
+
+IListNode *IList_pop(IList *list) {
+  IListNode *node = list->last;
+
+  if (node != NULL) {
+    IList_remove(list, node);
+  }
+
+  return node;
+}
+
+void IList_unshift(IList *list, IListNode *node) {
+  node->prev = NULL;
+  node->next = list->first;
+
+  if (list->first == NULL) {
+    list->last = node;
+  } else {
+    list->first->prev = node;
+  }
+
+  list->first = node;
+  list->count++;
+}
+
+IListNode *IList_shift(IList *list) {
+  IListNode *node = list->first;
+
+  if (node != NULL) {
+    IList_remove(list, node);
+  }
+
+  return node;
+}
+
+void IList_insert_after(IList *list, IListNode *after, IListNode *node) {
+  node->prev = after;
+  node->next = after->next;
+
+  if (after->next == NULL) {
+    list->last = node;
+  } else {
+    after->next->prev = node;
+  }
+
+  after->next = node;
+  list->count++;
+}
+
+void IList_remove(IList *list, IListNode *node) {
+  if (node->prev) {
+    node->prev->next = node->next;
+  } else {
+    list->first = node->next;
+  }
+
+  if (node->next) {
+    node->next->prev = node->prev;
+  } else {
+    list->last = node->prev;
+  }
+
+  node->next = node->prev = NULL;
+  list->count--;
+}
+
+// ---- bottom-up merge sort, as List_merge_sort_bottom_up ---------------------
+//
+// While sorting only `next` is kept up to date, `prev` is fixed in one pass at
+// the end.
+
+// Cuts the chain after `n` nodes, returns the rest.
+static IListNode *IList_split(IListNode *head, int n) {
+  while (--n && head) {
+    head = head->next;
+  }
+
+  if (head == NULL) {
+    return NULL;
+  }
+
+  IListNode *rest = head->next;
+  head->next = NULL;
+
+  return rest;
+}
+
+// Appends the merge of two sorted chains to `tail`, returns the new tail.
+// Takes from `left` on ties so the sort is stable.
+static IListNode *IList_merge(IListNode *tail, IListNode *left,
+                              IListNode *right, IList_compare cmp) {
+  while (left && right) {
+    if (cmp(right, left) < 0) {
+      tail->next = right;
+      right = right->next;
+    } else {
+      tail->next = left;
+      left = left->next;
+    }
+    tail = tail->next;
+  }
+
+  tail->next = left ? left : right;
+  while (tail->next) {
+    tail = tail->next;
+  }
+
+  return tail;
+}
+
+void IList_merge_sort(IList *list, IList_compare cmp) {
+  if (list->count <= 1) {
+    return;
+  }
+
+  IListNode head = {.next = list->first, .prev = NULL};
+
+  for (int width = 1; width < list->count; width *= 2) {
+    IListNode *tail = &head;
+    IListNode *cur = head.next;
+
+    while (cur != NULL) {
+      IListNode *left = cur;
+      IListNode *right = IList_split(left, width);
+      cur = IList_split(right, width);
+
+      tail = IList_merge(tail, left, right, cmp);
+    }
+  }
+
+  IListNode *prev = NULL;
+  for (IListNode *cur = head.next; cur != NULL; cur = cur->next) {
+    cur->prev = prev;
+    prev = cur;
+  }
+
+  list->first = head.next;
+  list->last = prev;
+}
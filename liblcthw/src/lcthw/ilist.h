@@ -0,0 +1,113 @@
+#ifndef lcthw_IList_h
+#define lcthw_IList_h
+
+#include <stddef.h>
+
+/**
+ * Intrusive doubly linked list.
+ *
+ * Instead of a List holding `void *value` in nodes it allocates, the caller
+ * embeds an IListNode in its own struct and links that. Inserting never
+ * allocates, removing an element only needs the element, and getting from a
+ * node back to its struct is pointer arithmetic (IList_entry) rather than
+ * another dereference.
+ *
+ * ```
+ * struct Job { int priority; IListNode link; };
+ *
+ * IList jobs;
+ * IList_init(&jobs);
+ * IList_push(&jobs, &job->link);
+ * ILIST_FOREACH_ENTRY(&jobs, struct Job, link, cur) { run(cur); }
+ * ```
+ *
+ * A node can be in one IList at a time, embed several to be in several.
+ */
+
+typedef struct IListNode {
+  struct IListNode *next;
+  struct IListNode *prev;
+} IListNode;
+
+// NOTE: if `first` or `last` is `NULL`, means the list is empty.
+typedef struct IList {
+  int count;
+  IListNode *first;
+  IListNode *last;
+} IList;
+
+typedef int (*IList_compare)(const IListNode *a, const IListNode *b);
+
+/**
+ * Gets the struct of type `T` whose member `M` is the node `N`.
+ */
+#define IList_entry(N, T, M) ((T *)((char *)(N) - offsetof(T, M)))
+
+#define IList_count(A) ((A)->count)
+
+#define IList_first(A) ((A)->first)
+
+#define IList_last(A) ((A)->last)
+
+/**
+ * Empties the list. Linked nodes are forgotten, nothing is freed.
+ */
+void IList_init(IList *list);
+
+/**
+ * Links `node` at the end of the list.
+ */
+void IList_push(IList *list, IListNode *node);
+
+/**
+ * Unlinks and returns the last node, NULL if the list is empty.
+ */
+IListNode *IList_pop(IList *list);
+
+/**
+ * Links `node` at the beginning of the list.
+ */
+void IList_unshift(IList *list, IListNode *node);
+
+/**
+ * Unlinks and returns the first node, NULL if the list is empty.
+ */
+IListNode *IList_shift(IList *list);
+
+/**
+ * Links `node` right after `after`, which must be in the list.
+ */
+void IList_insert_after(IList *list, IListNode *after, IListNode *node);
+
+/**
+ * Unlinks `node`, which must be in `list`, in O(1).
+ */
+void IList_remove(IList *list, IListNode *node);
+
+/**
+ * Sorts the list in place with a stable bottom-up merge sort. No memory is
+ * allocated.
+ */
+void IList_merge_sort(IList *list, IList_compare cmp);
+
+/**
+ * Iterates over the nodes like LIST_FOREACH. The next node is read before
+ * the body runs, so the body may remove (or free) V.
+ */
+#define ILIST_FOREACH(L, S, M, V)                                              \
+  for (IListNode *V = (L)->S, *_inext = V ? V->M : NULL; V != NULL;            \
+       V = _inext, _inext = V ? V->M : NULL)
+
+/**
+ * Iterates over the structs of type `T` linked through their member `F`,
+ * first to last. The body may remove (or free) V.
+ */
+#define ILIST_FOREACH_ENTRY(L, T, F, V)                                        \
+  IListNode *_inode = NULL;                                                    \
+  T *V = NULL;                                                                 \
+  for (IListNode *_icur = (L)->first;                                          \
+       _icur != NULL &&                                                        \
+       (_inode = _icur->next, V = IList_entry(_icur, T, F), 1);                \
+       _icur = _inode)
+
+#endif
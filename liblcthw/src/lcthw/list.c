@@ -2,6 +2,52 @@
 #include <lcthw/list.h>
 #include <stdlib.h>
 
+// A block of nodes made by List_push_n or List_compact. Nodes can move
+// between lists, so each node points at its block and the block counts the
+// nodes still alive, the last one to go frees it.
+typedef struct ListSlab {
+  int live;
+  ListNode nodes[];
+} ListSlab;
+
+static ListSlab *List_slab_create(int count) {
+  ListSlab *slab = malloc(sizeof(ListSlab) + sizeof(ListNode) * count);
+  check_mem(slab);
+
+  slab->live = count;
+  for (int i = 0; i < count; i++) {
+    slab->nodes[i].slab = slab;
+  }
+
+  return slab;
+
+error:
+  return NULL;
+}
+
+// Every node is released through here, a slab node only drops its slab's
+// live count. Atomic because nodes of one slab may have been split into
+// lists that different threads own.
+static void List_free_node(ListNode *node) {
+  ListSlab *slab = node->slab;
+
+  if (slab == NULL) {
+    free(node);
+  } else if (__atomic_sub_fetch(&slab->live, 1, __ATOMIC_ACQ_REL) == 0) {
+    free(slab);
+  }
+}
+
+// List_free_node for every node of a NULL terminated chain.
+static void List_free_chain(ListNode *node) {
+  ListNode *next = NULL;
+
+  for (; node != NULL; node = next) {
+    next = node->next;
+    List_free_node(node);
+  }
+}
+
 List *List_create() {
   // allocate and zero data
   return calloc(1, sizeof(List));
@@ -11,11 +57,13 @@ void List_destroy(List *list) {
   // when we visiting a node `a``, we could free `a->prev`
   LIST_FOREACH(list, first, next, cur) {
     if (cur->prev) {
-      free(cur->prev);
+      List_free_node(cur->prev);
     }
   }
 
-  free(list->last);
+  if (list->last) {
+    List_free_node(list->last);
+  }
   free(list);
 }
 
@@ -81,6 +129,103 @@ void *List_shift(List *list) {
   return node != NULL ? List_remove(list, node) : NULL;
 }
 
+int List_push_n(List *list, void **values, int n) {
+  ListSlab *slab = NULL;
+  ListNode *prev = list->last;
+
+  if (n <= 0) {
+    return 0;
+  }
+
+  // one block for the batch, its nodes can still be removed one at a time
+  slab = List_slab_create(n);
+  check_mem(slab);
+
+  for (int i = 0; i < n; i++) {
+    ListNode *node = &slab->nodes[i];
+
+    node->value = values[i];
+    node->prev = prev;
+    node->next = NULL;
+
+    if (prev != NULL) {
+      prev->next = node;
+    }
+    prev = node;
+  }
+
+  if (list->last == NULL) {
+    list->first = &slab->nodes[0];
+  }
+
+  list->last = prev;
+  list->count += n;
+
+  return 0;
+
+error:
+  return -1;
+}
+
+int List_pop_n(List *list, void **values, int n) {
+  int taken = n < list->count ? n : list->count;
+  ListNode *cut = list->last;
+
+  if (taken <= 0) {
+    return 0;
+  }
+
+  // walking back from the end fills `values` from its end, so they keep the
+  // order they had in the list
+  values[taken - 1] = cut->value;
+  for (int i = taken - 2; i >= 0; i--) {
+    cut = cut->prev;
+    values[i] = cut->value;
+  }
+
+  list->last = cut->prev;
+  if (list->last == NULL) {
+    list->first = NULL;
+  } else {
+    list->last->next = NULL;
+  }
+
+  list->count -= taken;
+  List_free_chain(cut);
+
+  return taken;
+}
+
+int List_shift_n(List *list, void **values, int n) {
+  int taken = n < list->count ? n : list->count;
+  ListNode *cut = list->first;
+
+  if (taken <= 0) {
+    return 0;
+  }
+
+  for (int i = 0; i < taken; i++) {
+    values[i] = cut->value;
+    cut = cut->next;
+  }
+
+  ListNode *head = list->first;
+
+  if (cut == NULL) {
+    list->first = NULL;
+    list->last = NULL;
+  } else {
+    cut->prev->next = NULL;
+    cut->prev = NULL;
+    list->first = cut;
+  }
+
+  list->count -= taken;
+  List_free_chain(head);
+
+  return taken;
+}
+
 void *List_remove(List *list, ListNode *node) {
   void *result = NULL;
 
@@ -108,12 +253,41 @@ void *List_remove(List *list, ListNode *node) {
 
   list->count--;
   result = node->value;
-  free(node);
+  List_free_node(node);
 
 error:
   return result;
 }
 
+int List_compact(List *list) {
+  int count = list->count;
+
+  if (count == 0) {
+    return 0;
+  }
+
+  ListSlab *slab = List_slab_create(count);
+  check_mem(slab);
+  ListNode *nodes = slab->nodes;
+
+  int i = 0;
+  for (ListNode *cur = list->first; cur != NULL; cur = cur->next, i++) {
+    nodes[i].value = cur->value;
+    nodes[i].prev = i > 0 ? &nodes[i - 1] : NULL;
+    nodes[i].next = i < count - 1 ? &nodes[i + 1] : NULL;
+  }
+
+  List_free_chain(list->first);
+
+  list->first = &nodes[0];
+  list->last = &nodes[count - 1];
+
+  return 0;
+
+error:
+  return -1;
+}
+
 List *List_duplicate(List *list) {
   List *list_dup = List_create();
 
@@ -155,3 +329,104 @@ void List_split(List *list, ListNode *new_head_after_spilit, List **head_ret,
   *head_ret = head;
   *tail_ret = tail;
 }
+
+void List_concat_splice(List *head, List *tail) {
+  if (head == tail || tail->first == NULL) {
+    return;
+  }
+
+  if (head->last == NULL) {
+    head->first = tail->first;
+  } else {
+    head->last->next = tail->first;
+    tail->first->prev = head->last;
+  }
+
+  head->last = tail->last;
+  head->count += tail->count;
+
+  tail->first = NULL;
+  tail->last = NULL;
+  tail->count = 0;
+}
+
+// Moves `node` and everything after it, `moved` nodes, into a new list.
+static List *List_cut(List *list, ListNode *node, int moved) {
+  List *tail = List_create();
+  check_mem(tail);
+
+  if (node == NULL) {
+    return tail;
+  }
+
+  tail->first = node;
+  tail->last = list->last;
+  tail->count = moved;
+
+  list->last = node->prev;
+  if (list->last == NULL) {
+    list->first = NULL;
+  } else {
+    list->last->next = NULL;
+  }
+  node->prev = NULL;
+  list->count -= moved;
+
+  return tail;
+
+error:
+  return NULL;
+}
+
+List *List_split_splice(List *list, ListNode *node) {
+  // the count of each side is needed, walk in from both ends at once so this
+  // costs the distance from the nearer end
+  ListNode *front = list->first;
+  ListNode *back = list->last;
+  int moved = 0;
+
+  if (node != NULL) {
+    for (int i = 0;; i++) {
+      if (front == node) {
+        moved = list->count - i;
+        break;
+      }
+      if (back == node) {
+        moved = i + 1;
+        break;
+      }
+      check(front != NULL, "node isn't in the list.");
+      front = front->next;
+      back = back->prev;
+    }
+  }
+
+  return List_cut(list, node, moved);
+
+error:
+  return NULL;
+}
+
+List *List_split_at(List *list, int index) {
+  ListNode *node = NULL;
+
+  check(index >= 0 && index <= list->count, "Split index %d out of range.",
+        index);
+
+  if (index < list->count / 2) {
+    node = list->first;
+    for (int i = 0; i < index; i++) {
+      node = node->next;
+    }
+  } else if (index < list->count) {
+    node = list->last;
+    for (int i = list->count - 1; i > index; i--) {
+      node = node->prev;
+    }
+  }
+
+  return List_cut(list, node, list->count - index);
+
+error:
+  return NULL;
+}
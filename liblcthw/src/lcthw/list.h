@@ -3,12 +3,18 @@
 
 #include <stdlib.h>
 
+#ifdef __cplusplus
+extern "C" {
+#endif
+
 struct ListNode;
+struct ListSlab;
 
 typedef struct ListNode {
   struct ListNode *next;
   struct ListNode *prev;
   void *value;
+  struct ListSlab *slab; // Block shared with other nodes, NULL if alone.
 } ListNode;
 
 // NOTE: if `first` or `last` is `NULL`, means the list is empty.
@@ -87,6 +93,41 @@ void List_unshift(List *list, void *value);
  */
 void *List_shift(List *list);
 
+/**
+ * Adds `n` values to the end of the list, in order, linking them in one go.
+ * The nodes are allocated as one block, which is kept until the last of them
+ * is freed, so a batch costs one allocation rather than `n`.
+ *
+ * @param list A pointer to the list.
+ * @param values The values to add.
+ * @param n How many values to add.
+ * @return 0 on success, -1 if the nodes can't be allocated (the list is then
+ * left as it was).
+ */
+int List_push_n(List *list, void **values, int n);
+
+/**
+ * Removes up to `n` values from the end of the list into `values`, in the
+ * order they were in the list, so it undoes a List_push_n of the same count.
+ *
+ * @param list A pointer to the list.
+ * @param values Where to store the removed values, room for `n`.
+ * @param n How many values to remove at most.
+ * @return The number of values removed.
+ */
+int List_pop_n(List *list, void **values, int n);
+
+/**
+ * Removes up to `n` values from the beginning of the list into `values`, in
+ * list order.
+ *
+ * @param list A pointer to the list.
+ * @param values Where to store the removed values, room for `n`.
+ * @param n How many values to remove at most.
+ * @return The number of values removed.
+ */
+int List_shift_n(List *list, void **values, int n);
+
 /**
  * Removes the specified node from the list and returns its value.
  *
@@ -96,21 +137,70 @@ void *List_shift(List *list);
  */
 void *List_remove(List *list, ListNode *node);
 
+/**
+ * Moves the list's nodes into one contiguous slab, laid out in list order, so
+ * a walk from `first` reads memory sequentially. Values are untouched and
+ * node pointers held elsewhere become invalid.
+ *
+ * Slab nodes are removed and destroyed like any other node, the slab itself
+ * is freed with its last node.
+ *
+ * @return 0 on success, -1 if the slab can't be allocated (the list is then
+ * left as it was).
+ */
+int List_compact(List *list);
+
 /**
  * @note the val is shallow copied.
  */
 List *List_duplicate(List *list);
 
 /**
- * @note the val is shallow copied.
+ * @note the val is shallow copied, O(n). List_concat_splice moves the nodes
+ * instead.
  */
 List *List_concat(List *head, List *tail);
 
 /**
- * @note the val is shallow copied.
+ * @note the val is shallow copied, O(n). List_split_splice moves the nodes
+ * instead.
  */
 void List_split(List *list, ListNode *new_head_after_spilit, List **head_ret,
                 List **tail_ret);
+
+/**
+ * Moves every node of `tail` to the end of `head` in O(1), leaving `tail`
+ * empty. Nothing is copied or allocated, unlike List_concat.
+ *
+ * @param head The list to append to.
+ * @param tail The list whose nodes are moved, still to be destroyed.
+ */
+void List_concat_splice(List *head, List *tail);
+
+/**
+ * Moves `node` and every node after it out of `list` into a new list, which
+ * is returned. `list` keeps the nodes before `node`. No node is copied, the
+ * only walk is the one to find the counts, from whichever end of the list is
+ * nearer to `node`.
+ *
+ * @param list A pointer to the list.
+ * @param node A node of `list`, or NULL to move nothing.
+ * @return The new list, NULL if `node` isn't in `list` or on allocation
+ * failure.
+ */
+List *List_split_splice(List *list, ListNode *node);
+
+/**
+ * Moves the nodes from position `index` on into a new list, as
+ * List_split_splice. The node is found by walking from whichever end is
+ * closer.
+ *
+ * @param list A pointer to the list.
+ * @param index 0 moves every node, List_count(list) moves none.
+ * @return The new list, NULL if `index` is out of range or on allocation
+ * failure.
+ */
+List *List_split_at(List *list, int index);
 /**
  * Macro to iterate over the elements of the list.
  *
@@ -131,4 +221,29 @@ void List_split(List *list, ListNode *new_head_after_spilit, List **head_ret,
   ListNode *V = NULL;                                                          \
   for (V = _node = L->S; _node != NULL; V = _node = _node->M)
 
+#define LIST_PREFETCH_DISTANCE 8
+
+/**
+ * LIST_FOREACH that keeps a lead pointer LIST_PREFETCH_DISTANCE nodes ahead
+ * and prefetches the value it points at, so the body's `V->value` loads
+ * overlap instead of each waiting on memory.
+ *
+ * The node chain itself can't be fetched any earlier than it is followed, a
+ * list scattered over more memory than the cache still walks at memory
+ * latency per node. List_compact fixes that part.
+ */
+#define LIST_FOREACH_PREFETCH(L, S, M, V)                                      \
+  ListNode *_lead = L->S;                                                      \
+  for (int _ahead = 0; _lead && _ahead < LIST_PREFETCH_DISTANCE; _ahead++) {   \
+    __builtin_prefetch(_lead->value);                                          \
+    _lead = _lead->M;                                                          \
+  }                                                                            \
+  LIST_FOREACH(L, S, M, V)                                                     \
+  if (_lead && (__builtin_prefetch(_lead->value), _lead = _lead->M, 0)) {      \
+  } else
+
+#ifdef __cplusplus
+}
+#endif
+
 #endif
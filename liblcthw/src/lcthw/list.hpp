@@ -0,0 +1,235 @@
+#ifndef lcthw_List_hpp
+#define lcthw_List_hpp
+
+#include <initializer_list>
+#include <lcthw/list.h>
+#include <lcthw/value_slot.hpp>
+#include <new>
+#include <stdexcept>
+#include <utility>
+
+namespace lcthw {
+
+namespace detail {
+
+/**
+ * Bidirectional iterator over the nodes of a List. It keeps the list so
+ * that `--end()` reaches the last node.
+ */
+template <typename T> class NodeIterator {
+  using Slot = ValueSlot<std::remove_const_t<T>>;
+
+public:
+  using iterator_category = std::bidirectional_iterator_tag;
+  using value_type = std::remove_const_t<T>;
+  using difference_type = std::ptrdiff_t;
+  using pointer = T *;
+  using reference = T &;
+
+  NodeIterator() = default;
+  NodeIterator(::List *list, ListNode *node) : list_(list), node_(node) {}
+
+  template <typename U,
+            typename = std::enable_if_t<std::is_same_v<const U, T> &&
+                                        !std::is_same_v<U, T>>>
+  NodeIterator(const NodeIterator<U> &other)
+      : list_(other.list()), node_(other.node()) {}
+
+  ::List *list() const { return list_; }
+  ListNode *node() const { return node_; }
+
+  reference operator*() const { return Slot::ref(node_->value); }
+  pointer operator->() const { return &Slot::ref(node_->value); }
+
+  NodeIterator &operator++() {
+    node_ = node_->next;
+    return *this;
+  }
+  NodeIterator operator++(int) {
+    NodeIterator old = *this;
+    ++*this;
+    return old;
+  }
+  NodeIterator &operator--() {
+    node_ = node_ != nullptr ? node_->prev : list_->last;
+    return *this;
+  }
+  NodeIterator operator--(int) {
+    NodeIterator old = *this;
+    --*this;
+    return old;
+  }
+
+  friend bool operator==(const NodeIterator &a, const NodeIterator &b) {
+    return a.node_ == b.node_;
+  }
+  friend bool operator!=(const NodeIterator &a, const NodeIterator &b) {
+    return a.node_ != b.node_;
+  }
+
+private:
+  ::List *list_ = nullptr;
+  ListNode *node_ = nullptr;
+};
+
+} // namespace detail
+
+/**
+ * Owning C++ handle on a List of T, stored like lcthw::DArray stores them:
+ * small trivially copyable values in the node's `value`, anything else
+ * boxed. Allocation failures throw std::bad_alloc.
+ */
+template <typename T> class List {
+  using Slot = detail::ValueSlot<T>;
+
+public:
+  using value_type = T;
+  using size_type = std::size_t;
+  using reference = T &;
+  using const_reference = const T &;
+  using iterator = detail::NodeIterator<T>;
+  using const_iterator = detail::NodeIterator<const T>;
+
+  List() : list_(List_create()) {
+    if (list_ == nullptr) {
+      throw std::bad_alloc();
+    }
+  }
+
+  List(std::initializer_list<T> values) : List() {
+    for (const T &value : values) {
+      push_back(value);
+    }
+  }
+
+  List(List &&other) noexcept : list_(std::exchange(other.list_, nullptr)) {}
+
+  List &operator=(List &&other) noexcept {
+    std::swap(list_, other.list_);
+    return *this;
+  }
+
+  List(const List &) = delete;
+  List &operator=(const List &) = delete;
+
+  ~List() {
+    if (list_ != nullptr) {
+      destroy_values();
+      List_destroy(list_);
+    }
+  }
+
+  template <typename... Args> T &emplace_back(Args &&...args) {
+    void *slot = Slot::make(std::forward<Args>(args)...);
+    int count = list_->count;
+
+    // List_push only logs a failed allocation
+    List_push(list_, slot);
+    if (list_->count == count) {
+      Slot::destroy(slot);
+      throw std::bad_alloc();
+    }
+    return back();
+  }
+
+  template <typename... Args> T &emplace_front(Args &&...args) {
+    void *slot = Slot::make(std::forward<Args>(args)...);
+    int count = list_->count;
+
+    List_unshift(list_, slot);
+    if (list_->count == count) {
+      Slot::destroy(slot);
+      throw std::bad_alloc();
+    }
+    return front();
+  }
+
+  void push_back(const T &value) { emplace_back(value); }
+  void push_back(T &&value) { emplace_back(std::move(value)); }
+  void push_front(const T &value) { emplace_front(value); }
+  void push_front(T &&value) { emplace_front(std::move(value)); }
+
+  /**
+   * Removes and returns the last value, std::out_of_range when empty.
+   */
+  T pop_back() {
+    if (empty()) {
+      throw std::out_of_range("pop_back on an empty List");
+    }
+    return Slot::take(List_pop(list_));
+  }
+
+  /**
+   * Removes and returns the first value, std::out_of_range when empty.
+   */
+  T pop_front() {
+    if (empty()) {
+      throw std::out_of_range("pop_front on an empty List");
+    }
+    return Slot::take(List_shift(list_));
+  }
+
+  /**
+   * Removes the value at `pos`, returns an iterator to the one after it.
+   */
+  iterator erase(const_iterator pos) {
+    ListNode *next = pos.node()->next;
+    Slot::destroy(List_remove(list_, pos.node()));
+    return iterator(list_, next);
+  }
+
+  void clear() {
+    destroy_values();
+    while (list_->count > 0) {
+      List_shift(list_);
+    }
+  }
+
+  /**
+   * Moves every node of `other` to the end of this list in O(1), leaving
+   * `other` empty. See List_concat_splice.
+   */
+  void splice(List &other) { List_concat_splice(list_, other.list_); }
+
+  T &front() { return Slot::ref(list_->first->value); }
+  const T &front() const { return Slot::ref(list_->first->value); }
+  T &back() { return Slot::ref(list_->last->value); }
+  const T &back() const { return Slot::ref(list_->last->value); }
+
+  size_type size() const { return List_count(list_); }
+  bool empty() const { return List_count(list_) == 0; }
+
+  iterator begin() { return iterator(list_, list_->first); }
+  iterator end() { return iterator(list_, nullptr); }
+  const_iterator begin() const { return const_iterator(list_, list_->first); }
+  const_iterator end() const { return const_iterator(list_, nullptr); }
+  const_iterator cbegin() const { return begin(); }
+  const_iterator cend() const { return end(); }
+
+  /**
+   * The underlying List, still owned by this object.
+   */
+  ::List *get() const { return list_; }
+
+  /**
+   * Gives up ownership of the List. Boxed values become the caller's to
+   * `delete`.
+   */
+  ::List *release() { return std::exchange(list_, nullptr); }
+
+private:
+  void destroy_values() {
+    if constexpr (!Slot::is_inline) {
+      for (ListNode *node = list_->first; node != nullptr; node = node->next) {
+        Slot::destroy(node->value);
+        node->value = nullptr;
+      }
+    }
+  }
+
+  ::List *list_;
+};
+
+} // namespace lcthw
+
+#endif
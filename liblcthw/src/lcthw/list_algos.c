@@ -1,6 +1,7 @@
 #include <lcthw/list.h>
 #include <lcthw/list_algos.h>
 #include <stdlib.h>
+#include <string.h>
 
 int List_bubble_sort(List *list, List_compare cmp) {
   ListNode *loop_end = list->last;
@@ -49,9 +50,24 @@ List *List_insert_sorted(List *sorted_list, ListNode *node, List_compare cmp) {
     }
   }
 
+  if (right == NULL) {
+    // every value is <= node, so it goes to the end (or into an empty list)
+    node->next = NULL;
+    node->prev = sorted_list->last;
+    if (sorted_list->last) {
+      sorted_list->last->next = node;
+    } else {
+      sorted_list->first = node;
+    }
+    sorted_list->last = node;
+    sorted_list->count++;
+    return sorted_list;
+  }
+
   ListNode *left = right->prev;
   if (left == NULL) {
     // means the `right` is the first, and the `val` will be the first node.
+    node->prev = NULL;
     node->next = sorted_list->first;
     sorted_list->first->prev = node;
     sorted_list->first = node;
@@ -66,74 +82,228 @@ List *List_insert_sorted(List *sorted_list, ListNode *node, List_compare cmp) {
   return sorted_list;
 }
 
-static List *merge_sorted_lists(List *left, List *right, List_compare cmp) {
-  List *l = List_create();
+// ---- natural merge sort -----------------------------------------------------
+//
+// Runs that are already in order (or strictly reversed) are found in one pass
+// and merged TimSort style, keeping the run lengths on a stack so merges stay
+// balanced. Nothing is allocated: nodes are only relinked. While sorting only
+// `next` is maintained, `prev` is rebuilt in one pass at the end.
+//
+// Galloping in TimSort needs random access, on a list the saving comes from
+// splicing: a stretch of nodes won from one side is linked with one write, and
+// two runs that don't overlap at all are joined in O(1).
+
+#define LIST_SORT_MAX_RUNS 64
+// Merges smaller than this don't run far enough to pay for their leads.
+#define LIST_SORT_PREFETCH_MIN (8 * LIST_PREFETCH_DISTANCE)
+
+typedef struct ListRun {
+  ListNode *head;
+  ListNode *tail;
+  int len;
+} ListRun;
+
+typedef struct ListSorter {
+  List_compare cmp;
+  int prefetch;   // List_sort_prefetch, see list_lead.
+  ListNode *lead; // Runs ahead of the run scan when prefetching.
+} ListSorter;
+
+// Starts a lead pointer LIST_PREFETCH_DISTANCE nodes down the chain from
+// `node`, prefetching each value on the way. Stepped with list_lead_step
+// whenever the cursor behind it moves, it keeps the cursor's values in
+// cache.
+static inline ListNode *list_lead(ListNode *node) {
+  for (int i = 0; node && i < LIST_PREFETCH_DISTANCE; i++) {
+    __builtin_prefetch(node->value);
+    node = node->next;
+  }
 
-  ListNode *left_cur = left->first;
-  ListNode *right_cur = right->first;
+  return node;
+}
 
-  // NOTE: in this func, we can NOT use `List_insert_sorted`, it will update the
-  // node's `left` and `right` in place, and break the chain of origin list.
-  while (left_cur != NULL && right_cur != NULL) {
+#define list_lead_step(L)                                                      \
+  if (L) {                                                                     \
+    __builtin_prefetch((L)->value);                                            \
+    (L) = (L)->next;                                                           \
+  }
 
-    if (cmp(left_cur->value, right_cur->value) < 0) {
-      List_push(l, left_cur->value);
-      left_cur = left_cur->next;
-    } else {
-      List_push(l, right_cur->value);
-      right_cur = right_cur->next;
-    }
+// Cuts the next natural run off `*rest`, reversing it if it is descending.
+static ListRun list_next_run(ListSorter *s, ListNode **rest) {
+  ListNode *head = *rest;
+  ListNode *cur = head->next;
+  ListRun run = {head, head, 1};
+
+  if (s->prefetch) {
+    list_lead_step(s->lead);
   }
 
-  while (left_cur != NULL) {
-    List_push(l, left_cur->value);
-    left_cur = left_cur->next;
+  if (cur != NULL && s->cmp(head->value, cur->value) > 0) {
+    // strictly descending, so reversing it keeps equal values in order
+    ListNode *prev = head;
+    head->next = NULL;
+
+    while (cur != NULL && s->cmp(prev->value, cur->value) > 0) {
+      ListNode *next = cur->next;
+      cur->next = prev;
+      prev = cur;
+      cur = next;
+      run.len++;
+      if (s->prefetch) {
+        list_lead_step(s->lead);
+      }
+    }
+
+    run.head = prev;
+    *rest = cur;
+    return run;
   }
 
-  while (right_cur != NULL) {
-    List_push(l, right_cur->value);
-    right_cur = right_cur->next;
+  while (cur != NULL && s->cmp(run.tail->value, cur->value) <= 0) {
+    run.tail = cur;
+    cur = cur->next;
+    run.len++;
+    if (s->prefetch) {
+      list_lead_step(s->lead);
+    }
   }
 
-  return l;
+  run.tail->next = NULL;
+  *rest = cur;
+  return run;
 }
 
-List *List_merge_sort(List *list, List_compare cmp) {
+// Merges run `b` into run `a`, `a` came first so it wins ties.
+static void list_merge_runs(ListSorter *s, ListRun *a, ListRun *b) {
+  List_compare cmp = s->cmp;
 
-  if (list->count <= 1) {
-    return list;
+  if (cmp(a->tail->value, b->head->value) <= 0) {
+    a->tail->next = b->head;
+    a->tail = b->tail;
+  } else if (cmp(b->tail->value, a->head->value) < 0) {
+    b->tail->next = a->head;
+    a->head = b->head;
+  } else {
+    ListNode dummy = {};
+    ListNode *tail = &dummy;
+    ListNode *l = a->head;
+    ListNode *r = b->head;
+    ListNode *l_lead = NULL;
+    ListNode *r_lead = NULL;
+
+    if (s->prefetch && a->len + b->len >= LIST_SORT_PREFETCH_MIN) {
+      l_lead = list_lead(l);
+      r_lead = list_lead(r);
+    }
+
+    while (l && r) {
+      if (cmp(r->value, l->value) < 0) {
+        tail->next = r;
+        do {
+          tail = r;
+          r = r->next;
+          list_lead_step(r_lead);
+        } while (r && cmp(r->value, l->value) < 0);
+      } else {
+        tail->next = l;
+        do {
+          tail = l;
+          l = l->next;
+          list_lead_step(l_lead);
+        } while (l && cmp(r->value, l->value) >= 0);
+      }
+    }
+
+    if (l) {
+      tail->next = l;
+    } else {
+      tail->next = r;
+      a->tail = b->tail;
+    }
+    a->head = dummy.next;
   }
 
-  List *left = List_create();
-  List *right = List_create();
+  a->len += b->len;
+}
 
-  int left_count = list->count / 2;
+static void list_merge_at(ListSorter *s, ListRun *runs, int *n, int i) {
+  list_merge_runs(s, &runs[i], &runs[i + 1]);
 
-  for (ListNode *cur = list->first; cur != NULL; cur = cur->next) {
-    if (left_count > 0) {
-      List_push(left, cur->value);
-      --left_count;
-    } else {
-      List_push(right, cur->value);
+  for (int j = i + 1; j < *n - 1; j++) {
+    runs[j] = runs[j + 1];
+  }
+  (*n)--;
+}
+
+// Restores the TimSort invariants on the run stack.
+static void list_merge_collapse(ListSorter *s, ListRun *runs, int *n) {
+  while (*n > 1) {
+    int k = *n - 2;
+
+    if ((k > 0 && runs[k - 1].len <= runs[k].len + runs[k + 1].len) ||
+        (k > 1 && runs[k - 2].len <= runs[k - 1].len + runs[k].len)) {
+      if (runs[k - 1].len < runs[k + 1].len) {
+        k--;
+      }
+    } else if (runs[k].len > runs[k + 1].len) {
+      break;
     }
+
+    list_merge_at(s, runs, n, k);
   }
+}
 
-  List *left_sorted = List_merge_sort(left, cmp);
-  List *right_sorted = List_merge_sort(right, cmp);
+static int list_sort(List *list, ListSorter *s) {
+  ListRun runs[LIST_SORT_MAX_RUNS];
+  ListNode *rest = list->first;
+  int n = 0;
 
-  if (left_sorted != left) {
-    List_destroy(left);
+  if (list->count <= 1) {
+    return 0;
   }
-  if (right_sorted != right) {
-    List_destroy(right);
+
+  if (s->prefetch) {
+    s->lead = list_lead(rest);
+  }
+
+  while (rest != NULL) {
+    runs[n++] = list_next_run(s, &rest);
+    list_merge_collapse(s, runs, &n);
+  }
+
+  while (n > 1) {
+    int k = n - 2;
+    if (k > 0 && runs[k - 1].len < runs[k + 1].len) {
+      k--;
+    }
+    list_merge_at(s, runs, &n, k);
   }
 
-  List *ret = merge_sorted_lists(left_sorted, right_sorted, cmp);
+  ListNode *prev = NULL;
+  for (ListNode *cur = runs[0].head; cur != NULL; cur = cur->next) {
+    cur->prev = prev;
+    prev = cur;
+  }
 
-  List_destroy(left_sorted);
-  List_destroy(right_sorted);
+  list->first = runs[0].head;
+  list->last = runs[0].tail;
 
-  return ret;
+  return 0;
+}
+
+int List_sort(List *list, List_compare cmp) {
+  ListSorter s = {cmp, 0, NULL};
+  return list_sort(list, &s);
+}
+
+int List_sort_prefetch(List *list, List_compare cmp) {
+  ListSorter s = {cmp, 1, NULL};
+  return list_sort(list, &s);
+}
+
+List *List_merge_sort(List *list, List_compare cmp) {
+  List_sort(list, cmp);
+  return list;
 }
 
 // ---- impl of bottom to up merge sort ---------------------------------------
@@ -235,3 +405,195 @@ List *List_merge_sort_bottom_up(List *list, List_compare cmp) {
 
   return list;
 }
+
+// ---- radix sorts -------------------------------------------------------------
+//
+// Nodes are distributed into bucket chains held on the stack and the chains
+// are joined back in order, so nothing is allocated and every pass
+// keeps equal keys in order.
+
+#define RADIX_BUCKETS 256
+// Wider digits than a byte for integers: fewer passes over the list, and the
+// bucket arrays (32KB) still fit on the stack and in L1/L2.
+#define RADIX_U64_BITS 11
+#define RADIX_U64_BUCKETS (1 << RADIX_U64_BITS)
+// MSD buckets smaller than this are finished with List_sort.
+#define RADIX_MSD_CUTOFF 16
+// Deeper than this (keys with long common prefixes) List_sort finishes too,
+// so the recursion's stack use stays bounded.
+#define RADIX_MSD_MAX_DEPTH 64
+
+// Rebuilds `prev`, `first` and `last` from a sorted `next` chain.
+static void radix_relink(List *list, ListNode *head) {
+  ListNode *prev = NULL;
+
+  for (ListNode *cur = head; cur != NULL; cur = cur->next) {
+    cur->prev = prev;
+    prev = cur;
+  }
+
+  list->first = head;
+  list->last = prev;
+}
+
+// Distributes the chain at `head` on the RADIX_U64_BITS wide digit at
+// `shift` and joins the buckets back in order. With `varying` set it also
+// works out which key bits differ between any two nodes.
+static ListNode *radix_u64_pass(ListNode *head, List_key_u64 key, int shift,
+                                uint64_t *varying) {
+  ListNode *heads[RADIX_U64_BUCKETS] = {NULL};
+  ListNode *tails[RADIX_U64_BUCKETS];
+  uint64_t all_or = 0;
+  uint64_t all_and = ~(uint64_t)0;
+
+  for (ListNode *cur = head; cur != NULL; cur = cur->next) {
+    uint64_t k = key(cur->value);
+    int b = (k >> shift) & (RADIX_U64_BUCKETS - 1);
+
+    if (varying) {
+      all_or |= k;
+      all_and &= k;
+    }
+
+    if (heads[b] == NULL) {
+      heads[b] = cur;
+    } else {
+      tails[b]->next = cur;
+    }
+    tails[b] = cur;
+  }
+
+  if (varying) {
+    *varying = all_or ^ all_and;
+  }
+
+  ListNode *tail = NULL;
+  head = NULL;
+  for (int b = 0; b < RADIX_U64_BUCKETS; b++) {
+    if (heads[b] == NULL) {
+      continue;
+    }
+
+    if (tail == NULL) {
+      head = heads[b];
+    } else {
+      tail->next = heads[b];
+    }
+    tail = tails[b];
+  }
+  tail->next = NULL;
+
+  return head;
+}
+
+int List_radix_sort_u64(List *list, List_key_u64 key) {
+  uint64_t varying = 0;
+
+  if (list->count <= 1) {
+    return 0;
+  }
+
+  // the first pass also finds the bits that differ, digits that are the same
+  // in every key (the top of timestamps, say) are skipped after it
+  ListNode *head = radix_u64_pass(list->first, key, 0, &varying);
+
+  for (int shift = RADIX_U64_BITS; shift < 64; shift += RADIX_U64_BITS) {
+    if ((varying >> shift) & (RADIX_U64_BUCKETS - 1)) {
+      head = radix_u64_pass(head, key, shift, NULL);
+    }
+  }
+
+  radix_relink(list, head);
+  return 0;
+}
+
+// List_sort's comparator has no context, the fallback finds the extractor
+// here.
+static __thread List_key_bstr radix_bstr_key = NULL;
+
+// The order the buckets give: unsigned bytes, a prefix before longer keys.
+static int radix_bstr_cmp(const void *a, const void *b) {
+  bstring x = radix_bstr_key(a);
+  bstring y = radix_bstr_key(b);
+  int n = x->slen < y->slen ? x->slen : y->slen;
+  int rc = memcmp(x->data, y->data, n);
+
+  return rc != 0 ? rc : (x->slen > y->slen) - (x->slen < y->slen);
+}
+
+static inline int radix_bstr_byte(bstring s, int depth) {
+  return depth < s->slen ? s->data[depth] + 1 : 0;
+}
+
+// Sorts the `count` node chain starting at `head` whose keys all share their
+// first `depth` bytes. Returns the new head and sets `*tail`.
+static ListNode *radix_msd(ListNode *head, int count, int depth,
+                           ListNode **tail) {
+  if (count < RADIX_MSD_CUTOFF || depth >= RADIX_MSD_MAX_DEPTH) {
+    List sub = {count, head, NULL};
+    List_sort(&sub, radix_bstr_cmp);
+    *tail = sub.last;
+    return sub.first;
+  }
+
+  // bucket 0 holds the keys that end here, they come first and are equal
+  ListNode *heads[RADIX_BUCKETS + 1] = {NULL};
+  ListNode *tails[RADIX_BUCKETS + 1];
+  int counts[RADIX_BUCKETS + 1] = {0};
+
+  for (ListNode *cur = head; cur != NULL; cur = cur->next) {
+    int b = radix_bstr_byte(radix_bstr_key(cur->value), depth);
+
+    if (heads[b] == NULL) {
+      heads[b] = cur;
+    } else {
+      tails[b]->next = cur;
+    }
+    tails[b] = cur;
+    counts[b]++;
+  }
+
+  ListNode *first = NULL;
+  ListNode *last = NULL;
+
+  for (int b = 0; b <= RADIX_BUCKETS; b++) {
+    if (heads[b] == NULL) {
+      continue;
+    }
+
+    ListNode *bucket_tail = tails[b];
+    bucket_tail->next = NULL;
+
+    ListNode *bucket = heads[b];
+    if (b > 0 && counts[b] > 1) {
+      bucket = radix_msd(bucket, counts[b], depth + 1, &bucket_tail);
+    }
+
+    if (last == NULL) {
+      first = bucket;
+    } else {
+      last->next = bucket;
+    }
+    last = bucket_tail;
+  }
+
+  *tail = last;
+  return first;
+}
+
+int List_radix_sort_bstr(List *list, List_key_bstr key) {
+  ListNode *tail = NULL;
+
+  if (list->count <= 1) {
+    return 0;
+  }
+
+  List_key_bstr saved = radix_bstr_key;
+  radix_bstr_key = key;
+
+  ListNode *head = radix_msd(list->first, list->count, 0, &tail);
+
+  radix_bstr_key = saved;
+  radix_relink(list, head);
+  return 0;
+}
@@ -1,14 +1,67 @@
 #ifndef lcthw_List_algos_h
 #define lcthw_List_algos_h
 
+#include <lcthw/bstrlib.h>
 #include <lcthw/list.h>
+#include <stdint.h>
 
 typedef int (*List_compare)(const void *a, const void *b);
 
+// Key extractors for the radix sorts, called with a node's value.
+typedef uint64_t (*List_key_u64)(const void *value);
+typedef bstring (*List_key_bstr)(const void *value);
+
 int List_bubble_sort(List *list, List_compare cmp);
 
+/**
+ * Links `node` into an already sorted list after every value <= its own,
+ * in O(n). The node must not be in any list.
+ */
+List *List_insert_sorted(List *sorted_list, ListNode *node, List_compare cmp);
+
+/**
+ * Sorts the list in place with a stable natural merge sort: ordered and
+ * reversed runs are found first and merged TimSort style, so sorted or
+ * nearly sorted lists take O(n). Nodes are relinked, nothing is allocated.
+ *
+ * @return 0, like List_bubble_sort.
+ */
+int List_sort(List *list, List_compare cmp);
+
+/**
+ * List_sort that prefetches values LIST_PREFETCH_DISTANCE nodes ahead of
+ * the run scan and of both sides of every long merge. Worth it when the
+ * values are scattered over more memory than the cache holds, otherwise the
+ * extra pointer walks only cost time.
+ */
+int List_sort_prefetch(List *list, List_compare cmp);
+
+/**
+ * Same as List_sort, kept for the book's interface.
+ *
+ * @return `list` itself, now sorted. No new list is created.
+ */
 List *List_merge_sort(List *list, List_compare cmp);
 
 List *List_merge_sort_bottom_up(List *list, List_compare cmp);
 
+/**
+ * Stable LSD radix sort on a 64-bit unsigned key, 11 bits per pass. Digits
+ * that are equal in every key are skipped, so keys that only differ in their
+ * low bits (timestamps close together) take fewer passes. Signed keys sort
+ * correctly if the extractor flips their sign bit.
+ *
+ * Nodes are relinked, nothing is allocated. O(n * k) for k varying digits.
+ */
+int List_radix_sort_u64(List *list, List_key_u64 key);
+
+/**
+ * Stable MSD radix sort on a bstring key, by unsigned bytes with a prefix
+ * before longer keys (bstrcmp's order for ASCII keys). Small buckets, and
+ * keys sharing more than 64 leading bytes, are finished with List_sort.
+ *
+ * Nodes are relinked, nothing is allocated.
+ */
+int List_radix_sort_bstr(List *list, List_key_bstr key);
+
 #endif
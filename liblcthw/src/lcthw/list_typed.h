@@ -0,0 +1,250 @@
+#ifndef lcthw_ListTyped_h
+#define lcthw_ListTyped_h
+
+#include <lcthw/dbg.h>
+#include <stdlib.h>
+
+/**
+ * Type-specialized doubly linked lists, queues and sorts, generated by macro.
+ *
+ * List keeps a `void *` in each node, so small values need an allocation of
+ * their own, and List_sort calls the comparator through a pointer for every
+ * comparison. `LIST_DEFINE(I64List, int64_t)` emits a list whose nodes hold
+ * the `int64_t` itself, and `LIST_SORT_DEFINE(I64List, int64_t, CMP)` a sort
+ * with CMP inlined:
+ *
+ * ```
+ * #define I64_CMP(a, b) (((a) > (b)) - ((a) < (b)))
+ *
+ * LIST_DEFINE(I64List, int64_t)
+ * LIST_SORT_DEFINE(I64List, int64_t, I64_CMP)
+ *
+ * I64List *l = I64List_create();
+ * I64List_push(l, 3);
+ * I64List_sort(l);
+ * LIST_TYPED_FOREACH(l, cur) { printf("%ld\n", cur->value); }
+ * ```
+ *
+ * Use each once per type, at file scope.
+ */
+
+#define LIST_DEFINE(N, T)                                                      \
+  typedef struct N##Node {                                                     \
+    struct N##Node *next;                                                      \
+    struct N##Node *prev;                                                      \
+    T value;                                                                   \
+  } N##Node;                                                                   \
+                                                                               \
+  typedef struct N {                                                           \
+    int count;                                                                 \
+    N##Node *first;                                                            \
+    N##Node *last;                                                             \
+  } N;                                                                         \
+                                                                               \
+  static inline N *N##_create() { return calloc(1, sizeof(N)); }               \
+                                                                               \
+  static inline void N##_destroy(N *list) {                                    \
+    N##Node *node = list->first;                                               \
+    while (node != NULL) {                                                     \
+      N##Node *next = node->next;                                              \
+      free(node);                                                              \
+      node = next;                                                             \
+    }                                                                          \
+    free(list);                                                                \
+  }                                                                            \
+                                                                               \
+  static inline int N##_push(N *list, T value) {                               \
+    N##Node *node = malloc(sizeof(N##Node));                                   \
+    check_mem(node);                                                           \
+                                                                               \
+    node->value = value;                                                       \
+    node->next = NULL;                                                         \
+    node->prev = list->last;                                                   \
+                                                                               \
+    if (list->last == NULL) {                                                  \
+      list->first = node;                                                      \
+    } else {                                                                   \
+      list->last->next = node;                                                 \
+    }                                                                          \
+    list->last = node;                                                         \
+    list->count++;                                                             \
+    return 0;                                                                  \
+                                                                               \
+  error:                                                                       \
+    return -1;                                                                 \
+  }                                                                            \
+                                                                               \
+  static inline int N##_unshift(N *list, T value) {                            \
+    N##Node *node = malloc(sizeof(N##Node));                                   \
+    check_mem(node);                                                           \
+                                                                               \
+    node->value = value;                                                       \
+    node->prev = NULL;                                                         \
+    node->next = list->first;                                                  \
+                                                                               \
+    if (list->first == NULL) {                                                 \
+      list->last = node;                                                       \
+    } else {                                                                   \
+      list->first->prev = node;                                                \
+    }                                                                          \
+    list->first = node;                                                        \
+    list->count++;                                                             \
+    return 0;                                                                  \
+                                                                               \
+  error:                                                                       \
+    return -1;                                                                 \
+  }                                                                            \
+                                                                               \
+  /* Unlinks and frees `node`, its value goes to `out` if not NULL. */         \
+  static inline void N##_remove(N *list, N##Node *node, T *out) {              \
+    if (node->prev) {                                                          \
+      node->prev->next = node->next;                                           \
+    } else {                                                                   \
+      list->first = node->next;                                                \
+    }                                                                          \
+                                                                               \
+    if (node->next) {                                                          \
+      node->next->prev = node->prev;                                           \
+    } else {                                                                   \
+      list->last = node->prev;                                                 \
+    }                                                                          \
+                                                                               \
+    if (out) {                                                                 \
+      *out = node->value;                                                      \
+    }                                                                          \
+    free(node);                                                                \
+    list->count--;                                                             \
+  }                                                                            \
+                                                                               \
+  /* Removes the last value into `out`, -1 if the list is empty. */            \
+  static inline int N##_pop(N *list, T *out) {                                 \
+    if (list->last == NULL) {                                                  \
+      return -1;                                                               \
+    }                                                                          \
+    N##_remove(list, list->last, out);                                         \
+    return 0;                                                                  \
+  }                                                                            \
+                                                                               \
+  /* Removes the first value into `out`, -1 if the list is empty. */           \
+  static inline int N##_shift(N *list, T *out) {                               \
+    if (list->first == NULL) {                                                 \
+      return -1;                                                               \
+    }                                                                          \
+    N##_remove(list, list->first, out);                                        \
+    return 0;                                                                  \
+  }                                                                            \
+                                                                               \
+  static inline int N##_count(N *list) { return list->count; }
+
+/**
+ * Emits `void N##_sort(N *list)` for a list made by LIST_DEFINE(N, T): a
+ * stable merge sort that relinks nodes and allocates nothing. Like the Linux
+ * kernel's list_sort it walks the list once, merging pending runs of equal
+ * power of two sizes as a binary counter would, so merges work on nodes that
+ * are still in cache. `CMP(a, b)` gets two `T` values and returns <0, 0 or
+ * >0 like List_compare. A function-like macro or a static inline function
+ * both end up inlined.
+ */
+#define LIST_SORT_DEFINE(N, T, CMP)                                            \
+  /* Merges two sorted chains, `left` wins ties so the sort is stable. */      \
+  static inline N##Node *N##_sort_merge(N##Node *left, N##Node *right) {       \
+    N##Node head;                                                              \
+    N##Node *tail = &head;                                                     \
+                                                                               \
+    while (left && right) {                                                    \
+      if (CMP(right->value, left->value) < 0) {                                \
+        tail->next = right;                                                    \
+        right = right->next;                                                   \
+      } else {                                                                 \
+        tail->next = left;                                                     \
+        left = left->next;                                                     \
+      }                                                                        \
+      tail = tail->next;                                                       \
+    }                                                                          \
+                                                                               \
+    tail->next = left ? left : right;                                          \
+    return head.next;                                                          \
+  }                                                                            \
+                                                                               \
+  static inline void N##_sort(N *list) {                                       \
+    /* pending[k] is NULL or a sorted run of 2^k nodes. */                     \
+    N##Node *pending[sizeof(int) * 8] = {NULL};                                \
+    N##Node *cur = list->first;                                                \
+    int top = 0;                                                               \
+                                                                               \
+    if (list->count <= 1) {                                                    \
+      return;                                                                  \
+    }                                                                          \
+                                                                               \
+    while (cur != NULL) {                                                      \
+      N##Node *next = cur->next;                                               \
+      int k = 0;                                                               \
+                                                                               \
+      cur->next = NULL;                                                        \
+      for (; pending[k] != NULL; k++) {                                        \
+        cur = N##_sort_merge(pending[k], cur);                                 \
+        pending[k] = NULL;                                                     \
+      }                                                                        \
+      pending[k] = cur;                                                        \
+      if (k > top) {                                                           \
+        top = k;                                                               \
+      }                                                                        \
+      cur = next;                                                              \
+    }                                                                          \
+                                                                               \
+    /* Higher levels hold earlier nodes, so they go on the left. */            \
+    cur = NULL;                                                                \
+    for (int k = 0; k <= top; k++) {                                           \
+      if (pending[k] != NULL) {                                                \
+        cur = cur ? N##_sort_merge(pending[k], cur) : pending[k];              \
+      }                                                                        \
+    }                                                                          \
+                                                                               \
+    list->first = cur;                                                         \
+    N##Node *prev = NULL;                                                      \
+    for (; cur != NULL; cur = cur->next) {                                     \
+      cur->prev = prev;                                                        \
+      prev = cur;                                                              \
+    }                                                                          \
+    list->last = prev;                                                         \
+  }
+
+/**
+ * A typed Queue over LIST_DEFINE, with Queue's interface. Values come back
+ * through an out parameter, -1 when the queue is empty.
+ */
+#define QUEUE_DEFINE(N, T)                                                     \
+  LIST_DEFINE(N##List, T)                                                      \
+                                                                               \
+  typedef struct N##List N;                                                    \
+                                                                               \
+  static inline N *N##_create() { return N##List_create(); }                   \
+                                                                               \
+  static inline void N##_destroy(N *queue) { N##List_destroy(queue); }         \
+                                                                               \
+  static inline int N##_send(N *queue, T value) {                              \
+    return N##List_push(queue, value);                                         \
+  }                                                                            \
+                                                                               \
+  static inline int N##_recv(N *queue, T *out) {                               \
+    return N##List_shift(queue, out);                                          \
+  }                                                                            \
+                                                                               \
+  static inline int N##_peek(N *queue, T *out) {                               \
+    if (queue->first == NULL) {                                                \
+      return -1;                                                               \
+    }                                                                          \
+    *out = queue->first->value;                                                \
+    return 0;                                                                  \
+  }                                                                            \
+                                                                               \
+  static inline int N##_count(N *queue) { return queue->count; }
+
+/**
+ * Iterates over the nodes of a LIST_DEFINE list, first to last. V is a node
+ * pointer, `V->value` the element.
+ */
+#define LIST_TYPED_FOREACH(L, V)                                               \
+  for (__typeof__((L)->first) V = (L)->first; V != NULL; V = V->next)
+
+#endif
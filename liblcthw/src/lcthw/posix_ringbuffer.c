@@ -1,7 +1,137 @@
+#define _GNU_SOURCE
+#include <lcthw/dbg.h>
 #include <lcthw/posix_ringbuffer.h>
+#include <limits.h>
+#include <linux/mempolicy.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/eventfd.h>
+#include <sys/syscall.h>
+
+/**
+ * Size of a huge page, as transparent huge pages use it. The hugetlb pool's
+ * default is the same size on the usual architectures.
+ */
+static size_t PosixRingBuffer_huge_page_size() {
+    size_t size = 0;
+    FILE *file = fopen("/sys/kernel/mm/transparent_hugepage/hpage_pmd_size", "r");
+
+    if (file) {
+        if (fscanf(file, "%zu", &size) != 1) {
+            size = 0;
+        }
+        fclose(file);
+    }
+
+    return size ? size : 2 * 1024 * 1024;
+}
+
+/**
+ * Apply the NUMA binding and huge page hint to one half of the mirror,
+ * before any of its pages are touched.
+ */
+static int PosixRingBuffer_advise(char *half, size_t size,
+                                  const PosixRingBufferOptions *options) {
+    // Only a hint, a kernel without THP rejects it with EINVAL
+    if ((options->flags & POSIX_RINGBUFFER_THP) &&
+        madvise(half, size, MADV_HUGEPAGE) != 0) {
+        log_warn("MADV_HUGEPAGE failed, using normal pages.");
+    }
+
+    if (options->flags & POSIX_RINGBUFFER_BIND) {
+        unsigned long nodes[4] = {0};
+        int bits = sizeof(nodes) * 8;
+
+        check(options->numa_node >= 0 && options->numa_node < bits,
+              "NUMA node %d out of range.", options->numa_node);
+        nodes[options->numa_node / 64] = 1UL << (options->numa_node % 64);
+
+        // mbind(2) through syscall, so there's no libnuma to link
+        check(syscall(SYS_mbind, half, size, MPOL_BIND, nodes, bits + 1,
+                      MPOL_MF_STRICT) == 0,
+              "Can't bind the ring to NUMA node %d.", options->numa_node);
+    }
+
+    return 0;
+
+error:
+    return -1;
+}
+
+/**
+ * Map `size` bytes of fresh shared memory twice, back to back. Both halves
+ * are views of the same memfd pages, so a byte written at buffer[size + i]
+ * is the byte at buffer[i]. `align` is a power of two that `size` is a
+ * multiple of.
+ */
+static char *PosixRingBuffer_map_mirror(size_t size, size_t align,
+                                        const PosixRingBufferOptions *options) {
+    static const PosixRingBufferOptions defaults = {0, -1};
+    int flags = options ? options->flags : 0;
+    size_t slack = align > (size_t)sysconf(_SC_PAGESIZE) ? align : 0;
+    char *reserved = MAP_FAILED;
+    char *buffer = NULL;
+    int fd = -1;
+
+    if (options == NULL) {
+        options = &defaults;
+    }
+
+    fd = memfd_create("lcthw-ringbuffer", MFD_CLOEXEC |
+                      (flags & POSIX_RINGBUFFER_HUGETLB ? MFD_HUGETLB : 0));
+    check(fd != -1, "memfd_create failed.");
+    check(ftruncate(fd, size) == 0, "Can't size the ring's memory.");
+
+    // Reserve room for both halves so nothing else lands in between, with
+    // slack to start them on an `align` boundary
+    reserved = mmap(NULL, size * 2 + slack, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    check(reserved != MAP_FAILED, "Can't reserve %zu bytes of address space.", size * 2);
+
+    buffer = (char *)(((uintptr_t)reserved + slack) & ~(uintptr_t)(slack ? align - 1 : 0));
+    if (buffer > reserved) {
+        munmap(reserved, buffer - reserved);
+    }
+    if (reserved + slack > buffer) {
+        munmap(buffer + size * 2, reserved + slack - buffer);
+    }
+
+    for (int i = 0; i < 2; i++) {
+        char *half = buffer + size * i;
+        check(mmap(half, size, PROT_READ | PROT_WRITE, MAP_FIXED | MAP_SHARED, fd, 0) != MAP_FAILED,
+              "Can't map the ring's memory.%s",
+              flags & POSIX_RINGBUFFER_HUGETLB ? " Are huge pages reserved?" : "");
+        check(PosixRingBuffer_advise(half, size, options) == 0,
+              "Can't apply the ring's options.");
+    }
+
+    // Populated after the binding and hints, which only apply to pages not
+    // faulted yet. Not MAP_POPULATE: on a shared mapping it faults pages in
+    // for reading and every first write still takes a fault.
+    if ((flags & POSIX_RINGBUFFER_POPULATE) &&
+        madvise(buffer, size * 2, MADV_POPULATE_WRITE) != 0) {
+        // Kernels before 5.14, touch every page instead
+        for (size_t i = 0; i < size * 2; i += sysconf(_SC_PAGESIZE)) {
+            ((volatile char *)buffer)[i] = buffer[i];
+        }
+    }
+
+    // The mappings keep the memory alive
+    close(fd);
+
+    return buffer;
+
+error:
+    if (buffer) {
+        munmap(buffer, size * 2);
+    } else if (reserved != MAP_FAILED) {
+        munmap(reserved, size * 2 + slack);
+    }
+    if (fd != -1) {
+        close(fd);
+    }
+    return NULL;
+}
 
 /**
  * Create a new PosixRingBuffer with the specified length.
@@ -13,44 +143,109 @@ PosixRingBuffer *PosixRingBuffer_create(int length) {
     // one more byte to indicate full/empty, sub 1 to align to page size
     length = ((length + 1 + page_size - 1) / page_size) * page_size;
 
-    // Allocate two consecutive memory regions
-    char *buffer = mmap(NULL, length * 2, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
-    if (buffer == MAP_FAILED) {
+    char *buffer = PosixRingBuffer_map_mirror(length, page_size, NULL);
+    if (buffer == NULL) {
         return NULL;
     }
 
-    // Map the first region as readable and writable
-    if (mmap(buffer, length, PROT_READ | PROT_WRITE, MAP_FIXED | MAP_SHARED | MAP_ANONYMOUS, -1, 0) == MAP_FAILED) {
-        munmap(buffer, length * 2);
+    // Initialize the ring buffer structure
+    PosixRingBuffer *ring = calloc(1, sizeof(PosixRingBuffer));
+    if (!ring) {
+        munmap(buffer, (size_t)length * 2);
         return NULL;
     }
 
-    // Map the second region to the same physical memory
-    if (mmap(buffer + length, length, PROT_READ | PROT_WRITE, MAP_FIXED | MAP_SHARED | MAP_ANONYMOUS, -1, 0) == MAP_FAILED) {
-        munmap(buffer, length * 2);
+    ring->buffer = buffer;
+    ring->length = length; // Includes the extra byte for alignment
+    ring->start = 0;
+    ring->end = 0;
+    ring->capacity = length;
+    ring->msg_align = POSIX_RINGBUFFER_MSG_ALIGN;
+
+    return ring;
+}
+
+/**
+ * Create a PosixRingBuffer in power-of-two mode. Page sizes are powers of
+ * two, so the capacity is a whole number of pages as the mirror needs.
+ */
+PosixRingBuffer *PosixRingBuffer_create_pow2(size_t capacity) {
+    return PosixRingBuffer_create_opts(capacity, NULL);
+}
+
+PosixRingBuffer *PosixRingBuffer_create_opts(size_t capacity,
+                                             const PosixRingBufferOptions *options) {
+    size_t size = sysconf(_SC_PAGESIZE);
+    if (options && options->flags & (POSIX_RINGBUFFER_HUGETLB | POSIX_RINGBUFFER_THP)) {
+        size = PosixRingBuffer_huge_page_size();
+    }
+    size_t align = size;
+
+    while (size < capacity) {
+        if (size > SIZE_MAX / 4) {
+            return NULL; // Both halves wouldn't fit the address space
+        }
+        size <<= 1;
+    }
+
+    char *buffer = PosixRingBuffer_map_mirror(size, align, options);
+    if (buffer == NULL) {
         return NULL;
     }
 
-    // Initialize the ring buffer structure
-    PosixRingBuffer *ring = malloc(sizeof(PosixRingBuffer));
+    PosixRingBuffer *ring = calloc(1, sizeof(PosixRingBuffer));
     if (!ring) {
-        munmap(buffer, length * 2);
+        munmap(buffer, size * 2);
         return NULL;
     }
 
     ring->buffer = buffer;
-    ring->length = length; // Includes the extra byte for alignment
-    ring->start = 0;
-    ring->end = 0;
+    ring->capacity = size;
+    ring->mask = size - 1;
+    ring->msg_align = POSIX_RINGBUFFER_MSG_ALIGN;
 
     return ring;
 }
 
+// The int API can't report more of a multi-GB ring than this.
+static inline int PosixRingBuffer_clamp(uint64_t n) {
+    return n > INT_MAX ? INT_MAX : (int)n;
+}
+
+// In power-of-two mode only the producer stores `tail` and only the
+// consumer stores `head`, each after its copy, so the two can be threads.
+static inline uint64_t PosixRingBuffer_head(PosixRingBuffer *buffer) {
+    return __atomic_load_n(&buffer->head, __ATOMIC_ACQUIRE);
+}
+
+static inline uint64_t PosixRingBuffer_tail(PosixRingBuffer *buffer) {
+    return __atomic_load_n(&buffer->tail, __ATOMIC_ACQUIRE);
+}
+
+static void PosixRingBuffer_publish_tail(PosixRingBuffer *buffer, uint64_t tail) {
+    __atomic_store_n(&buffer->tail, tail, __ATOMIC_RELEASE);
+    if (buffer->notify && WaitQueue_wake(&buffer->notify->data) &&
+        buffer->notify->event_fd != -1) {
+        eventfd_write(buffer->notify->event_fd, 1);
+    }
+}
+
+static void PosixRingBuffer_publish_head(PosixRingBuffer *buffer, uint64_t head) {
+    __atomic_store_n(&buffer->head, head, __ATOMIC_RELEASE);
+    if (buffer->notify) {
+        WaitQueue_wake(&buffer->notify->space);
+    }
+}
+
 /**
  * Check if the ring buffer is full.
  * The buffer is full when (end + 1) % length == start.
  */
  int PosixRingBuffer_full(PosixRingBuffer *buffer) {
+    if (buffer->mask) {
+        return PosixRingBuffer_tail(buffer) - PosixRingBuffer_head(buffer) ==
+               buffer->capacity;
+    }
     return (buffer->end + 1) % buffer->length == buffer->start;
 }
 
@@ -59,6 +254,9 @@ PosixRingBuffer *PosixRingBuffer_create(int length) {
  * The buffer is empty when start == end.
  */
 int PosixRingBuffer_empty(PosixRingBuffer *buffer) {
+    if (buffer->mask) {
+        return PosixRingBuffer_tail(buffer) == PosixRingBuffer_head(buffer);
+    }
     return buffer->start == buffer->end;
 }
 
@@ -67,6 +265,10 @@ int PosixRingBuffer_empty(PosixRingBuffer *buffer) {
  * The available space is the total length minus the used space minus 1.
  */
 int PosixRingBuffer_available_space(PosixRingBuffer *buffer) {
+    if (buffer->mask) {
+        return PosixRingBuffer_clamp(buffer->capacity - (PosixRingBuffer_tail(buffer) -
+                                                         PosixRingBuffer_head(buffer)));
+    }
     return (buffer->length + buffer->start - buffer->end - 1) % buffer->length;
 }
 
@@ -75,6 +277,10 @@ int PosixRingBuffer_available_space(PosixRingBuffer *buffer) {
  * The available data is the distance from end to start.
  */
 int PosixRingBuffer_available_data(PosixRingBuffer *buffer) {
+    if (buffer->mask) {
+        return PosixRingBuffer_clamp(PosixRingBuffer_tail(buffer) -
+                                     PosixRingBuffer_head(buffer));
+    }
     return (buffer->length + buffer->end - buffer->start) % buffer->length;
 }
 
@@ -91,6 +297,12 @@ int PosixRingBuffer_write(PosixRingBuffer *buffer, const char *data, int length)
     // Write data in a single memcpy operation
     // The virtual memory mapping ensures that writing past the end of the buffer
     // will automatically wrap around to the beginning
+    if (buffer->mask) {
+        memcpy(buffer->buffer + (buffer->tail & buffer->mask), data, length);
+        PosixRingBuffer_publish_tail(buffer, buffer->tail + length);
+        return length;
+    }
+
     memcpy(buffer->buffer + buffer->end, data, length);
 
     buffer->end = (buffer->end + length) % buffer->length;
@@ -111,6 +323,12 @@ int PosixRingBuffer_read(PosixRingBuffer *buffer, char *data, int length) {
     // Read data in a single memcpy operation
     // The virtual memory mapping ensures that reading past the end of the buffer
     // will automatically wrap around to the beginning
+    if (buffer->mask) {
+        memcpy(data, buffer->buffer + (buffer->head & buffer->mask), length);
+        PosixRingBuffer_publish_head(buffer, buffer->head + length);
+        return length;
+    }
+
     memcpy(data, buffer->buffer + buffer->start, length);
 
     // Update the read pointer
@@ -124,7 +342,211 @@ int PosixRingBuffer_read(PosixRingBuffer *buffer, char *data, int length) {
  */
 void PosixRingBuffer_destroy(PosixRingBuffer *buffer) {
     if (buffer) {
-        munmap(buffer->buffer, buffer->length * 2);
+        if (buffer->notify) {
+            if (buffer->notify->event_fd != -1) {
+                close(buffer->notify->event_fd);
+            }
+            free(buffer->notify);
+        }
+        munmap(buffer->buffer, buffer->capacity * 2);
         free(buffer);
     }
-}
\ No newline at end of file
+}
+
+// ---- messages. They work on byte counts in either mode: a record starts
+// at the read offset and whole records keep it `msg_align` aligned, since
+// the page multiple the offsets wrap at is too.
+
+static inline uint64_t PosixRingBuffer_data_bytes(PosixRingBuffer *buffer) {
+    if (buffer->mask) {
+        return PosixRingBuffer_tail(buffer) - PosixRingBuffer_head(buffer);
+    }
+    return (buffer->length + buffer->end - buffer->start) % buffer->length;
+}
+
+static inline uint64_t PosixRingBuffer_space_bytes(PosixRingBuffer *buffer) {
+    if (buffer->mask) {
+        return buffer->capacity -
+               (PosixRingBuffer_tail(buffer) - PosixRingBuffer_head(buffer));
+    }
+    return (buffer->length + buffer->start - buffer->end - 1) % buffer->length;
+}
+
+// Where the byte `skip` past the read offset is. Below `capacity`, the
+// mirror makes everything up to another `capacity` after it contiguous.
+static inline char *PosixRingBuffer_read_at(PosixRingBuffer *buffer, uint64_t skip) {
+    if (buffer->mask) {
+        return buffer->buffer + ((buffer->head + skip) & buffer->mask);
+    }
+    return buffer->buffer + (buffer->start + skip) % buffer->length;
+}
+
+static inline uint64_t PosixRingBuffer_msg_size(PosixRingBuffer *buffer,
+                                                uint64_t length) {
+    uint64_t align = buffer->msg_align;
+    return align + ((length + align - 1) & ~(align - 1));
+}
+
+int PosixRingBuffer_set_msg_align(PosixRingBuffer *buffer, size_t align) {
+    check(align >= sizeof(uint32_t) && (align & (align - 1)) == 0 &&
+              align <= (size_t)sysconf(_SC_PAGESIZE),
+          "Message alignment %zu isn't a power of two from 4 to a page.", align);
+    check(PosixRingBuffer_empty(buffer), "Can't realign a ring holding data.");
+
+    // an empty ring can start over, so leftover byte writes don't matter
+    buffer->head = buffer->tail = 0;
+    buffer->start = buffer->end = 0;
+    buffer->msg_align = align;
+    return 0;
+
+error:
+    return -1;
+}
+
+int PosixRingBuffer_write_msg(PosixRingBuffer *buffer, const void *data,
+                              uint32_t length) {
+    uint64_t size = PosixRingBuffer_msg_size(buffer, length);
+    if (size > PosixRingBuffer_space_bytes(buffer)) {
+        return -1;
+    }
+
+    // the padding isn't cleared, nothing reads it
+    char *record = buffer->buffer + (buffer->mask ? (buffer->tail & buffer->mask)
+                                                  : (uint64_t)buffer->end);
+    *(uint32_t *)record = length;
+    // an empty message may come with a NULL `data`
+    if (length > 0) {
+        memcpy(record + buffer->msg_align, data, length);
+    }
+
+    if (buffer->mask) {
+        PosixRingBuffer_publish_tail(buffer, buffer->tail + size);
+    } else {
+        buffer->end = (buffer->end + size) % buffer->length;
+    }
+    return 0;
+}
+
+int PosixRingBuffer_read_msgs(PosixRingBuffer *buffer, PosixRingBufferMsg *msgs,
+                              int max) {
+    uint64_t data = PosixRingBuffer_data_bytes(buffer);
+    uint64_t used = 0;
+    int count = 0;
+
+    while (count < max && used < data) {
+        const char *record = PosixRingBuffer_read_at(buffer, used);
+        uint32_t length = *(const uint32_t *)record;
+
+        used += PosixRingBuffer_msg_size(buffer, length);
+        check(used <= data, "Message of %u bytes runs past the data, was the "
+              "ring written without framing?", length);
+
+        msgs[count].data = record + buffer->msg_align;
+        msgs[count].length = length;
+        count++;
+    }
+
+    return count;
+
+error:
+    return count;
+}
+
+int PosixRingBuffer_release_msgs(PosixRingBuffer *buffer, int count) {
+    uint64_t data = PosixRingBuffer_data_bytes(buffer);
+    uint64_t used = 0;
+
+    for (int i = 0; i < count; i++) {
+        check(used < data, "Only %d messages to release, not %d.", i, count);
+        used += PosixRingBuffer_msg_size(
+            buffer, *(const uint32_t *)PosixRingBuffer_read_at(buffer, used));
+    }
+    check(used <= data, "Last message runs past the data.");
+
+    if (buffer->mask) {
+        PosixRingBuffer_publish_head(buffer, buffer->head + used);
+    } else {
+        buffer->start = (buffer->start + used) % buffer->length;
+    }
+    return count;
+
+error:
+    return -1;
+}
+
+// ---- wait/notify
+
+int PosixRingBuffer_enable_notify(PosixRingBuffer *buffer) {
+    check(buffer->mask, "Only power-of-two rings can notify.");
+    if (buffer->notify) {
+        return 0;
+    }
+
+    PosixRingBufferNotify *notify = NULL;
+    check(posix_memalign((void **)&notify, 64, sizeof(*notify)) == 0,
+          "Out of memory.");
+    WaitQueue_init(&notify->data, 0);
+    WaitQueue_init(&notify->space, 0);
+    notify->event_fd = -1;
+
+    buffer->notify = notify;
+    return 0;
+
+error:
+    return -1;
+}
+
+// WaitQueue_count adapters.
+static int PosixRingBuffer_data_count(void *buffer) {
+    return PosixRingBuffer_available_data(buffer);
+}
+
+static int PosixRingBuffer_space_count(void *buffer) {
+    return PosixRingBuffer_available_space(buffer);
+}
+
+int PosixRingBuffer_wait_data(PosixRingBuffer *buffer, int amount,
+                              int timeout_ms) {
+    check(buffer->notify, "Notify isn't enabled.");
+    check(amount > 0 && (size_t)amount <= buffer->capacity,
+          "Can't wait for %d bytes of a %zu byte ring.", amount, buffer->capacity);
+    return WaitQueue_wait(&buffer->notify->data, PosixRingBuffer_data_count,
+                          buffer, amount, timeout_ms);
+
+error:
+    return -1;
+}
+
+int PosixRingBuffer_wait_space(PosixRingBuffer *buffer, int amount,
+                               int timeout_ms) {
+    check(buffer->notify, "Notify isn't enabled.");
+    check(amount > 0 && (size_t)amount <= buffer->capacity,
+          "Can't wait for %d bytes of a %zu byte ring.", amount, buffer->capacity);
+    return WaitQueue_wait(&buffer->notify->space, PosixRingBuffer_space_count,
+                          buffer, amount, timeout_ms);
+
+error:
+    return -1;
+}
+
+int PosixRingBuffer_eventfd(PosixRingBuffer *buffer) {
+    check(PosixRingBuffer_enable_notify(buffer) == 0, "Can't notify.");
+
+    if (buffer->notify->event_fd == -1) {
+        buffer->notify->event_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        check(buffer->notify->event_fd != -1, "eventfd failed.");
+    }
+    return buffer->notify->event_fd;
+
+error:
+    return -1;
+}
+
+int PosixRingBuffer_arm(PosixRingBuffer *buffer, int amount) {
+    check(buffer->notify, "Notify isn't enabled.");
+    return WaitQueue_arm(&buffer->notify->data, PosixRingBuffer_data_count,
+                         buffer, amount);
+
+error:
+    return -1;
+}
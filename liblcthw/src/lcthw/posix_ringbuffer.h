@@ -2,22 +2,190 @@
 #define _lcthw_POSIX_RingBuffer_h
 
 
+#include <lcthw/waitq.h>
+#include <stddef.h>
+#include <stdint.h>
 #include <sys/mman.h>
 #include <unistd.h>
 
 /**
  * POSIX RingBuffer structure
  * - Uses mmap to create a virtually infinite memory-mapped region.
+ * - The same pages are mapped twice, back to back, so a read or write that
+ *   runs off the end carries on at the start with a single memcpy.
+ *
+ * In power-of-two mode (PosixRingBuffer_create_pow2) `length`, `start` and
+ * `end` are unused. `head` and `tail` count every byte ever read and
+ * written instead: `tail - head` is the data held and `& mask` turns a
+ * count into an offset, so no operation divides, the whole capacity is
+ * usable and it isn't limited to an int. It's also safe for one producer
+ * thread and one consumer thread, and can block either of them until the
+ * other catches up (PosixRingBuffer_enable_notify).
  */
+
+/**
+ * Optional wait/notify state of a power-of-two ring, see
+ * PosixRingBuffer_enable_notify.
+ */
+typedef struct PosixRingBufferNotify {
+    _Alignas(64) WaitQueue data;  // The consumer sleeps here.
+    _Alignas(64) WaitQueue space; // The producer sleeps here.
+    int event_fd; // Signalled along with `data`, -1 until asked for.
+} PosixRingBufferNotify;
+
 typedef struct {
     char *buffer;  // Pointer to the memory-mapped buffer
     int length; // Total capacity of the buffer
     int start;  // Read pointer
     int end;    // Write pointer
+    size_t capacity; // Bytes mapped (twice), in either mode
+    uint64_t mask;   // capacity - 1 in power-of-two mode, 0 otherwise
+    uint64_t head;   // Bytes read so far, power-of-two mode
+    uint64_t tail;   // Bytes written so far, power-of-two mode
+    size_t msg_align; // Record alignment of the message API
+    PosixRingBufferNotify *notify; // NULL unless enabled
 } PosixRingBuffer;
 
+// PosixRingBufferOptions.flags
+#define POSIX_RINGBUFFER_HUGETLB 0x1  // Pages from the hugetlb pool (MFD_HUGETLB)
+#define POSIX_RINGBUFFER_THP 0x2      // Ask for transparent huge pages
+#define POSIX_RINGBUFFER_POPULATE 0x4 // Fault every page in at creation
+#define POSIX_RINGBUFFER_BIND 0x8     // Bind the pages to `numa_node`
+
+/**
+ * How PosixRingBuffer_create_opts backs a ring.
+ * - HUGETLB needs pages reserved up front (vm.nr_hugepages), creation
+ *   fails when there aren't enough.
+ * - THP is a hint, it takes effect for shared memory only when
+ *   /sys/kernel/mm/transparent_hugepage/shmem_enabled allows it. A kernel
+ *   that refuses it logs a warning and the ring uses normal pages.
+ * - BIND places the pages with mbind(MPOL_BIND) before anything touches
+ *   them, POPULATE then faults them all in so the hot path never does.
+ */
+typedef struct {
+    int flags;
+    int numa_node; // Used with POSIX_RINGBUFFER_BIND
+} PosixRingBufferOptions;
+
 PosixRingBuffer *PosixRingBuffer_create(int length);
+
+/**
+ * Creates a ring in power-of-two mode holding `capacity` bytes, rounded up
+ * to a power of two of at least a page. The counts reported through the
+ * int functions stop at INT_MAX, `tail - head` is exact.
+ */
+PosixRingBuffer *PosixRingBuffer_create_pow2(size_t capacity);
+
+/**
+ * PosixRingBuffer_create_pow2 with control over the pages behind the ring,
+ * `options` may be NULL. With huge pages the capacity is at least one huge
+ * page, so both halves of the mirror start on a huge page boundary.
+ */
+PosixRingBuffer *PosixRingBuffer_create_opts(size_t capacity,
+                                             const PosixRingBufferOptions *options);
+
 void PosixRingBuffer_destroy(PosixRingBuffer *buffer);
+
+/**
+ * Lets the consumer of a power-of-two ring wait for data and the producer
+ * wait for space, instead of polling. Every write and read then costs a
+ * memory fence, and a system call only when the other side sleeps.
+ *
+ * @return 0, or -1 for a classic mode ring or out of memory.
+ */
+int PosixRingBuffer_enable_notify(PosixRingBuffer *buffer);
+
+/**
+ * Consumer side: spins briefly, then sleeps until at least `amount` bytes
+ * can be read, for at most `timeout_ms` (negative waits forever). Needs
+ * PosixRingBuffer_enable_notify.
+ *
+ * @return the bytes available, -1 on timeout or error.
+ */
+int PosixRingBuffer_wait_data(PosixRingBuffer *buffer, int amount,
+                              int timeout_ms);
+
+/**
+ * Producer side: as PosixRingBuffer_wait_data, for `amount` bytes of space.
+ */
+int PosixRingBuffer_wait_space(PosixRingBuffer *buffer, int amount,
+                               int timeout_ms);
+
+/**
+ * An eventfd that becomes readable when data arrives, for epoll and other
+ * event loops. It's only signalled for an armed ring, so the producer makes
+ * no system call while the consumer is busy:
+ *
+ *     while (PosixRingBuffer_arm(ring, 1) < 1) {
+ *         epoll_wait(...);             // the eventfd is in the set
+ *         read(event_fd, &count, 8);   // reset it
+ *     }
+ *     // read the ring
+ *
+ * @return the fd, owned by the ring, or -1.
+ */
+int PosixRingBuffer_eventfd(PosixRingBuffer *buffer);
+
+/**
+ * Consumer side: makes the next write signal the eventfd, unless `amount`
+ * bytes are there already.
+ *
+ * @return the bytes available.
+ */
+int PosixRingBuffer_arm(PosixRingBuffer *buffer, int amount);
+
+// Default PosixRingBuffer.msg_align, enough for any scalar field.
+#define POSIX_RINGBUFFER_MSG_ALIGN 8
+
+/**
+ * A message still in the ring: `data` points into the mapping, so it is
+ * contiguous even when the record wraps, and stays valid until the message
+ * is released.
+ */
+typedef struct {
+    const char *data;
+    uint32_t length;
+} PosixRingBufferMsg;
+
+/**
+ * Sets the alignment of message records, a power of two from 4 up to a
+ * page. Each record is a uint32_t length, padded to `align`, then the
+ * payload padded to `align`, so every payload starts `align` aligned and
+ * can be read in place as a struct. Both sides must agree on it, and the
+ * ring must be empty; it starts over at offset 0.
+ *
+ * @return 0, or -1 if `align` is invalid or the ring holds data.
+ */
+int PosixRingBuffer_set_msg_align(PosixRingBuffer *buffer, size_t align);
+
+/**
+ * Appends one message. Messages are never split: it goes in whole or not
+ * at all. Don't mix with PosixRingBuffer_write on the same ring.
+ *
+ * @return 0, or -1 if there isn't room for it (not logged, a full ring is
+ * normal).
+ */
+int PosixRingBuffer_write_msg(PosixRingBuffer *buffer, const void *data,
+                              uint32_t length);
+
+/**
+ * Views up to `max` messages, oldest first, without copying or consuming
+ * them. Call PosixRingBuffer_release_msgs once they're handled.
+ *
+ * @return the number of messages in `msgs`.
+ */
+int PosixRingBuffer_read_msgs(PosixRingBuffer *buffer, PosixRingBufferMsg *msgs,
+                              int max);
+
+/**
+ * Consumes the oldest `count` messages, invalidating their views.
+ *
+ * @return `count`, or -1 if the ring holds fewer.
+ */
+int PosixRingBuffer_release_msgs(PosixRingBuffer *buffer, int count);
+
+#define PosixRingBuffer_read_msg(B, M) PosixRingBuffer_read_msgs((B), (M), 1)
+#define PosixRingBuffer_release_msg(B) PosixRingBuffer_release_msgs((B), 1)
 int PosixRingBuffer_write(PosixRingBuffer *buffer, const char *data, int length);
 int PosixRingBuffer_read(PosixRingBuffer *buffer, char *target, int amount);
 int PosixRingBuffer_empty(PosixRingBuffer *buffer);
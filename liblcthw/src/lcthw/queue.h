@@ -26,6 +26,21 @@ static inline void Queue_send(Queue *queue, void *value) {
  */
 static inline void *Queue_recv(Queue *queue) { return List_shift(queue->list); }
 
+/**
+ * Sends `n` values, in order, with one node allocation.
+ */
+static inline int Queue_send_n(Queue *queue, void **values, int n) {
+  return List_push_n(queue->list, values, n);
+}
+
+/**
+ * Receives up to `n` values from the front into `values` and returns how many
+ * were received.
+ */
+static inline int Queue_recv_n(Queue *queue, void **values, int n) {
+  return List_shift_n(queue->list, values, n);
+}
+
 static inline void *Queue_peek(Queue *queue) { return List_first(queue->list); }
 
 static inline int Queue_count(Queue *queue) { return List_count(queue->list); }
@@ -28,6 +28,40 @@ error:
   return NULL;
 }
 
+RingBuffer *RingBuffer_create_pow2(size_t capacity) {
+  RingBuffer *buffer = NULL;
+  size_t size = 2;
+
+  while (size < capacity) {
+    check(size <= SIZE_MAX / 2, "Capacity %zu is too big.", capacity);
+    size <<= 1;
+  }
+
+  buffer = calloc(1, sizeof(RingBuffer));
+  check_mem(buffer);
+
+  buffer->buffer = malloc(size);
+  check_mem(buffer->buffer);
+  buffer->mask = size - 1;
+
+  return buffer;
+
+error:
+  free(buffer);
+  return NULL;
+}
+
+RingBuffer *RingBuffer_create_recorder(size_t capacity) {
+  RingBuffer *buffer = RingBuffer_create_pow2(capacity);
+  check(buffer != NULL, "Failed to create the recorder.");
+
+  buffer->overwrite = 1;
+  return buffer;
+
+error:
+  return NULL;
+}
+
 void RingBuffer_destroy(RingBuffer *buffer) {
   if (buffer) {
     free(buffer->buffer);
@@ -35,11 +69,44 @@ void RingBuffer_destroy(RingBuffer *buffer) {
   }
 }
 
+// Copies `length` bytes in or out at counter `at`, in two pieces when they
+// run off the end of the buffer.
+static void RingBuffer_pow2_copy_in(RingBuffer *buffer, uint64_t at,
+                                    const char *data, size_t length) {
+  size_t offset = at & buffer->mask;
+  size_t first = buffer->mask + 1 - offset;
+
+  if (first > length)
+    first = length;
+  memcpy(buffer->buffer + offset, data, first);
+  memcpy(buffer->buffer, data + first, length - first);
+}
+
+static void RingBuffer_pow2_copy_out(RingBuffer *buffer, uint64_t at,
+                                     char *target, size_t length) {
+  size_t offset = at & buffer->mask;
+  size_t first = buffer->mask + 1 - offset;
+
+  if (first > length)
+    first = length;
+  memcpy(target, buffer->buffer + offset, first);
+  memcpy(target + first, buffer->buffer, length - first);
+}
+
 int RingBuffer_write(RingBuffer *buffer, char *data, int length) {
   check(buffer != NULL, "Buffer is NULL.");
   check(data != NULL, "Data is NULL.");
   check(length > 0, "Length must be greater than 0.");
 
+  if (buffer->mask) {
+    check(length <= RingBuffer_available_space(buffer),
+          "Not enough space: %d request, %d available", length,
+          RingBuffer_available_space(buffer));
+    RingBuffer_pow2_copy_in(buffer, buffer->tail, data, length);
+    buffer->tail += length;
+    return length;
+  }
+
   if (RingBuffer_available_data(buffer) == 0) {
     // overflow detected, reset the buffer
     buffer->start = buffer->end = 0;
@@ -68,6 +135,12 @@ int RingBuffer_read(RingBuffer *buffer, char *target, int amount) {
               "Not enough in the buffer: has %d, needs %d",
               RingBuffer_available_data(buffer), amount);
 
+  if (buffer->mask) {
+    RingBuffer_pow2_copy_out(buffer, buffer->head, target, amount);
+    buffer->head += amount;
+    return amount;
+  }
+
   void *result = memcpy(target, RingBuffer_starts_at(buffer), amount);
   check(result != NULL, "Failed to write buffer into data.");
 
@@ -88,6 +161,18 @@ bstring RingBuffer_gets(RingBuffer *buffer, int amount) {
   check_debug(amount <= RingBuffer_available_data(buffer),
               "Not enough in the buffer.");
 
+  if (buffer->mask) {
+    bstring result = bfromcstralloc(amount + 1, "");
+    check_mem(result);
+
+    RingBuffer_pow2_copy_out(buffer, buffer->head, (char *)result->data,
+                             amount);
+    result->slen = amount;
+    result->data[amount] = '\0';
+    buffer->head += amount;
+    return result;
+  }
+
   bstring result = blk2bstr(RingBuffer_starts_at(buffer), amount);
   check(result != NULL, "Failed to create gets result.");
   check(blength(result) == amount, "Wrong result length.");
@@ -99,3 +184,109 @@ bstring RingBuffer_gets(RingBuffer *buffer, int amount) {
 error:
   return NULL;
 }
+
+// ---- recorder mode, records are a uint32_t length and the payload, both
+// free to wrap
+
+static uint32_t RingBuffer_record_length(RingBuffer *buffer, uint64_t at) {
+  uint32_t length = 0;
+  RingBuffer_pow2_copy_out(buffer, at, (char *)&length, sizeof(length));
+  return length;
+}
+
+int RingBuffer_record(RingBuffer *buffer, const char *data, int length) {
+  check(buffer != NULL && buffer->overwrite, "Not a recorder.");
+  check(length >= 0 && (uint64_t)length + sizeof(uint32_t) <= buffer->mask + 1,
+        "Record of %d bytes can't fit a %llu byte recorder.", length,
+        (unsigned long long)buffer->mask + 1);
+
+  uint64_t size = sizeof(uint32_t) + length;
+  uint64_t capacity = buffer->mask + 1;
+
+  while (capacity - (buffer->tail - buffer->head) < size) {
+    uint32_t old = RingBuffer_record_length(buffer, buffer->head);
+    buffer->head += sizeof(uint32_t) + old;
+    buffer->dropped += old;
+  }
+
+  uint32_t header = length;
+  RingBuffer_pow2_copy_in(buffer, buffer->tail, (const char *)&header,
+                          sizeof(header));
+  // an empty record may come with a NULL `data`
+  if (length > 0) {
+    RingBuffer_pow2_copy_in(buffer, buffer->tail + sizeof(header), data,
+                            length);
+  }
+  buffer->tail += size;
+
+  return length;
+error:
+  return -1;
+}
+
+int RingBuffer_read_record(RingBuffer *buffer, char *target, int amount) {
+  check(buffer != NULL && buffer->overwrite, "Not a recorder.");
+
+  if (buffer->tail == buffer->head) {
+    return RINGBUFFER_NO_RECORD;
+  }
+
+  uint32_t length = RingBuffer_record_length(buffer, buffer->head);
+  check_debug(length <= (uint32_t)amount,
+              "Record of %u bytes doesn't fit %d.", length, amount);
+
+  RingBuffer_pow2_copy_out(buffer, buffer->head + sizeof(length), target,
+                           length);
+  buffer->head += sizeof(length) + length;
+
+  return length;
+error:
+  return -1;
+}
+
+char *RingBuffer_snapshot_copy(RingBuffer *buffer, size_t *size) {
+  char *copy = NULL;
+
+  check(buffer != NULL && buffer->overwrite, "Not a recorder.");
+
+  *size = buffer->tail - buffer->head;
+  copy = malloc(*size + 1);
+  check_mem(copy);
+  RingBuffer_pow2_copy_out(buffer, buffer->head, copy, *size);
+
+  return copy;
+
+error:
+  return NULL;
+}
+
+int RingBuffer_snapshot_save(const char *path, const char *snapshot,
+                             size_t size) {
+  FILE *file = fopen(path, "wb");
+  check(file != NULL, "Can't open %s.", path);
+  check(fwrite(snapshot, 1, size, file) == size, "Failed to write %s.", path);
+  int closed = fclose(file);
+  file = NULL;
+  check(closed == 0, "Failed to close %s.", path);
+
+  return 0;
+
+error:
+  if (file) {
+    fclose(file);
+  }
+  return -1;
+}
+
+int RingBuffer_snapshot(RingBuffer *buffer, const char *path) {
+  size_t size = 0;
+  char *copy = RingBuffer_snapshot_copy(buffer, &size);
+  check(copy != NULL, "Failed to copy the recorder.");
+
+  int rc = RingBuffer_snapshot_save(path, copy, size);
+  free(copy);
+  return rc;
+
+error:
+  return -1;
+}
@@ -2,6 +2,13 @@
 #define _lcthw_RingBuffer_h
 
 #include <lcthw/bstrlib.h>
+#include <limits.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
 
 // clang-format off
 
@@ -12,19 +19,97 @@
 *   by the difference between `start` and `end`, adjusted for wrapping.
 * - The buffer is considered full when the number of stored elements equals `length - 1`.
 * - The buffer is considered empty when `start` equals `end`.
+*
+* In power-of-two mode (RingBuffer_create_pow2) `length`, `start` and `end`
+* are unused: `head` and `tail` count every byte ever read and written, so
+* `tail - head` is the data held and `& mask` an offset. Nothing divides, all
+* of the capacity is usable and it can pass 2 GB. Reads and writes that run
+* off the end are split in two copies.
+*
+* A recorder (RingBuffer_create_recorder) is a power-of-two buffer of
+* records that never refuses one: RingBuffer_record drops the oldest
+* records to make room and counts their bytes in `dropped`.
 */
 typedef struct {
     char *buffer;  // Pointer to the memory allocated for the buffer's data.
     int length;    // The total capacity of the buffer (maximum number of elements it can hold).
     int start;     // The index of the first readable element in the buffer.
     int end;       // The index where the next writable element will be placed.
+    uint64_t mask; // Capacity - 1 in power-of-two mode, 0 otherwise.
+    uint64_t head; // Bytes read so far, power-of-two mode.
+    uint64_t tail; // Bytes written so far, power-of-two mode.
+    uint64_t dropped; // Payload bytes of records overwritten, recorder mode.
+    int overwrite;    // Recorder mode.
 } RingBuffer;
 // clang-format on
 
 RingBuffer *RingBuffer_create(int length);
 
+/**
+ * Creates a buffer in power-of-two mode holding `capacity` bytes, rounded up
+ * to a power of two (at least 2). Counts reported as int stop at INT_MAX.
+ */
+RingBuffer *RingBuffer_create_pow2(size_t capacity);
+
+/**
+ * Creates a flight recorder: a power-of-two mode buffer of `capacity` bytes
+ * that keeps the most recent records and overwrites the oldest. Each record
+ * costs 4 bytes of length on top of its payload. Use only the record
+ * functions on it.
+ */
+RingBuffer *RingBuffer_create_recorder(size_t capacity);
+
 void RingBuffer_destroy(RingBuffer *buffer);
 
+/**
+ * Appends a record to a recorder, first dropping as many of the oldest
+ * records as it takes to fit. Never waits and never fails for space, each
+ * record is dropped at most once, so it's O(1) amortized.
+ *
+ * @return `length`, or -1 if the record could never fit.
+ */
+int RingBuffer_record(RingBuffer *buffer, const char *data, int length);
+
+// RingBuffer_read_record's result when the recorder holds no records,
+// apart from 0, the length of an empty record.
+#define RINGBUFFER_NO_RECORD -2
+
+/**
+ * Removes the oldest record of a recorder into `target`. Drain with
+ * `while ((n = RingBuffer_read_record(...)) >= 0)`, empty records included.
+ *
+ * @return its length, RINGBUFFER_NO_RECORD if there are none, -1 if it is
+ * longer than `amount` (it stays in the buffer).
+ */
+int RingBuffer_read_record(RingBuffer *buffer, char *target, int amount);
+
+/**
+ * Copies the records a recorder holds, oldest first and framed as they are
+ * stored: a native endian uint32_t length then the payload. The recorder is
+ * left as it was. Only memory is touched, so a caller that locks around the
+ * recorder can take the copy under the lock and write it out after.
+ *
+ * @return the malloc'd copy, its byte count in `size`, NULL on error.
+ */
+char *RingBuffer_snapshot_copy(RingBuffer *buffer, size_t *size);
+
+/**
+ * Writes a RingBuffer_snapshot_copy to the file at `path`.
+ *
+ * @return 0, or -1 on error.
+ */
+int RingBuffer_snapshot_save(const char *path, const char *snapshot,
+                             size_t size);
+
+/**
+ * RingBuffer_snapshot_copy then RingBuffer_snapshot_save in one call. It
+ * does the file I/O before returning, don't hold a lock the writer needs
+ * around it.
+ *
+ * @return 0, or -1 on error.
+ */
+int RingBuffer_snapshot(RingBuffer *buffer, const char *path);
+
 int RingBuffer_read(RingBuffer *buffer, char *target, int amount);
 
 int RingBuffer_write(RingBuffer *buffer, char *data, int length);
@@ -39,28 +124,55 @@ int RingBuffer_available_space(RingBuffer *buffer);
 
 bstring RingBuffer_gets(RingBuffer *buffer, int amount);
 
+// Bytes held by a power-of-two mode buffer, clamped for the int API.
+static inline int RingBuffer_pow2_data(const RingBuffer *buffer) {
+  uint64_t n = buffer->tail - buffer->head;
+  return n > INT_MAX ? INT_MAX : (int)n;
+}
+
+static inline int RingBuffer_pow2_space(const RingBuffer *buffer) {
+  uint64_t n = buffer->mask + 1 - (buffer->tail - buffer->head);
+  return n > INT_MAX ? INT_MAX : (int)n;
+}
+
 #define RingBuffer_available_data(B)                                           \
-  ((((B)->end + 1) % (B)->length) - ((B)->start) - 1)
+  ((B)->mask ? RingBuffer_pow2_data((B))                                       \
+             : ((((B)->end + 1) % (B)->length) - ((B)->start) - 1))
+
+#define RingBuffer_available_space(B)                                          \
+  ((B)->mask ? RingBuffer_pow2_space((B)) : ((B)->length - (B)->end - 1))
 
-#define RingBuffer_available_space(B) ((B)->length - (B)->end - 1)
+#define RingBuffer_full(B)                                                     \
+  ((B)->mask ? (B)->tail - (B)->head == (B)->mask + 1                          \
+             : RingBuffer_available_data((B)) - (B)->length == 0)
 
-#define RingBuffer_full(B) (RingBuffer_available_data((B)) - (B)->length == 0)
+#define RingBuffer_empty(B)                                                    \
+  ((B)->mask ? (B)->tail == (B)->head : RingBuffer_available_data((B)) == 0)
 
-#define RingBuffer_empty(B) (RingBuffer_available_data((B)) == 0)
+#define RingBuffer_dropped(B) ((B)->dropped)
 
 #define RingBuffer_puts(B, D) RingBuffer_write((B), bdata((D)), blength((D)))
 
 #define RingBuffer_get_all(B)                                                  \
   RingBuffer_gets((B), RingBuffer_available_data((B)))
 
-#define RingBuffer_starts_at(B) ((B)->buffer + (B)->start)
+// In power-of-two mode these are contiguous only up to the end of `buffer`.
+#define RingBuffer_starts_at(B)                                                \
+  ((B)->buffer + ((B)->mask ? ((B)->head & (B)->mask) : (uint64_t)(B)->start))
 
-#define RingBuffer_ends_at(B) ((B)->buffer + (B)->end)
+#define RingBuffer_ends_at(B)                                                  \
+  ((B)->buffer + ((B)->mask ? ((B)->tail & (B)->mask) : (uint64_t)(B)->end))
 
 #define RingBuffer_commit_read(B, A)                                           \
-  ((B)->start = (((B)->start + (A)) % (B)->length))
+  ((B)->mask ? (void)((B)->head += (A))                                        \
+             : (void)((B)->start = (((B)->start + (A)) % (B)->length)))
 
 #define RingBuffer_commit_write(B, A)                                          \
-  ((B)->end = (((B)->end + (A)) % (B)->length))
+  ((B)->mask ? (void)((B)->tail += (A))                                        \
+             : (void)((B)->end = (((B)->end + (A)) % (B)->length)))
+
+#ifdef __cplusplus
+}
+#endif
 
 #endif
@@ -0,0 +1,82 @@
+#ifndef lcthw_RingBuffer_hpp
+#define lcthw_RingBuffer_hpp
+
+#include <lcthw/bstring.hpp>
+#include <lcthw/ringbuffer.h>
+#include <new>
+#include <optional>
+#include <string_view>
+#include <utility>
+
+namespace lcthw {
+
+/**
+ * Owning C++ handle on a RingBuffer of bytes. Moves, doesn't copy.
+ */
+class RingBuffer {
+public:
+  explicit RingBuffer(int length) : buffer_(RingBuffer_create(length)) {
+    if (buffer_ == nullptr) {
+      throw std::bad_alloc();
+    }
+  }
+
+  RingBuffer(RingBuffer &&other) noexcept
+      : buffer_(std::exchange(other.buffer_, nullptr)) {}
+
+  RingBuffer &operator=(RingBuffer &&other) noexcept {
+    std::swap(buffer_, other.buffer_);
+    return *this;
+  }
+
+  RingBuffer(const RingBuffer &) = delete;
+  RingBuffer &operator=(const RingBuffer &) = delete;
+
+  ~RingBuffer() { RingBuffer_destroy(buffer_); }
+
+  /**
+   * Copies `data` in, returns its length or -1 if it doesn't fit.
+   */
+  int write(std::string_view data) {
+    return RingBuffer_write(buffer_, const_cast<char *>(data.data()),
+                            static_cast<int>(data.size()));
+  }
+
+  /**
+   * Copies `amount` bytes out, returns `amount` or -1 if there aren't that
+   * many.
+   */
+  int read(char *target, int amount) {
+    return RingBuffer_read(buffer_, target, amount);
+  }
+
+  /**
+   * The next `amount` bytes as a BString, nothing if there aren't that many.
+   */
+  std::optional<BString> gets(int amount) {
+    bstring b = RingBuffer_gets(buffer_, amount);
+    if (b == nullptr) {
+      return std::nullopt;
+    }
+    return BString::adopt(b);
+  }
+
+  int size() const { return RingBuffer_available_data(buffer_); }
+  int space() const { return RingBuffer_available_space(buffer_); }
+  bool empty() const { return RingBuffer_empty(buffer_); }
+  bool full() const { return RingBuffer_full(buffer_); }
+
+  /**
+   * The underlying RingBuffer, still owned by this object.
+   */
+  ::RingBuffer *get() const { return buffer_; }
+
+  ::RingBuffer *release() { return std::exchange(buffer_, nullptr); }
+
+private:
+  ::RingBuffer *buffer_;
+};
+
+} // namespace lcthw
+
+#endif
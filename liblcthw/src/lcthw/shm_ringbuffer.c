@@ -0,0 +1,283 @@
+#define _GNU_SOURCE
+#include <fcntl.h>
+#include <inttypes.h>
+#include <lcthw/dbg.h>
+#include <lcthw/shm_ringbuffer.h>
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static size_t ShmRingBuffer_page_size() { return sysconf(_SC_PAGESIZE); }
+
+// Maps the header and the first copy of the data in one go, then the data
+// again right after it.
+static int ShmRingBuffer_map(ShmRingBuffer *ring, size_t capacity) {
+  size_t page = ShmRingBuffer_page_size();
+  char *base = mmap(NULL, page + capacity * 2, PROT_NONE,
+                    MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  check(base != MAP_FAILED, "Can't reserve address space for the ring.");
+
+  check(mmap(base, page + capacity, PROT_READ | PROT_WRITE,
+             MAP_FIXED | MAP_SHARED, ring->fd, 0) != MAP_FAILED,
+        "Can't map the ring.");
+  check(mmap(base + page + capacity, capacity, PROT_READ | PROT_WRITE,
+             MAP_FIXED | MAP_SHARED, ring->fd, page) != MAP_FAILED,
+        "Can't map the ring's mirror.");
+
+  ring->header = (ShmRingHeader *)base;
+  ring->buffer = base + page;
+  ring->capacity = capacity;
+  ring->mask = capacity - 1;
+  return 0;
+
+error:
+  if (base != MAP_FAILED) {
+    munmap(base, page + capacity * 2);
+  }
+  return -1;
+}
+
+ShmRingBuffer *ShmRingBuffer_create(const char *name, size_t capacity) {
+  size_t page = ShmRingBuffer_page_size();
+  size_t size = page;
+  ShmRingBuffer *ring = calloc(1, sizeof(ShmRingBuffer));
+  check_mem(ring);
+  ring->fd = -1;
+
+  while (size < capacity) {
+    check(size <= SIZE_MAX / 4, "Capacity %zu is too big.", capacity);
+    size <<= 1;
+  }
+
+  if (name != NULL) {
+    // copied first, nothing can fail between creating the object and
+    // owning its unlink
+    size_t len = strlen(name) + 1;
+    char *copy = malloc(len);
+    check_mem(copy);
+    memcpy(copy, name, len);
+
+    ring->fd = shm_open(name, O_CREAT | O_EXCL | O_RDWR, 0600);
+    if (ring->fd == -1) {
+      free(copy);
+    }
+    check(ring->fd != -1, "Can't create shared memory %s.", name);
+    // from here on destroy unlinks it
+    ring->name = copy;
+  } else {
+    ring->fd = memfd_create("lcthw-shm-ringbuffer", MFD_CLOEXEC);
+    check(ring->fd != -1, "memfd_create failed.");
+  }
+
+  check(ftruncate(ring->fd, page + size) == 0,
+        "Can't size the shared memory.");
+  check(ShmRingBuffer_map(ring, size) == 0, "Can't map the new ring.");
+
+  ring->header->version = SHM_RINGBUFFER_VERSION;
+  ring->header->capacity = size;
+  WaitQueue_init(&ring->header->data, 1);
+  WaitQueue_init(&ring->header->space, 1);
+  // last, attaching processes check it before trusting the rest
+  __atomic_store_n(&ring->header->magic, SHM_RINGBUFFER_MAGIC,
+                   __ATOMIC_RELEASE);
+
+  return ring;
+
+error:
+  ShmRingBuffer_destroy(ring);
+  return NULL;
+}
+
+ShmRingBuffer *ShmRingBuffer_attach_fd(int fd) {
+  size_t page = ShmRingBuffer_page_size();
+  ShmRingHeader *header = MAP_FAILED;
+  struct stat st;
+  ShmRingBuffer *ring = calloc(1, sizeof(ShmRingBuffer));
+  check_mem(ring);
+
+  ring->fd = fcntl(fd, F_DUPFD_CLOEXEC, 0);
+  check(ring->fd != -1, "Can't duplicate fd %d.", fd);
+  check(fstat(ring->fd, &st) == 0 && (size_t)st.st_size > page,
+        "fd %d is too small to be a ring.", fd);
+
+  // read the header before trusting the size it claims
+  header = mmap(NULL, page, PROT_READ, MAP_SHARED, ring->fd, 0);
+  check(header != MAP_FAILED, "Can't map the ring's header.");
+
+  // the creator stores magic last, the rest is only valid after it
+  check(__atomic_load_n(&header->magic, __ATOMIC_ACQUIRE) ==
+            SHM_RINGBUFFER_MAGIC,
+        "fd %d isn't a ring.", fd);
+  check(header->version == SHM_RINGBUFFER_VERSION,
+        "Ring version %u, expected %d.", header->version,
+        SHM_RINGBUFFER_VERSION);
+  uint64_t capacity = header->capacity;
+  check(capacity != 0 && (capacity & (capacity - 1)) == 0 &&
+            (uint64_t)st.st_size == page + capacity,
+        "Ring header doesn't match its size.");
+
+  munmap(header, page);
+  header = MAP_FAILED;
+
+  check(ShmRingBuffer_map(ring, capacity) == 0, "Can't map the ring.");
+  return ring;
+
+error:
+  if (header != MAP_FAILED) {
+    munmap(header, page);
+  }
+  ShmRingBuffer_destroy(ring);
+  return NULL;
+}
+
+ShmRingBuffer *ShmRingBuffer_attach(const char *name) {
+  int fd = shm_open(name, O_RDWR, 0);
+  check(fd != -1, "Can't open shared memory %s.", name);
+
+  ShmRingBuffer *ring = ShmRingBuffer_attach_fd(fd);
+  close(fd);
+  return ring;
+
+error:
+  return NULL;
+}
+
+void ShmRingBuffer_destroy(ShmRingBuffer *ring) {
+  if (ring) {
+    if (ring->header) {
+      munmap(ring->header, ShmRingBuffer_page_size() + ring->capacity * 2);
+    }
+    if (ring->fd != -1) {
+      close(ring->fd);
+    }
+    if (ring->name) {
+      shm_unlink(ring->name);
+      free(ring->name);
+    }
+    free(ring);
+  }
+}
+
+static inline int ShmRingBuffer_clamp(uint64_t n) {
+  return n > INT_MAX ? INT_MAX : (int)n;
+}
+
+// Bytes between the indices. The other side is another process and may be
+// broken or hostile, so anything outside [0, capacity] (a head past the tail
+// wraps to a huge count) means the header is corrupt and nothing is copied.
+static inline int ShmRingBuffer_used(ShmRingBuffer *ring, uint64_t head,
+                                     uint64_t tail, uint64_t *used) {
+  *used = tail - head;
+  check(*used <= ring->capacity,
+        "Corrupt ring: head %" PRIu64 ", tail %" PRIu64 ", capacity %zu.",
+        head, tail, ring->capacity);
+  return 0;
+error:
+  return -1;
+}
+
+int ShmRingBuffer_available_data(ShmRingBuffer *ring) {
+  uint64_t head = __atomic_load_n(&ring->header->head, __ATOMIC_ACQUIRE);
+  uint64_t tail = __atomic_load_n(&ring->header->tail, __ATOMIC_ACQUIRE);
+  uint64_t used = 0;
+  if (ShmRingBuffer_used(ring, head, tail, &used) == -1) {
+    return -1;
+  }
+  return ShmRingBuffer_clamp(used);
+}
+
+int ShmRingBuffer_available_space(ShmRingBuffer *ring) {
+  uint64_t head = __atomic_load_n(&ring->header->head, __ATOMIC_ACQUIRE);
+  uint64_t tail = __atomic_load_n(&ring->header->tail, __ATOMIC_ACQUIRE);
+  uint64_t used = 0;
+  if (ShmRingBuffer_used(ring, head, tail, &used) == -1) {
+    return -1;
+  }
+  return ShmRingBuffer_clamp(ring->capacity - used);
+}
+
+// WaitQueue_count adapters, a corrupt header ends the wait, the caller's
+// recheck reports it.
+static int ShmRingBuffer_data_count(void *ring) {
+  int available = ShmRingBuffer_available_data(ring);
+  return available < 0 ? INT_MAX : available;
+}
+
+static int ShmRingBuffer_space_count(void *ring) {
+  int available = ShmRingBuffer_available_space(ring);
+  return available < 0 ? INT_MAX : available;
+}
+
+int ShmRingBuffer_wait_data(ShmRingBuffer *ring, int amount, int timeout_ms) {
+  check(amount > 0 && (uint64_t)amount <= ring->capacity,
+        "Can't wait for %d bytes of a %zu byte ring.", amount, ring->capacity);
+  if (WaitQueue_wait(&ring->header->data, ShmRingBuffer_data_count, ring,
+                     amount, timeout_ms) < 0) {
+    return -1;
+  }
+  return ShmRingBuffer_available_data(ring);
+error:
+  return -1;
+}
+
+int ShmRingBuffer_wait_space(ShmRingBuffer *ring, int amount,
+                             int timeout_ms) {
+  check(amount > 0 && (uint64_t)amount <= ring->capacity,
+        "Can't wait for %d bytes of a %zu byte ring.", amount, ring->capacity);
+  if (WaitQueue_wait(&ring->header->space, ShmRingBuffer_space_count, ring,
+                     amount, timeout_ms) < 0) {
+    return -1;
+  }
+  return ShmRingBuffer_available_space(ring);
+error:
+  return -1;
+}
+
+int ShmRingBuffer_write(ShmRingBuffer *ring, const char *data, int length) {
+  ShmRingHeader *header = ring->header;
+  uint64_t tail = __atomic_load_n(&header->tail, __ATOMIC_RELAXED);
+  uint64_t head = __atomic_load_n(&header->head, __ATOMIC_ACQUIRE);
+  uint64_t used = 0;
+
+  if (ShmRingBuffer_used(ring, head, tail, &used) == -1) {
+    return -1;
+  }
+  if (length <= 0) {
+    return 0;
+  }
+  if ((uint64_t)length > ring->capacity - used) {
+    length = (int)(ring->capacity - used);
+  }
+
+  memcpy(ring->buffer + (tail & ring->mask), data, length);
+  __atomic_store_n(&header->tail, tail + length, __ATOMIC_RELEASE);
+
+  WaitQueue_wake(&header->data);
+  return length;
+}
+
+int ShmRingBuffer_read(ShmRingBuffer *ring, char *target, int amount) {
+  ShmRingHeader *header = ring->header;
+  uint64_t head = __atomic_load_n(&header->head, __ATOMIC_RELAXED);
+  uint64_t tail = __atomic_load_n(&header->tail, __ATOMIC_ACQUIRE);
+  uint64_t used = 0;
+
+  if (ShmRingBuffer_used(ring, head, tail, &used) == -1) {
+    return -1;
+  }
+  if (amount <= 0) {
+    return 0;
+  }
+  if ((uint64_t)amount > used) {
+    amount = (int)used;
+  }
+
+  memcpy(target, ring->buffer + (head & ring->mask), amount);
+  __atomic_store_n(&header->head, head + amount, __ATOMIC_RELEASE);
+
+  WaitQueue_wake(&header->space);
+  return amount;
+}
@@ -0,0 +1,115 @@
+#ifndef lcthw_ShmRingBuffer_h
+#define lcthw_ShmRingBuffer_h
+
+#include <lcthw/waitq.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define SHM_RINGBUFFER_MAGIC 0x6c637468 // "lcth"
+#define SHM_RINGBUFFER_VERSION 2
+
+/**
+ * What every attached process sees at the start of the shared memory. The
+ * producer's and the consumer's fields sit on their own cache lines, the
+ * data follows one page in so it stays page aligned.
+ */
+typedef struct ShmRingHeader {
+  uint32_t magic;
+  uint32_t version;
+  uint64_t capacity; // Data bytes, a power of two.
+
+  // Written by the producer.
+  _Alignas(64) uint64_t tail; // Bytes written so far.
+  WaitQueue data;             // The consumer sleeps here.
+
+  // Written by the consumer.
+  _Alignas(64) uint64_t head; // Bytes read so far.
+  WaitQueue space;            // The producer sleeps here.
+} ShmRingHeader;
+
+/**
+ * Single producer, single consumer byte ring in shared memory, for passing
+ * a stream to another process without sockets. The creator maps a memfd or
+ * a POSIX shared memory object, the other side attaches by inheriting or
+ * receiving the fd, or by the name. Indices live in the shared header and
+ * count bytes like PosixRingBuffer's power-of-two mode, the data is mapped
+ * twice back to back so every copy is a single memcpy.
+ *
+ * Either side can block for the other on a shared WaitQueue in the header,
+ * without a system call on the fast path: a writer only wakes the reader
+ * when it announced that it sleeps, and the other way round.
+ */
+typedef struct ShmRingBuffer {
+  ShmRingHeader *header;
+  char *buffer; // Data, mirrored.
+  uint64_t mask;
+  size_t capacity;
+  int fd;
+  char *name; // shm_open name of the creator, unlinked on destroy.
+} ShmRingBuffer;
+
+/**
+ * Creates a ring of at least `capacity` bytes, rounded up to a power of two
+ * pages. With a `name` (e.g. "/capture") it's a POSIX shared memory object
+ * others can attach to by name, which must not exist yet. With NULL it's an
+ * anonymous memfd, shared by passing ShmRingBuffer_fd.
+ */
+ShmRingBuffer *ShmRingBuffer_create(const char *name, size_t capacity);
+
+/**
+ * Attaches to a ring created elsewhere, by its fd. The ring keeps its own
+ * duplicate of `fd`.
+ *
+ * @return NULL if the memory isn't a ring of this version.
+ */
+ShmRingBuffer *ShmRingBuffer_attach_fd(int fd);
+
+/**
+ * Attaches to a ring by the name it was created with.
+ */
+ShmRingBuffer *ShmRingBuffer_attach(const char *name);
+
+/**
+ * Unmaps the ring in this process. The creator of a named ring unlinks the
+ * name too; processes still attached keep working.
+ */
+void ShmRingBuffer_destroy(ShmRingBuffer *ring);
+
+/**
+ * Producer side: copies up to `length` bytes in, fewer if the ring fills.
+ *
+ * @return the bytes written, -1 if the header's indices are corrupt.
+ */
+int ShmRingBuffer_write(ShmRingBuffer *ring, const char *data, int length);
+
+/**
+ * Consumer side: copies up to `amount` bytes out.
+ *
+ * @return the bytes read, -1 if the header's indices are corrupt.
+ */
+int ShmRingBuffer_read(ShmRingBuffer *ring, char *target, int amount);
+
+/**
+ * Bytes readable and writable, -1 if the header's indices are corrupt.
+ */
+int ShmRingBuffer_available_data(ShmRingBuffer *ring);
+
+int ShmRingBuffer_available_space(ShmRingBuffer *ring);
+
+/**
+ * Consumer side: sleeps until at least `amount` bytes can be read, for at
+ * most `timeout_ms` (negative waits forever).
+ *
+ * @return the bytes available, -1 on timeout or a corrupt header.
+ */
+int ShmRingBuffer_wait_data(ShmRingBuffer *ring, int amount, int timeout_ms);
+
+/**
+ * Producer side: sleeps until `amount` bytes can be written, as
+ * ShmRingBuffer_wait_data.
+ */
+int ShmRingBuffer_wait_space(ShmRingBuffer *ring, int amount, int timeout_ms);
+
+#define ShmRingBuffer_fd(R) ((R)->fd)
+
+#endif
@@ -0,0 +1,278 @@
+#include <lcthw/dbg.h>
+#include <lcthw/skiplist.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define SkipList_load(P) __atomic_load_n((P), __ATOMIC_ACQUIRE)
+
+// xorshift64, one state per thread so concurrent inserts don't share it
+static __thread uint64_t skiplist_rand_state = 0;
+
+// Each level is kept with a 1/4 chance, two random bits per level.
+static int SkipList_random_level() {
+  uint64_t x = skiplist_rand_state;
+
+  if (x == 0) {
+    x = (uint64_t)(uintptr_t)&skiplist_rand_state ^ (uint64_t)time(NULL) ^
+        0x9e3779b97f4a7c15ULL;
+  }
+
+  x ^= x << 13;
+  x ^= x >> 7;
+  x ^= x << 17;
+  skiplist_rand_state = x;
+
+  int level = 1 + __builtin_ctzll(x | (1ULL << 62)) / 2;
+  return level < SKIPLIST_MAX_LEVEL ? level : SKIPLIST_MAX_LEVEL;
+}
+
+static SkipListNode *SkipListNode_create(void *key, void *value, int level) {
+  SkipListNode *node =
+      calloc(1, sizeof(SkipListNode) + sizeof(SkipListNode *) * level);
+  check_mem(node);
+
+  node->key = key;
+  node->value = value;
+  node->level = level;
+
+  return node;
+
+error:
+  return NULL;
+}
+
+// Fills preds[i] with the last node before `key` on each level below `top`,
+// and succs[i] with the node after it. Returns the node holding `key`, NULL
+// if there's none.
+static SkipListNode *SkipList_find(SkipList *list, const void *key, int top,
+                                   SkipListNode **preds,
+                                   SkipListNode **succs) {
+  SkipListNode *pred = list->head;
+  SkipListNode *succ = NULL;
+
+  for (int i = top - 1; i >= 0; i--) {
+    succ = SkipList_load(&pred->next[i]);
+    while (succ != NULL && list->cmp(succ->key, key) < 0) {
+      pred = succ;
+      succ = SkipList_load(&pred->next[i]);
+    }
+
+    preds[i] = pred;
+    succs[i] = succ;
+  }
+
+  return succ != NULL && list->cmp(succ->key, key) == 0 ? succ : NULL;
+}
+
+static SkipList *SkipList_alloc(SkipList_compare cmp, int concurrent) {
+  SkipList *list = NULL;
+
+  check(cmp != NULL, "SkipList needs a compare function.");
+
+  list = calloc(1, sizeof(SkipList));
+  check_mem(list);
+
+  list->head = SkipListNode_create(NULL, NULL, SKIPLIST_MAX_LEVEL);
+  check_mem(list->head);
+
+  list->cmp = cmp;
+  list->level = 1;
+  list->concurrent = concurrent;
+
+  return list;
+
+error:
+  free(list);
+  return NULL;
+}
+
+SkipList *SkipList_create(SkipList_compare cmp) {
+  return SkipList_alloc(cmp, 0);
+}
+
+SkipList *SkipList_create_concurrent(SkipList_compare cmp) {
+  return SkipList_alloc(cmp, 1);
+}
+
+void SkipList_destroy(SkipList *list) {
+  if (list) {
+    SkipListNode *node = list->head;
+    while (node != NULL) {
+      SkipListNode *next = node->next[0];
+      free(node);
+      node = next;
+    }
+    free(list);
+  }
+}
+
+static int SkipList_set_concurrent(SkipList *list, void *key, void *value) {
+  SkipListNode *preds[SKIPLIST_MAX_LEVEL];
+  SkipListNode *succs[SKIPLIST_MAX_LEVEL];
+  SkipListNode *node = NULL;
+  int level = SkipList_random_level();
+
+  // raise the list's level first, searches from the old top still work, they
+  // just don't use the new levels yet
+  int top = __atomic_load_n(&list->level, __ATOMIC_RELAXED);
+  while (top < level && !__atomic_compare_exchange_n(&list->level, &top, level,
+                                                     0, __ATOMIC_RELAXED,
+                                                     __ATOMIC_RELAXED)) {
+  }
+  if (top < level) {
+    top = level;
+  }
+
+  for (;;) {
+    SkipListNode *found = SkipList_find(list, key, top, preds, succs);
+    if (found != NULL) {
+      __atomic_store_n(&found->value, value, __ATOMIC_RELEASE);
+      free(node);
+      return 0;
+    }
+
+    if (node == NULL) {
+      node = SkipListNode_create(key, value, level);
+      check_mem(node);
+    }
+
+    for (int i = 0; i < level; i++) {
+      node->next[i] = succs[i];
+    }
+
+    // linking level 0 puts the key in the list, if another thread changed
+    // that spot search again, the key may be there now
+    if (__atomic_compare_exchange_n(&preds[0]->next[0], &succs[0], node, 0,
+                                    __ATOMIC_RELEASE, __ATOMIC_RELAXED)) {
+      break;
+    }
+  }
+
+  // the upper levels are only shortcuts, each is retried until it links.
+  // Nothing is ever unlinked concurrently, so a fresh search always gives a
+  // valid spot.
+  for (int i = 1; i < level; i++) {
+    while (!__atomic_compare_exchange_n(&preds[i]->next[i], &succs[i], node,
+                                        0, __ATOMIC_RELEASE,
+                                        __ATOMIC_RELAXED)) {
+      SkipList_find(list, key, top, preds, succs);
+      __atomic_store_n(&node->next[i], succs[i], __ATOMIC_RELAXED);
+    }
+  }
+
+  __atomic_add_fetch(&list->count, 1, __ATOMIC_RELAXED);
+  return 0;
+
+error:
+  return -1;
+}
+
+int SkipList_set(SkipList *list, void *key, void *value) {
+  SkipListNode *preds[SKIPLIST_MAX_LEVEL];
+  SkipListNode *succs[SKIPLIST_MAX_LEVEL];
+
+  if (list->concurrent) {
+    return SkipList_set_concurrent(list, key, value);
+  }
+
+  SkipListNode *found = SkipList_find(list, key, list->level, preds, succs);
+  if (found != NULL) {
+    found->value = value;
+    return 0;
+  }
+
+  int level = SkipList_random_level();
+  for (; list->level < level; list->level++) {
+    preds[list->level] = list->head;
+    succs[list->level] = NULL;
+  }
+
+  SkipListNode *node = SkipListNode_create(key, value, level);
+  check_mem(node);
+
+  for (int i = 0; i < level; i++) {
+    node->next[i] = succs[i];
+    preds[i]->next[i] = node;
+  }
+
+  list->count++;
+  return 0;
+
+error:
+  return -1;
+}
+
+void *SkipList_get(SkipList *list, const void *key) {
+  int top = __atomic_load_n(&list->level, __ATOMIC_RELAXED);
+  SkipListNode *pred = list->head;
+
+  // SkipList_find without recording the path
+  for (int i = top - 1; i >= 0; i--) {
+    SkipListNode *succ = SkipList_load(&pred->next[i]);
+    while (succ != NULL) {
+      int rc = list->cmp(succ->key, key);
+      if (rc == 0) {
+        return SkipList_load(&succ->value);
+      } else if (rc > 0) {
+        break;
+      }
+      pred = succ;
+      succ = SkipList_load(&pred->next[i]);
+    }
+  }
+
+  return NULL;
+}
+
+void *SkipList_delete(SkipList *list, const void *key) {
+  SkipListNode *preds[SKIPLIST_MAX_LEVEL];
+  SkipListNode *succs[SKIPLIST_MAX_LEVEL];
+
+  SkipListNode *node = SkipList_find(list, key, list->level, preds, succs);
+  if (node == NULL) {
+    return NULL;
+  }
+
+  for (int i = 0; i < node->level; i++) {
+    preds[i]->next[i] = node->next[i];
+  }
+
+  while (list->level > 1 && list->head->next[list->level - 1] == NULL) {
+    list->level--;
+  }
+
+  void *value = node->value;
+  free(node);
+  list->count--;
+
+  return value;
+}
+
+SkipListNode *SkipList_seek(SkipList *list, const void *key) {
+  SkipListNode *preds[SKIPLIST_MAX_LEVEL];
+  SkipListNode *succs[SKIPLIST_MAX_LEVEL];
+  int top = __atomic_load_n(&list->level, __ATOMIC_RELAXED);
+
+  SkipList_find(list, key, top, preds, succs);
+
+  return succs[0];
+}
+
+int SkipList_range(SkipList *list, const void *from, const void *to,
+                   SkipList_traverse_cb cb, void *ctx) {
+  SkipListNode *node = from ? SkipList_seek(list, from) : SkipList_first(list);
+
+  for (; node != NULL; node = SkipList_next(node)) {
+    if (to != NULL && list->cmp(node->key, to) >= 0) {
+      break;
+    }
+
+    int rc = cb(ctx, node->key, SkipList_load(&node->value));
+    if (rc != 0) {
+      return rc;
+    }
+  }
+
+  return 0;
+}
@@ -0,0 +1,105 @@
+#ifndef lcthw_SkipList_h
+#define lcthw_SkipList_h
+
+// Enough levels for 4^32 keys with the 1/4 promotion chance.
+#define SKIPLIST_MAX_LEVEL 32
+
+typedef int (*SkipList_compare)(const void *a, const void *b);
+
+/**
+ * Called by SkipList_range for each key in the range, a non-zero return
+ * stops the scan.
+ */
+typedef int (*SkipList_traverse_cb)(void *ctx, void *key, void *value);
+
+typedef struct SkipListNode {
+  void *key;
+  void *value;
+  int level;                   // Number of forward pointers.
+  struct SkipListNode *next[]; // next[0] is the next key in order.
+} SkipListNode;
+
+/**
+ * An ordered map from `void *` keys to `void *` values, kept sorted by `cmp`.
+ * Insert, find and delete are O(log n) expected, iteration is in key order.
+ *
+ * bstring keys work with `(SkipList_compare)bstrcmp`.
+ */
+typedef struct SkipList {
+  SkipList_compare cmp;
+  SkipListNode *head; // Sentinel with SKIPLIST_MAX_LEVEL pointers, no key.
+  int level;          // Levels in use, searches start at the top one.
+  int count;
+  int concurrent;
+} SkipList;
+
+/**
+ * Creates an empty skip list for single threaded use.
+ *
+ * @param cmp Orders the keys, equal keys are the same entry.
+ */
+SkipList *SkipList_create(SkipList_compare cmp);
+
+/**
+ * Creates an empty skip list that many threads can SkipList_set into and read
+ * from at once without a lock. New nodes are linked level by level with a
+ * compare-and-swap on the forward pointers, retrying from a fresh search
+ * when another thread got there first.
+ *
+ * SkipList_delete and SkipList_destroy still need the list to themselves.
+ */
+SkipList *SkipList_create_concurrent(SkipList_compare cmp);
+
+/**
+ * Destroys the list and its nodes, keys and values are not freed.
+ */
+void SkipList_destroy(SkipList *list);
+
+/**
+ * Adds `key` with `value`, or replaces the value if the key is already there.
+ *
+ * @return 0 on success, -1 on allocation failure.
+ */
+int SkipList_set(SkipList *list, void *key, void *value);
+
+/**
+ * Finds the value stored for `key`, NULL if there is none.
+ */
+void *SkipList_get(SkipList *list, const void *key);
+
+/**
+ * Removes `key` and returns its value, NULL if it wasn't there. Not safe
+ * against other threads, even on a concurrent list.
+ */
+void *SkipList_delete(SkipList *list, const void *key);
+
+/**
+ * Finds the first node whose key is not less than `key`, the start of a
+ * range scan. NULL if every key is less.
+ */
+SkipListNode *SkipList_seek(SkipList *list, const void *key);
+
+/**
+ * Calls `cb` for every key in [from, to) in order. A NULL `from` starts at
+ * the first key, a NULL `to` runs to the last.
+ *
+ * @return 0, or the non-zero value `cb` stopped the scan with.
+ */
+int SkipList_range(SkipList *list, const void *from, const void *to,
+                   SkipList_traverse_cb cb, void *ctx);
+
+#define SkipList_count(L) ((L)->count)
+
+// Forward pointers are read with acquire so iterating a concurrent list sees
+// whole nodes, even while other threads insert.
+#define SkipList_first(L) __atomic_load_n(&(L)->head->next[0], __ATOMIC_ACQUIRE)
+
+#define SkipList_next(N) __atomic_load_n(&(N)->next[0], __ATOMIC_ACQUIRE)
+
+/**
+ * Iterates over the nodes in key order, V is a `SkipListNode *`.
+ */
+#define SKIPLIST_FOREACH(L, V)                                                 \
+  for (SkipListNode *V = SkipList_first(L); V != NULL; V = SkipList_next(V))
+
+#endif
@@ -30,6 +30,21 @@ static inline void *Stack_pop(Stack *stack) {
   return DArray_pop(stack->darray);
 }
 
+/**
+ * Pushes `n` values, `values[n - 1]` ends up on top.
+ */
+static inline int Stack_push_n(Stack *stack, void **values, int n) {
+  return DArray_push_n(stack->darray, values, n);
+}
+
+/**
+ * Pops up to `n` values into `values`, the old top last, so it undoes a
+ * Stack_push_n of the same count. Returns how many were popped.
+ */
+static inline int Stack_pop_n(Stack *stack, void **values, int n) {
+  return DArray_pop_n(stack->darray, values, n);
+}
+
 static inline void *Stack_peek(Stack *stack) {
   return DArray_last(stack->darray);
 }
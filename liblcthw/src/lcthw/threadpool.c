@@ -0,0 +1,559 @@
+#include <lcthw/dbg.h>
+#include <lcthw/threadpool.h>
+#include <sched.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+// Everything on a deque is a task: `run` does the work and frees the task.
+struct ThreadPoolTask {
+  void (*run)(ThreadPoolTask *task);
+};
+
+// Tasks from ThreadPool_submit_batch share one block, freed by the last one.
+typedef struct ThreadPoolBatch {
+  ThreadPool *pool;
+  int remaining;
+} ThreadPoolBatch;
+
+typedef struct ThreadPoolFnTask {
+  ThreadPoolTask base;
+  ThreadPool_fn fn;
+  void *arg;
+  ThreadPoolBatch *batch;
+} ThreadPoolFnTask;
+
+typedef struct ThreadPoolFor {
+  ThreadPool *pool;
+  ThreadPool_range_fn fn;
+  void *ctx;
+  long grain;
+  long remaining; // Indexes not run yet, the call returns at 0.
+} ThreadPoolFor;
+
+typedef struct ThreadPoolRangeTask {
+  ThreadPoolTask base;
+  ThreadPoolFor *job;
+  long begin;
+  long end;
+} ThreadPoolRangeTask;
+
+// The worker running on this thread, NULL on other threads.
+static __thread ThreadPoolWorker *threadpool_self = NULL;
+
+static inline ThreadPoolWorker *ThreadPool_self(ThreadPool *pool) {
+  return threadpool_self && threadpool_self->pool == pool ? threadpool_self
+                                                          : NULL;
+}
+
+// ---- Chase-Lev deque --------------------------------------------------------
+//
+// As in "Correct and Efficient Work-Stealing for Weak Memory Models" (Lê et
+// al.): the owner moves `bottom`, thieves move `top` with a CAS, and the only
+// race, on the last task, is settled by a CAS on `top` too.
+
+static ThreadPoolRing *ThreadPoolRing_create(long size) {
+  ThreadPoolRing *ring =
+      malloc(sizeof(ThreadPoolRing) + sizeof(ThreadPoolTask *) * size);
+  check_mem(ring);
+  ring->size = size;
+  return ring;
+
+error:
+  return NULL;
+}
+
+static int ThreadPoolDeque_init(ThreadPoolDeque *deque) {
+  deque->top = 0;
+  deque->bottom = 0;
+  deque->ring = ThreadPoolRing_create(THREADPOOL_DEQUE_CAPACITY);
+  check_mem(deque->ring);
+  deque->retired = DArray_create(sizeof(ThreadPoolRing *), 8);
+  check_mem(deque->retired);
+  return 0;
+
+error:
+  free(deque->ring);
+  deque->ring = NULL;
+  return -1;
+}
+
+static void ThreadPoolDeque_destroy(ThreadPoolDeque *deque) {
+  free(deque->ring);
+  if (deque->retired) {
+    // DArray_clear frees every element
+    DArray_clear_destroy(deque->retired);
+  }
+}
+
+static inline long ThreadPoolDeque_size(ThreadPoolDeque *deque) {
+  long b = __atomic_load_n(&deque->bottom, __ATOMIC_RELAXED);
+  long t = __atomic_load_n(&deque->top, __ATOMIC_RELAXED);
+  return b - t;
+}
+
+// Owner only. Doubles the ring, the old one is retired rather than freed.
+static ThreadPoolRing *ThreadPoolDeque_grow(ThreadPoolDeque *deque,
+                                            ThreadPoolRing *ring, long top,
+                                            long bottom) {
+  ThreadPoolRing *bigger = ThreadPoolRing_create(ring->size * 2);
+  check_mem(bigger);
+  check(DArray_push(deque->retired, ring) == 0, "Failed to retire a ring.");
+
+  for (long i = top; i < bottom; i++) {
+    bigger->slots[i & (bigger->size - 1)] = ring->slots[i & (ring->size - 1)];
+  }
+
+  __atomic_store_n(&deque->ring, bigger, __ATOMIC_RELEASE);
+  return bigger;
+
+error:
+  free(bigger);
+  return NULL;
+}
+
+// Owner only.
+static int ThreadPoolDeque_push(ThreadPoolDeque *deque, ThreadPoolTask *task) {
+  long b = __atomic_load_n(&deque->bottom, __ATOMIC_RELAXED);
+  long t = __atomic_load_n(&deque->top, __ATOMIC_ACQUIRE);
+  ThreadPoolRing *ring = __atomic_load_n(&deque->ring, __ATOMIC_RELAXED);
+
+  if (b - t > ring->size - 1) {
+    ring = ThreadPoolDeque_grow(deque, ring, t, b);
+    check(ring != NULL, "Failed to grow a worker deque.");
+  }
+
+  __atomic_store_n(&ring->slots[b & (ring->size - 1)], task,
+                   __ATOMIC_RELAXED);
+  // a release store rather than the paper's fence, same code on x86 and
+  // visible to ThreadSanitizer
+  __atomic_store_n(&deque->bottom, b + 1, __ATOMIC_RELEASE);
+  return 0;
+
+error:
+  return -1;
+}
+
+// Owner only, newest first.
+static ThreadPoolTask *ThreadPoolDeque_take(ThreadPoolDeque *deque) {
+  long b = __atomic_load_n(&deque->bottom, __ATOMIC_RELAXED) - 1;
+  ThreadPoolRing *ring = __atomic_load_n(&deque->ring, __ATOMIC_RELAXED);
+  __atomic_store_n(&deque->bottom, b, __ATOMIC_RELAXED);
+  __atomic_thread_fence(__ATOMIC_SEQ_CST);
+  long t = __atomic_load_n(&deque->top, __ATOMIC_RELAXED);
+
+  if (t > b) {
+    __atomic_store_n(&deque->bottom, b + 1, __ATOMIC_RELAXED);
+    return NULL;
+  }
+
+  ThreadPoolTask *task =
+      __atomic_load_n(&ring->slots[b & (ring->size - 1)], __ATOMIC_RELAXED);
+
+  if (t == b) {
+    // the last task, a thief may be after it too
+    if (!__atomic_compare_exchange_n(&deque->top, &t, t + 1, 0,
+                                     __ATOMIC_SEQ_CST, __ATOMIC_RELAXED)) {
+      task = NULL;
+    }
+    __atomic_store_n(&deque->bottom, b + 1, __ATOMIC_RELAXED);
+  }
+
+  return task;
+}
+
+// Any thread, oldest first. NULL when empty or when another thread won.
+static ThreadPoolTask *ThreadPoolDeque_steal(ThreadPoolDeque *deque) {
+  long t = __atomic_load_n(&deque->top, __ATOMIC_ACQUIRE);
+  __atomic_thread_fence(__ATOMIC_SEQ_CST);
+  long b = __atomic_load_n(&deque->bottom, __ATOMIC_ACQUIRE);
+
+  if (t >= b) {
+    return NULL;
+  }
+
+  ThreadPoolRing *ring = __atomic_load_n(&deque->ring, __ATOMIC_ACQUIRE);
+  ThreadPoolTask *task =
+      __atomic_load_n(&ring->slots[t & (ring->size - 1)], __ATOMIC_RELAXED);
+
+  if (!__atomic_compare_exchange_n(&deque->top, &t, t + 1, 0,
+                                   __ATOMIC_SEQ_CST, __ATOMIC_RELAXED)) {
+    return NULL;
+  }
+
+  return task;
+}
+
+// ---- finding work -----------------------------------------------------------
+
+static void ThreadPool_notify(ThreadPool *pool) {
+  if (__atomic_load_n(&pool->sleeping, __ATOMIC_RELAXED) > 0) {
+    pthread_mutex_lock(&pool->lock);
+    pthread_cond_signal(&pool->wake);
+    pthread_mutex_unlock(&pool->lock);
+  }
+}
+
+// Puts tasks where the current thread can: its own deque on a worker, the
+// shared queue elsewhere. Tasks that can't be queued for lack of memory are
+// run right here instead, so this never fails.
+static void ThreadPool_enqueue(ThreadPool *pool, ThreadPoolTask **tasks,
+                               int n) {
+  ThreadPoolWorker *self = ThreadPool_self(pool);
+  int i = 0;
+
+  if (self) {
+    while (i < n && ThreadPoolDeque_push(&self->deque, tasks[i]) == 0) {
+      i++;
+    }
+  }
+
+  if (i < n) {
+    pthread_mutex_lock(&pool->lock);
+    if (Queue_send_n(pool->inject, (void **)tasks + i, n - i) == 0) {
+      __atomic_add_fetch(&pool->injected, n - i, __ATOMIC_RELAXED);
+      i = n;
+    }
+    pthread_mutex_unlock(&pool->lock);
+  }
+
+  ThreadPool_notify(pool);
+
+  for (; i < n; i++) {
+    tasks[i]->run(tasks[i]);
+  }
+}
+
+static unsigned long ThreadPool_rand(unsigned long *state) {
+  unsigned long x = *state;
+  x ^= x << 13;
+  x ^= x >> 7;
+  x ^= x << 17;
+  return *state = x;
+}
+
+// Tries every other worker once, starting from a random one.
+static ThreadPoolTask *ThreadPool_steal(ThreadPool *pool,
+                                        ThreadPoolWorker *self,
+                                        unsigned long *rand_state) {
+  int start = ThreadPool_rand(rand_state) % pool->count;
+
+  for (int i = 0; i < pool->count; i++) {
+    ThreadPoolWorker *victim = &pool->workers[(start + i) % pool->count];
+    if (victim == self) {
+      continue;
+    }
+
+    ThreadPoolTask *task = ThreadPoolDeque_steal(&victim->deque);
+    if (task) {
+      return task;
+    }
+  }
+
+  return NULL;
+}
+
+// Takes a batch from the shared queue. A worker keeps one task to run and
+// puts the rest on its own deque, where others can steal them.
+static ThreadPoolTask *ThreadPool_take_injected(ThreadPool *pool,
+                                                ThreadPoolWorker *self) {
+  ThreadPoolTask *batch[THREADPOOL_INJECT_BATCH];
+  int want = self ? THREADPOOL_INJECT_BATCH : 1;
+
+  if (__atomic_load_n(&pool->injected, __ATOMIC_RELAXED) == 0) {
+    return NULL;
+  }
+
+  pthread_mutex_lock(&pool->lock);
+  int n = Queue_recv_n(pool->inject, (void **)batch, want);
+  __atomic_sub_fetch(&pool->injected, n, __ATOMIC_RELAXED);
+  pthread_mutex_unlock(&pool->lock);
+
+  if (n == 0) {
+    return NULL;
+  }
+
+  if (n > 1) {
+    ThreadPool_enqueue(pool, batch + 1, n - 1);
+  }
+
+  return batch[0];
+}
+
+static ThreadPoolTask *ThreadPool_find_task(ThreadPool *pool,
+                                            ThreadPoolWorker *self,
+                                            unsigned long *rand_state) {
+  ThreadPoolTask *task = self ? ThreadPoolDeque_take(&self->deque) : NULL;
+
+  if (task == NULL) {
+    task = ThreadPool_steal(pool, self, rand_state);
+  }
+  if (task == NULL) {
+    task = ThreadPool_take_injected(pool, self);
+  }
+
+  return task;
+}
+
+// Runs other tasks until `*counter` drops to 0.
+static void ThreadPool_help_until_zero(ThreadPool *pool, long *counter) {
+  ThreadPoolWorker *self = ThreadPool_self(pool);
+  unsigned long rand_state = (unsigned long)(uintptr_t)counter | 1;
+  unsigned long *state = self ? &self->rand_state : &rand_state;
+
+  while (__atomic_load_n(counter, __ATOMIC_ACQUIRE) > 0) {
+    ThreadPoolTask *task = ThreadPool_find_task(pool, self, state);
+    if (task) {
+      task->run(task);
+    } else {
+      sched_yield();
+    }
+  }
+}
+
+static void *ThreadPool_worker(void *arg) {
+  ThreadPoolWorker *self = arg;
+  ThreadPool *pool = self->pool;
+  int idle = 0;
+
+  threadpool_self = self;
+
+  for (;;) {
+    ThreadPoolTask *task = ThreadPool_find_task(pool, self, &self->rand_state);
+
+    if (task) {
+      task->run(task);
+      idle = 0;
+      continue;
+    }
+
+    if (__atomic_load_n(&pool->stop, __ATOMIC_ACQUIRE)) {
+      break;
+    }
+
+    if (++idle < THREADPOOL_SPIN) {
+      sched_yield();
+      continue;
+    }
+
+    // a task pushed onto another deque doesn't signal anyone, so sleep with
+    // a timeout instead of relying on a wakeup
+    struct timespec until;
+    clock_gettime(CLOCK_REALTIME, &until);
+    until.tv_nsec += 1000000;
+    if (until.tv_nsec >= 1000000000) {
+      until.tv_sec++;
+      until.tv_nsec -= 1000000000;
+    }
+
+    pthread_mutex_lock(&pool->lock);
+    pool->sleeping++;
+    if (pool->injected == 0 && !pool->stop) {
+      pthread_cond_timedwait(&pool->wake, &pool->lock, &until);
+    }
+    pool->sleeping--;
+    pthread_mutex_unlock(&pool->lock);
+  }
+
+  threadpool_self = NULL;
+  return NULL;
+}
+
+// ---- pool -------------------------------------------------------------------
+
+ThreadPool *ThreadPool_create(int count) {
+  ThreadPool *pool = NULL;
+
+  if (count == 0) {
+    count = (int)sysconf(_SC_NPROCESSORS_ONLN);
+  }
+  check(count > 0, "ThreadPool needs at least one worker, got %d.", count);
+
+  pool = calloc(1, sizeof(ThreadPool));
+  check_mem(pool);
+
+  // before anything can fail, destroy tears them down unconditionally
+  pthread_mutex_init(&pool->lock, NULL);
+  pthread_cond_init(&pool->wake, NULL);
+  pool->count = count;
+  pool->inject = Queue_create();
+  check_mem(pool->inject);
+
+  pool->workers = calloc(count, sizeof(ThreadPoolWorker));
+  check_mem(pool->workers);
+
+  for (int i = 0; i < count; i++) {
+    ThreadPoolWorker *worker = &pool->workers[i];
+    worker->pool = pool;
+    worker->rand_state = 0x9e3779b97f4a7c15UL * (i + 1);
+    check(ThreadPoolDeque_init(&worker->deque) == 0,
+          "Failed to make a worker deque.");
+  }
+
+  for (; pool->started < count; pool->started++) {
+    int rc = pthread_create(&pool->workers[pool->started].thread, NULL,
+                            ThreadPool_worker, &pool->workers[pool->started]);
+    check(rc == 0, "Failed to start worker %d.", pool->started);
+  }
+
+  return pool;
+
+error:
+  ThreadPool_destroy(pool);
+  return NULL;
+}
+
+void ThreadPool_destroy(ThreadPool *pool) {
+  if (pool == NULL) {
+    return;
+  }
+
+  if (pool->workers) {
+    ThreadPool_wait(pool);
+
+    __atomic_store_n(&pool->stop, 1, __ATOMIC_RELEASE);
+    pthread_mutex_lock(&pool->lock);
+    pthread_cond_broadcast(&pool->wake);
+    pthread_mutex_unlock(&pool->lock);
+
+    for (int i = 0; i < pool->started; i++) {
+      pthread_join(pool->workers[i].thread, NULL);
+    }
+
+    // including the deques of workers that never started
+    for (int i = 0; i < pool->count; i++) {
+      ThreadPoolDeque_destroy(&pool->workers[i].deque);
+    }
+    free(pool->workers);
+  }
+
+  if (pool->inject) {
+    List_destroy(pool->inject->list);
+    free(pool->inject);
+  }
+
+  pthread_cond_destroy(&pool->wake);
+  pthread_mutex_destroy(&pool->lock);
+  free(pool);
+}
+
+// ---- submitted tasks --------------------------------------------------------
+
+static void ThreadPoolFnTask_run(ThreadPoolTask *base) {
+  ThreadPoolFnTask *task = (ThreadPoolFnTask *)base;
+  ThreadPoolBatch *batch = task->batch;
+  ThreadPool *pool = batch->pool;
+
+  task->fn(task->arg);
+
+  // the batch header and its tasks are one block
+  if (__atomic_sub_fetch(&batch->remaining, 1, __ATOMIC_ACQ_REL) == 0) {
+    free(batch);
+  }
+  __atomic_sub_fetch(&pool->pending, 1, __ATOMIC_RELEASE);
+}
+
+int ThreadPool_submit_batch(ThreadPool *pool, ThreadPool_fn fn, void **args,
+                            int n) {
+  if (n <= 0) {
+    return 0;
+  }
+
+  // header, tasks, then the pointers handed to the queues, all in one block
+  ThreadPoolBatch *batch =
+      malloc(sizeof(ThreadPoolBatch) +
+             (sizeof(ThreadPoolFnTask) + sizeof(ThreadPoolTask *)) * n);
+  check_mem(batch);
+
+  ThreadPoolFnTask *tasks = (ThreadPoolFnTask *)(batch + 1);
+  ThreadPoolTask **queued = (ThreadPoolTask **)(tasks + n);
+  batch->pool = pool;
+  batch->remaining = n;
+
+  for (int i = 0; i < n; i++) {
+    tasks[i] = (ThreadPoolFnTask){{ThreadPoolFnTask_run}, fn, args[i], batch};
+    queued[i] = &tasks[i].base;
+  }
+
+  __atomic_add_fetch(&pool->pending, n, __ATOMIC_RELAXED);
+  ThreadPool_enqueue(pool, queued, n);
+
+  return 0;
+
+error:
+  return -1;
+}
+
+int ThreadPool_submit(ThreadPool *pool, ThreadPool_fn fn, void *arg) {
+  return ThreadPool_submit_batch(pool, fn, &arg, 1);
+}
+
+void ThreadPool_wait(ThreadPool *pool) {
+  ThreadPool_help_until_zero(pool, &pool->pending);
+}
+
+// ---- parallel_for -----------------------------------------------------------
+
+// Whether nobody is short of work, as far as the current thread can tell
+// without looking at every deque: its own deque (or the shared queue) still
+// has tasks that thieves haven't taken.
+static int ThreadPool_backlogged(ThreadPool *pool) {
+  ThreadPoolWorker *self = ThreadPool_self(pool);
+  return self ? ThreadPoolDeque_size(&self->deque) > 0
+              : __atomic_load_n(&pool->injected, __ATOMIC_RELAXED) > 0;
+}
+
+static void ThreadPoolRangeTask_run(ThreadPoolTask *base);
+
+// Runs [begin, end) of the job, splitting off the upper half whenever the
+// queued work has been stolen, down to `grain`.
+static void ThreadPool_run_range(ThreadPoolFor *job, long begin, long end) {
+  while (begin < end) {
+    if (end - begin > job->grain && !ThreadPool_backlogged(job->pool)) {
+      long mid = begin + (end - begin) / 2;
+      ThreadPoolRangeTask *half = malloc(sizeof(ThreadPoolRangeTask));
+
+      // without memory for the task, run the whole range here
+      if (half != NULL) {
+        *half = (ThreadPoolRangeTask){{ThreadPoolRangeTask_run}, job, mid, end};
+        ThreadPoolTask *queued = &half->base;
+
+        ThreadPool_enqueue(job->pool, &queued, 1);
+        end = mid;
+        continue;
+      }
+    }
+
+    long stop = end - begin > job->grain ? begin + job->grain : end;
+    job->fn(job->ctx, begin, stop);
+    __atomic_sub_fetch(&job->remaining, stop - begin, __ATOMIC_RELEASE);
+    begin = stop;
+  }
+}
+
+static void ThreadPoolRangeTask_run(ThreadPoolTask *base) {
+  ThreadPoolRangeTask *task = (ThreadPoolRangeTask *)base;
+  ThreadPoolFor *job = task->job;
+  long begin = task->begin;
+  long end = task->end;
+
+  free(task);
+  ThreadPool_run_range(job, begin, end);
+}
+
+int ThreadPool_parallel_for(ThreadPool *pool, long begin, long end,
+                            long grain, ThreadPool_range_fn fn, void *ctx) {
+  check(fn != NULL, "parallel_for needs a function.");
+  check(begin <= end, "Bad range [%ld, %ld).", begin, end);
+
+  ThreadPoolFor job = {pool, fn, ctx, grain > 0 ? grain : 1, end - begin};
+
+  ThreadPool_run_range(&job, begin, end);
+  ThreadPool_help_until_zero(pool, &job.remaining);
+
+  return 0;
+
+error:
+  return -1;
+}
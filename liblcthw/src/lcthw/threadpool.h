@@ -0,0 +1,122 @@
+#ifndef lcthw_ThreadPool_h
+#define lcthw_ThreadPool_h
+
+#include <lcthw/darray.h>
+#include <lcthw/queue.h>
+#include <pthread.h>
+
+// Slots in a new worker deque, it doubles when full.
+#define THREADPOOL_DEQUE_CAPACITY 64
+// Tasks a worker moves from the shared queue to its deque in one go.
+#define THREADPOOL_INJECT_BATCH 32
+// Empty polls before an idle worker goes to sleep.
+#define THREADPOOL_SPIN 64
+
+typedef void (*ThreadPool_fn)(void *arg);
+
+/**
+ * Body of a ThreadPool_parallel_for, called on [begin, end) sub-ranges.
+ */
+typedef void (*ThreadPool_range_fn)(void *ctx, long begin, long end);
+
+typedef struct ThreadPoolTask ThreadPoolTask;
+
+// Circular array of a Chase-Lev deque. Retired rings are kept until the pool
+// is destroyed, a thief may still be reading one.
+typedef struct ThreadPoolRing {
+  long size; // Power of two.
+  ThreadPoolTask *slots[];
+} ThreadPoolRing;
+
+/**
+ * Chase-Lev work-stealing deque: the owning worker pushes and takes at the
+ * bottom without locking, other workers steal from the top with one CAS.
+ */
+typedef struct ThreadPoolDeque {
+  long top;
+  long bottom;
+  ThreadPoolRing *ring;
+  DArray *retired; // Outgrown rings.
+} ThreadPoolDeque;
+
+struct ThreadPool;
+
+typedef struct ThreadPoolWorker {
+  struct ThreadPool *pool;
+  ThreadPoolDeque deque;
+  unsigned long rand_state; // Picks steal victims.
+  pthread_t thread;
+} ThreadPoolWorker;
+
+/**
+ * A fixed set of worker threads, each with its own deque. Tasks a worker
+ * creates go on its deque, idle workers steal from a random victim, and
+ * tasks submitted from other threads go through a shared Queue that workers
+ * drain in batches.
+ */
+typedef struct ThreadPool {
+  int count;
+  int started; // Workers whose thread is running.
+  ThreadPoolWorker *workers;
+
+  pthread_mutex_t lock; // Guards `inject`, and sleeping on `wake`.
+  pthread_cond_t wake;
+  Queue *inject; // Tasks from threads that aren't workers.
+  int injected;  // Count of `inject`, read without the lock.
+  int sleeping;
+  int stop;
+
+  long pending; // Submitted tasks not finished yet, for ThreadPool_wait.
+} ThreadPool;
+
+/**
+ * Starts a pool of `count` worker threads, or one per online CPU when
+ * `count` is 0.
+ */
+ThreadPool *ThreadPool_create(int count);
+
+/**
+ * Waits for every submitted task, then stops and joins the workers.
+ */
+void ThreadPool_destroy(ThreadPool *pool);
+
+/**
+ * Queues `fn(arg)`. From a worker the task goes on that worker's deque,
+ * otherwise on the shared queue.
+ *
+ * @return 0 on success, -1 on allocation failure.
+ */
+int ThreadPool_submit(ThreadPool *pool, ThreadPool_fn fn, void *arg);
+
+/**
+ * Queues `fn(args[i])` for each of `n` args. The tasks share one allocation
+ * and go on the queue together, so this is much cheaper than `n` submits.
+ *
+ * @return 0 on success, -1 on allocation failure.
+ */
+int ThreadPool_submit_batch(ThreadPool *pool, ThreadPool_fn fn, void **args,
+                            int n);
+
+/**
+ * Blocks until every task submitted so far has finished. The calling thread
+ * runs tasks while it waits. Not for use inside a task, which would wait for
+ * itself; use ThreadPool_parallel_for there.
+ */
+void ThreadPool_wait(ThreadPool *pool);
+
+/**
+ * Calls `fn(ctx, b, e)` over sub-ranges covering [begin, end) and returns
+ * when all of them are done. Ranges are split in half on demand, an idle
+ * worker steals the other half, so only as many tasks are made as there are
+ * thieves to run them. Nothing smaller than `grain` indexes is split off.
+ *
+ * Safe to call from inside a task. The calling thread works on the range
+ * too.
+ *
+ * @return 0 on success, -1 if `fn` is NULL or `end` is before `begin`. When
+ * tasks can't be allocated the range is run without splitting.
+ */
+int ThreadPool_parallel_for(ThreadPool *pool, long begin, long end,
+                            long grain, ThreadPool_range_fn fn, void *ctx);
+
+#endif
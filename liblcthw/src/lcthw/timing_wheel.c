@@ -0,0 +1,228 @@
+#include <lcthw/dbg.h>
+#include <lcthw/timing_wheel.h>
+#include <stdlib.h>
+
+// Link a timer's embedded node at the end of `list`, no allocation.
+static void TimingWheel_link(List *list, Timer *timer) {
+  ListNode *node = &timer->node;
+
+  node->next = NULL;
+  node->prev = list->last;
+
+  if (list->last == NULL) {
+    list->first = node;
+  } else {
+    list->last->next = node;
+  }
+
+  list->last = node;
+  list->count++;
+  timer->slot = list;
+}
+
+// Unlink a timer's embedded node from the list it is in, without freeing it.
+static void TimingWheel_unlink(Timer *timer) {
+  List *list = timer->slot;
+  ListNode *node = &timer->node;
+
+  if (node->prev) {
+    node->prev->next = node->next;
+  } else {
+    list->first = node->next;
+  }
+
+  if (node->next) {
+    node->next->prev = node->prev;
+  } else {
+    list->last = node->prev;
+  }
+
+  node->next = node->prev = NULL;
+  list->count--;
+  timer->slot = NULL;
+}
+
+// Pick the slot for `timer` relative to the wheel's clock.
+static void TimingWheel_place(TimingWheel *wheel, Timer *timer) {
+  uint64_t expires = timer->expires;
+
+  if (expires < wheel->now) {
+    expires = wheel->now;
+  }
+
+  uint64_t delta = expires - wheel->now;
+  if (delta > TIMING_WHEEL_MAX_DELTA) {
+    // park it as far as we can see, it is re-placed when cascaded
+    delta = TIMING_WHEEL_MAX_DELTA;
+    expires = wheel->now + delta;
+  }
+
+  int level = 0;
+  while (delta >= (1ULL << (TIMING_WHEEL_BITS * (level + 1)))) {
+    level++;
+  }
+
+  int slot = (expires >> (TIMING_WHEEL_BITS * level)) & TIMING_WHEEL_MASK;
+  TimingWheel_link(&wheel->slots[level][slot], timer);
+  wheel->level_count[level]++;
+}
+
+// Take a timer out of whatever slot it is in and keep the level counts right.
+static void TimingWheel_detach(TimingWheel *wheel, Timer *timer) {
+  if (timer->slot != &wheel->expired) {
+    int level = (timer->slot - &wheel->slots[0][0]) / TIMING_WHEEL_SLOTS;
+    wheel->level_count[level]--;
+  }
+
+  TimingWheel_unlink(timer);
+}
+
+// Re-place every timer of one slot, they all land in lower levels.
+static int TimingWheel_cascade(TimingWheel *wheel, int level, int slot) {
+  List *list = &wheel->slots[level][slot];
+
+  while (list->first != NULL) {
+    Timer *timer = list->first->value;
+    TimingWheel_detach(wheel, timer);
+    TimingWheel_place(wheel, timer);
+  }
+
+  return slot;
+}
+
+TimingWheel *TimingWheel_create(uint64_t now) {
+  TimingWheel *wheel = calloc(1, sizeof(TimingWheel));
+  check_mem(wheel);
+
+  wheel->now = now;
+
+  return wheel;
+
+error:
+  return NULL;
+}
+
+void TimingWheel_destroy(TimingWheel *wheel) {
+  if (wheel) {
+    for (int level = 0; level < TIMING_WHEEL_LEVELS; level++) {
+      for (int slot = 0; slot < TIMING_WHEEL_SLOTS; slot++) {
+        List *list = &wheel->slots[level][slot];
+        while (list->first != NULL) {
+          TimingWheel_unlink(list->first->value);
+        }
+      }
+    }
+
+    free(wheel);
+  }
+}
+
+void Timer_init(Timer *timer, Timer_callback callback, void *data) {
+  timer->node.next = NULL;
+  timer->node.prev = NULL;
+  timer->node.value = timer;
+  timer->expires = 0;
+  timer->slot = NULL;
+  timer->callback = callback;
+  timer->data = data;
+}
+
+int TimingWheel_add(TimingWheel *wheel, Timer *timer, uint64_t expires) {
+  check(wheel != NULL, "Wheel is NULL.");
+  check(timer != NULL, "Timer is NULL.");
+  check(timer->node.value == timer, "Timer was not initialized.");
+
+  if (Timer_pending(timer)) {
+    TimingWheel_cancel(wheel, timer);
+  }
+
+  timer->expires = expires;
+  TimingWheel_place(wheel, timer);
+  wheel->count++;
+
+  return 0;
+
+error:
+  return -1;
+}
+
+int TimingWheel_cancel(TimingWheel *wheel, Timer *timer) {
+  check_debug(Timer_pending(timer), "Timer is not pending.");
+
+  TimingWheel_detach(wheel, timer);
+  wheel->count--;
+
+  return 0;
+
+error:
+  return -1;
+}
+
+int TimingWheel_advance(TimingWheel *wheel, uint64_t now) {
+  int fired = 0;
+
+  // the loop runs until wheel->now passes `now`, which UINT64_MAX can't
+  if (now == UINT64_MAX) {
+    now = UINT64_MAX - 1;
+  }
+
+  while (wheel->now <= now) {
+    if (wheel->count == wheel->expired.count) {
+      // nothing left in the slots, jump straight to the target
+      wheel->now = now + 1;
+      break;
+    }
+
+    int index = wheel->now & TIMING_WHEEL_MASK;
+
+    if (index == 0) {
+      // level 0 wrapped, pull the next turn down from the levels above
+      for (int level = 1; level < TIMING_WHEEL_LEVELS; level++) {
+        int slot = (wheel->now >> (TIMING_WHEEL_BITS * level)) &
+                   TIMING_WHEEL_MASK;
+        if (TimingWheel_cascade(wheel, level, slot) != 0) {
+          break;
+        }
+      }
+    }
+
+    if (wheel->level_count[0] == 0) {
+      // nothing can fire before the next cascade of the lowest non-empty
+      // level, jump to it instead of walking every tick in between.
+      int level = 1;
+      while (level < TIMING_WHEEL_LEVELS - 1 &&
+             wheel->level_count[level] == 0) {
+        level++;
+      }
+
+      int shift = TIMING_WHEEL_BITS * level;
+      uint64_t next = ((wheel->now >> shift) + 1) << shift;
+      // `next` wraps to 0 in the last turn of the top level
+      wheel->now = next > wheel->now && next <= now ? next : now + 1;
+      continue;
+    }
+
+    List *list = &wheel->slots[0][index];
+    while (list->first != NULL) {
+      Timer *timer = list->first->value;
+      TimingWheel_detach(wheel, timer);
+      TimingWheel_link(&wheel->expired, timer);
+    }
+
+    wheel->now++;
+  }
+
+  // run the whole batch, callbacks are free to touch the wheel
+  while (wheel->expired.first != NULL) {
+    Timer *timer = wheel->expired.first->value;
+    TimingWheel_unlink(timer);
+    wheel->count--;
+    fired++;
+
+    if (timer->callback) {
+      timer->callback(timer, timer->data);
+    }
+  }
+
+  return fired;
+}
@@ -0,0 +1,98 @@
+#ifndef lcthw_TimingWheel_h
+#define lcthw_TimingWheel_h
+
+#include <lcthw/list.h>
+#include <stdint.h>
+
+// clang-format off
+#define TIMING_WHEEL_BITS 8
+#define TIMING_WHEEL_SLOTS (1 << TIMING_WHEEL_BITS)
+#define TIMING_WHEEL_MASK (TIMING_WHEEL_SLOTS - 1)
+#define TIMING_WHEEL_LEVELS 4
+// Timers further out than this are parked in the last level and cascaded
+// again until they are in range.
+#define TIMING_WHEEL_MAX_DELTA ((1ULL << (TIMING_WHEEL_BITS * TIMING_WHEEL_LEVELS)) - 1)
+// clang-format on
+
+struct Timer;
+
+typedef void (*Timer_callback)(struct Timer *timer, void *data);
+
+/**
+ * A timer owned by the caller, usually embedded in a connection struct.
+ *
+ * The `node` uses the same layout as any List node (its `value` points back
+ * to the timer), so adding, cascading and cancelling only relink it and never
+ * allocate.
+ */
+typedef struct Timer {
+  ListNode node;
+  uint64_t expires;     // The tick at which the timer fires.
+  List *slot;           // The wheel slot holding the timer, NULL if inactive.
+  Timer_callback callback;
+  void *data;
+} Timer;
+
+/**
+ * Hashed hierarchical timing wheel.
+ *
+ * Level 0 has one slot per tick, every next level has one slot per full turn
+ * of the level below it. When a lower level wraps, the matching slot of the
+ * level above is cascaded down, so every timer is moved at most
+ * TIMING_WHEEL_LEVELS times before it fires.
+ */
+typedef struct TimingWheel {
+  uint64_t now; // The next tick to be processed.
+  int count;    // Number of pending timers.
+  int level_count[TIMING_WHEEL_LEVELS]; // Lets advance skip idle turns.
+  List slots[TIMING_WHEEL_LEVELS][TIMING_WHEEL_SLOTS];
+  List expired; // Timers collected by the current advance, run as a batch.
+} TimingWheel;
+
+/**
+ * Creates an empty wheel whose clock starts at `now`.
+ */
+TimingWheel *TimingWheel_create(uint64_t now);
+
+/**
+ * Destroys the wheel. Pending timers are detached but not freed, they belong
+ * to the caller.
+ */
+void TimingWheel_destroy(TimingWheel *wheel);
+
+/**
+ * Sets the callback of a timer before it is added for the first time.
+ */
+void Timer_init(Timer *timer, Timer_callback callback, void *data);
+
+#define Timer_pending(T) ((T)->slot != NULL)
+
+/**
+ * Schedules `timer` to fire at tick `expires`, in O(1). A timer that is
+ * already pending is rescheduled. Expiry times in the past fire on the next
+ * advance.
+ *
+ * @return 0 on success, -1 on error.
+ */
+int TimingWheel_add(TimingWheel *wheel, Timer *timer, uint64_t expires);
+
+/**
+ * Cancels a pending timer in O(1).
+ *
+ * @return 0 if the timer was pending, -1 otherwise.
+ */
+int TimingWheel_cancel(TimingWheel *wheel, Timer *timer);
+
+/**
+ * Moves the clock forward to `now`, collects every timer whose `expires` is
+ * `<= now` and then runs their callbacks in expiry order. Callbacks may add
+ * or cancel any timer, including the one being run. The clock stops at
+ * UINT64_MAX - 1, a `now` of UINT64_MAX advances to that.
+ *
+ * @return the number of timers that fired.
+ */
+int TimingWheel_advance(TimingWheel *wheel, uint64_t now);
+
+#define TimingWheel_count(W) ((W)->count)
+
+#endif
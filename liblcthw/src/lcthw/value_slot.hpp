@@ -0,0 +1,165 @@
+#ifndef lcthw_ValueSlot_hpp
+#define lcthw_ValueSlot_hpp
+
+#include <cstddef>
+#include <cstring>
+#include <iterator>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace lcthw {
+namespace detail {
+
+/**
+ * How a T lives in the `void *` slot of a C container. Trivially copyable
+ * values that fit are stored in the bytes of the slot itself, so they cost
+ * no allocation, anything else is boxed with `new`.
+ */
+template <typename T> struct ValueSlot {
+  static constexpr bool is_inline = std::is_trivially_copyable_v<T> &&
+                                    sizeof(T) <= sizeof(void *) &&
+                                    alignof(T) <= alignof(void *);
+
+  template <typename... Args> static void *make(Args &&...args) {
+    if constexpr (is_inline) {
+      T value(std::forward<Args>(args)...);
+      void *slot = nullptr;
+      std::memcpy(&slot, &value, sizeof(T));
+      return slot;
+    } else {
+      return new T(std::forward<Args>(args)...);
+    }
+  }
+
+  static T &ref(void *&slot) {
+    if constexpr (is_inline) {
+      return *std::launder(reinterpret_cast<T *>(&slot));
+    } else {
+      return *static_cast<T *>(slot);
+    }
+  }
+
+  static const T &ref(void *const &slot) {
+    if constexpr (is_inline) {
+      return *std::launder(reinterpret_cast<const T *>(&slot));
+    } else {
+      return *static_cast<const T *>(slot);
+    }
+  }
+
+  // Moves the value out and frees its box.
+  static T take(void *slot) {
+    if constexpr (is_inline) {
+      // `slot` was last written as a pointer, copy the bytes out rather
+      // than read it through a T lvalue the optimizer may not order
+      alignas(T) unsigned char bytes[sizeof(T)];
+      std::memcpy(bytes, &slot, sizeof(T));
+      return *std::launder(reinterpret_cast<T *>(bytes));
+    } else {
+      T *boxed = static_cast<T *>(slot);
+      T value(std::move(*boxed));
+      delete boxed;
+      return value;
+    }
+  }
+
+  static void destroy(void *slot) {
+    if constexpr (!is_inline) {
+      delete static_cast<T *>(slot);
+    }
+  }
+};
+
+/**
+ * Random access iterator over an array of slots, as DArray's `contents`.
+ * T is const qualified for a const_iterator.
+ */
+template <typename T> class SlotIterator {
+  using Slot = ValueSlot<std::remove_const_t<T>>;
+  using slot_ptr =
+      std::conditional_t<std::is_const_v<T>, void *const *, void **>;
+
+public:
+  using iterator_category = std::random_access_iterator_tag;
+  using value_type = std::remove_const_t<T>;
+  using difference_type = std::ptrdiff_t;
+  using pointer = T *;
+  using reference = T &;
+
+  SlotIterator() = default;
+  explicit SlotIterator(slot_ptr slot) : slot_(slot) {}
+
+  // iterator to const_iterator
+  template <typename U,
+            typename = std::enable_if_t<std::is_same_v<const U, T> &&
+                                        !std::is_same_v<U, T>>>
+  SlotIterator(const SlotIterator<U> &other) : slot_(other.base()) {}
+
+  slot_ptr base() const { return slot_; }
+
+  reference operator*() const { return Slot::ref(*slot_); }
+  pointer operator->() const { return &Slot::ref(*slot_); }
+  reference operator[](difference_type n) const { return Slot::ref(slot_[n]); }
+
+  SlotIterator &operator++() {
+    ++slot_;
+    return *this;
+  }
+  SlotIterator operator++(int) { return SlotIterator(slot_++); }
+  SlotIterator &operator--() {
+    --slot_;
+    return *this;
+  }
+  SlotIterator operator--(int) { return SlotIterator(slot_--); }
+
+  SlotIterator &operator+=(difference_type n) {
+    slot_ += n;
+    return *this;
+  }
+  SlotIterator &operator-=(difference_type n) {
+    slot_ -= n;
+    return *this;
+  }
+
+  friend SlotIterator operator+(SlotIterator it, difference_type n) {
+    return it += n;
+  }
+  friend SlotIterator operator+(difference_type n, SlotIterator it) {
+    return it += n;
+  }
+  friend SlotIterator operator-(SlotIterator it, difference_type n) {
+    return it -= n;
+  }
+  friend difference_type operator-(const SlotIterator &a,
+                                   const SlotIterator &b) {
+    return a.slot_ - b.slot_;
+  }
+
+  friend bool operator==(const SlotIterator &a, const SlotIterator &b) {
+    return a.slot_ == b.slot_;
+  }
+  friend bool operator!=(const SlotIterator &a, const SlotIterator &b) {
+    return a.slot_ != b.slot_;
+  }
+  friend bool operator<(const SlotIterator &a, const SlotIterator &b) {
+    return a.slot_ < b.slot_;
+  }
+  friend bool operator>(const SlotIterator &a, const SlotIterator &b) {
+    return a.slot_ > b.slot_;
+  }
+  friend bool operator<=(const SlotIterator &a, const SlotIterator &b) {
+    return a.slot_ <= b.slot_;
+  }
+  friend bool operator>=(const SlotIterator &a, const SlotIterator &b) {
+    return a.slot_ >= b.slot_;
+  }
+
+private:
+  slot_ptr slot_ = nullptr;
+};
+
+} // namespace detail
+} // namespace lcthw
+
+#endif
@@ -0,0 +1,130 @@
+#define _GNU_SOURCE
+#include <lcthw/waitq.h>
+#include <limits.h>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+static inline void WaitQueue_relax() {
+#if defined(__x86_64__) || defined(__i386__)
+  __builtin_ia32_pause();
+#elif defined(__aarch64__)
+  __asm__ __volatile__("yield");
+#else
+  __asm__ __volatile__("" : : : "memory");
+#endif
+}
+
+static long WaitQueue_futex(WaitQueue *queue, int op, uint32_t value,
+                            const struct timespec *timeout) {
+  if (!queue->shared) {
+    op |= FUTEX_PRIVATE_FLAG;
+  }
+  return syscall(SYS_futex, &queue->seq, op, value, timeout, NULL, 0);
+}
+
+void WaitQueue_init(WaitQueue *queue, int shared) {
+  queue->seq = 0;
+  queue->waiting = 0;
+  queue->spin = sysconf(_SC_NPROCESSORS_ONLN) > 1 ? WAITQUEUE_SPIN : 0;
+  queue->shared = shared != 0;
+}
+
+// The fence pairs with the one in WaitQueue_arm: either the sleeper's
+// recheck sees the index the caller stored, or this sees it waiting.
+int WaitQueue_wake(WaitQueue *queue) {
+  __atomic_thread_fence(__ATOMIC_SEQ_CST);
+  if (__atomic_load_n(&queue->waiting, __ATOMIC_RELAXED) &&
+      __atomic_exchange_n(&queue->waiting, 0, __ATOMIC_RELAXED)) {
+    __atomic_add_fetch(&queue->seq, 1, __ATOMIC_RELEASE);
+    WaitQueue_futex(queue, FUTEX_WAKE, INT_MAX, NULL);
+    return 1;
+  }
+  return 0;
+}
+
+// Only wakes lower the flag: a sleeper that turns out not to need it can't
+// tell whether another one still does.
+int WaitQueue_arm(WaitQueue *queue, WaitQueue_count count, void *ring,
+                  int amount) {
+  int n = count(ring);
+  if (n >= amount) {
+    return n;
+  }
+
+  __atomic_store_n(&queue->waiting, 1, __ATOMIC_RELAXED);
+  __atomic_thread_fence(__ATOMIC_SEQ_CST);
+  return count(ring);
+}
+
+// Time left until `deadline`, 0 once it passed.
+static int WaitQueue_left(const struct timespec *deadline,
+                          struct timespec *left) {
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+
+  left->tv_sec = deadline->tv_sec - now.tv_sec;
+  left->tv_nsec = deadline->tv_nsec - now.tv_nsec;
+  if (left->tv_nsec < 0) {
+    left->tv_sec--;
+    left->tv_nsec += 1000000000L;
+  }
+  return left->tv_sec >= 0;
+}
+
+int WaitQueue_wait(WaitQueue *queue, WaitQueue_count count, void *ring,
+                   int amount, int timeout_ms) {
+  struct timespec deadline;
+  // racy when several sleep here, it's only a hint
+  uint32_t spin = __atomic_load_n(&queue->spin, __ATOMIC_RELAXED);
+  // the header may be shared with a peer we don't trust
+  if (spin > WAITQUEUE_SPIN_MAX) {
+    spin = WAITQUEUE_SPIN_MAX;
+  }
+  int n = 0;
+
+  for (uint32_t i = 0; i < spin; i++) {
+    if ((n = count(ring)) >= amount) {
+      if (i > 0 && spin < WAITQUEUE_SPIN_MAX) {
+        __atomic_store_n(&queue->spin, spin * 2, __ATOMIC_RELAXED);
+      }
+      return n;
+    }
+    WaitQueue_relax();
+  }
+
+  if ((n = count(ring)) >= amount) {
+    return n;
+  }
+
+  if (timeout_ms >= 0) {
+    clock_gettime(CLOCK_MONOTONIC, &deadline);
+    deadline.tv_sec += timeout_ms / 1000;
+    deadline.tv_nsec += (timeout_ms % 1000) * 1000000L;
+    if (deadline.tv_nsec >= 1000000000L) {
+      deadline.tv_sec++;
+      deadline.tv_nsec -= 1000000000L;
+    }
+  }
+
+  if (spin > WAITQUEUE_SPIN_MIN) {
+    __atomic_store_n(&queue->spin, spin / 2, __ATOMIC_RELAXED);
+  }
+
+  for (;;) {
+    uint32_t seen = __atomic_load_n(&queue->seq, __ATOMIC_ACQUIRE);
+
+    if ((n = WaitQueue_arm(queue, count, ring, amount)) >= amount) {
+      return n;
+    }
+
+    struct timespec left;
+    if (timeout_ms >= 0 && !WaitQueue_left(&deadline, &left)) {
+      return -1;
+    }
+
+    // returns at once if a wake bumped `seq` since we looked
+    WaitQueue_futex(queue, FUTEX_WAIT, seen, timeout_ms >= 0 ? &left : NULL);
+  }
+}
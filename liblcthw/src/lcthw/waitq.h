@@ -0,0 +1,77 @@
+#ifndef lcthw_WaitQueue_h
+#define lcthw_WaitQueue_h
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Most polls a waiter spins through before it parks.
+#define WAITQUEUE_SPIN_MAX 4096
+// Least a budget halves to, a budget of 1 could never show polling pays off.
+#define WAITQUEUE_SPIN_MIN 2
+// Spin budget of a fresh queue.
+#define WAITQUEUE_SPIN 64
+
+/**
+ * Where one side of a ring sleeps until the other side moves an index: a
+ * futex word plus a flag sleepers raise first, so the other side only makes
+ * a system call when someone really sleeps. A wake wakes every sleeper.
+ * It's plain words, it works in shared memory between processes too when
+ * created `shared`.
+ *
+ * A waiter first polls for up to `spin` rounds, then parks. The budget
+ * adapts: it doubles when polling paid off and halves, down to
+ * WAITQUEUE_SPIN_MIN, when the waiter had to park anyway. With one CPU
+ * online it stays 0, the other side can't run while we spin.
+ */
+typedef struct WaitQueue {
+  uint32_t seq;     // Futex word, bumped by a wake that finds a sleeper.
+  uint32_t waiting; // Raised by the sleeper, cleared by the wake.
+  uint32_t spin;    // Poll budget of the sleeper.
+  uint32_t shared;  // Futex between processes.
+} WaitQueue;
+
+/**
+ * How much the sleeper is waiting on there is now, e.g. the data in a ring.
+ */
+typedef int (*WaitQueue_count)(void *ring);
+
+void WaitQueue_init(WaitQueue *queue, int shared);
+
+/**
+ * Wakes the sleeper, if there is one, after an index moved. The index must
+ * be stored before this is called.
+ *
+ * @return 1 if someone was waiting.
+ */
+int WaitQueue_wake(WaitQueue *queue);
+
+/**
+ * Waits until `count(ring)` reaches `amount`, for at most `timeout_ms`
+ * (negative waits forever).
+ *
+ * @return the last count, -1 on timeout.
+ */
+int WaitQueue_wait(WaitQueue *queue, WaitQueue_count count, void *ring,
+                   int amount, int timeout_ms);
+
+/**
+ * Unless the count already reached `amount`, raises the waiting flag
+ * without sleeping, for a sleeper that blocks somewhere else (e.g. epoll on
+ * an eventfd the waker also signals), then rechecks the count. Only the
+ * next WaitQueue_wake lowers the flag, even when the recheck says there's
+ * nothing to wait for; that costs the wake a spurious system call, lowering
+ * it here could hide another sleeper.
+ *
+ * @return the count.
+ */
+int WaitQueue_arm(WaitQueue *queue, WaitQueue_count count, void *ring,
+                  int amount);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,240 @@
+#include "bench.h"
+#include <lcthw/list.h>
+#include <lcthw/queue.h>
+#include <lcthw/stack.h>
+#include <stdio.h>
+
+// One op moves a batch of `batch` values in or out, with the single value
+// calls in a loop or with the _n variants, reported per element.
+#define MAX_BATCH 256
+
+static List *list = NULL;
+static Queue *queue = NULL;
+static Stack *stack = NULL;
+static void *values[MAX_BATCH];
+static int batch = 1;
+
+static void list_new(void *ctx, long iters) {
+  (void)ctx;
+  (void)iters;
+  list = List_create();
+}
+
+static void list_filled(void *ctx, long iters) {
+  (void)ctx;
+  list = List_create();
+  for (long i = 0; i < iters; i++) {
+    List_push_n(list, values, batch);
+  }
+}
+
+static void list_free(void *ctx) {
+  (void)ctx;
+  List_destroy(list);
+}
+
+static void queue_new(void *ctx, long iters) {
+  (void)ctx;
+  (void)iters;
+  queue = Queue_create();
+}
+
+static void queue_filled(void *ctx, long iters) {
+  (void)ctx;
+  queue = Queue_create();
+  for (long i = 0; i < iters; i++) {
+    Queue_send_n(queue, values, batch);
+  }
+}
+
+static void queue_free(void *ctx) {
+  (void)ctx;
+  // the values are fake pointers, don't clear them
+  List_destroy(queue->list);
+  free(queue);
+}
+
+// The array is grown (and its pages touched) before timing, so the pushes
+// measure the copies rather than realloc and page faults.
+static void stack_new(void *ctx, long iters) {
+  (void)ctx;
+  void *out[MAX_BATCH];
+
+  stack = Stack_create();
+  for (long i = 0; i < iters; i++) {
+    Stack_push_n(stack, values, batch);
+  }
+  while (Stack_pop_n(stack, out, MAX_BATCH) > 0) {
+  }
+}
+
+static void stack_filled(void *ctx, long iters) {
+  (void)ctx;
+  stack = Stack_create();
+  for (long i = 0; i < iters; i++) {
+    Stack_push_n(stack, values, batch);
+  }
+}
+
+static void stack_free(void *ctx) {
+  (void)ctx;
+  DArray_destroy(stack->darray);
+  free(stack);
+}
+
+// ---- one value at a time ---------------------------------------------------
+
+static void run_list_push(void *ctx, long iters) {
+  (void)ctx;
+  for (long i = 0; i < iters; i++) {
+    for (int j = 0; j < batch; j++) {
+      List_push(list, values[j]);
+    }
+  }
+}
+
+static void run_list_pop(void *ctx, long iters) {
+  (void)ctx;
+  for (long i = 0; i < iters; i++) {
+    for (int j = 0; j < batch; j++) {
+      void *val = List_pop(list);
+      bench_do_not_optimize(val);
+    }
+  }
+}
+
+static void run_queue_send(void *ctx, long iters) {
+  (void)ctx;
+  for (long i = 0; i < iters; i++) {
+    for (int j = 0; j < batch; j++) {
+      Queue_send(queue, values[j]);
+    }
+  }
+}
+
+static void run_queue_recv(void *ctx, long iters) {
+  (void)ctx;
+  for (long i = 0; i < iters; i++) {
+    for (int j = 0; j < batch; j++) {
+      void *val = Queue_recv(queue);
+      bench_do_not_optimize(val);
+    }
+  }
+}
+
+static void run_stack_push(void *ctx, long iters) {
+  (void)ctx;
+  for (long i = 0; i < iters; i++) {
+    for (int j = 0; j < batch; j++) {
+      Stack_push(stack, values[j]);
+    }
+  }
+}
+
+static void run_stack_pop(void *ctx, long iters) {
+  (void)ctx;
+  for (long i = 0; i < iters; i++) {
+    for (int j = 0; j < batch; j++) {
+      void *val = Stack_pop(stack);
+      bench_do_not_optimize(val);
+    }
+  }
+}
+
+// ---- whole batches ---------------------------------------------------------
+
+static void run_list_push_n(void *ctx, long iters) {
+  (void)ctx;
+  for (long i = 0; i < iters; i++) {
+    List_push_n(list, values, batch);
+  }
+}
+
+static void run_list_pop_n(void *ctx, long iters) {
+  (void)ctx;
+  void *out[MAX_BATCH];
+  for (long i = 0; i < iters; i++) {
+    List_pop_n(list, out, batch);
+    bench_escape(out);
+  }
+}
+
+static void run_queue_send_n(void *ctx, long iters) {
+  (void)ctx;
+  for (long i = 0; i < iters; i++) {
+    Queue_send_n(queue, values, batch);
+  }
+}
+
+static void run_queue_recv_n(void *ctx, long iters) {
+  (void)ctx;
+  void *out[MAX_BATCH];
+  for (long i = 0; i < iters; i++) {
+    Queue_recv_n(queue, out, batch);
+    bench_escape(out);
+  }
+}
+
+static void run_stack_push_n(void *ctx, long iters) {
+  (void)ctx;
+  for (long i = 0; i < iters; i++) {
+    Stack_push_n(stack, values, batch);
+  }
+}
+
+static void run_stack_pop_n(void *ctx, long iters) {
+  (void)ctx;
+  void *out[MAX_BATCH];
+  for (long i = 0; i < iters; i++) {
+    Stack_pop_n(stack, out, batch);
+    bench_escape(out);
+  }
+}
+
+void all_benches() {
+  static const int batches[] = {1, 16, 256};
+  char name[64];
+
+  for (long i = 0; i < MAX_BATCH; i++) {
+    values[i] = (void *)(i + 1);
+  }
+
+  for (size_t b = 0; b < sizeof(batches) / sizeof(batches[0]); b++) {
+    batch = batches[b];
+
+#define BATCH_BENCH(NAME, ...)                                                 \
+  snprintf(name, sizeof(name), NAME "/%d", batch);                             \
+  bench_run(.name = name, .items_per_op = batch, __VA_ARGS__)
+
+    BATCH_BENCH("List_push", .setup = list_new, .run = run_list_push,
+                .teardown = list_free);
+    BATCH_BENCH("List_push_n", .setup = list_new, .run = run_list_push_n,
+                .teardown = list_free);
+    BATCH_BENCH("List_pop", .setup = list_filled, .run = run_list_pop,
+                .teardown = list_free);
+    BATCH_BENCH("List_pop_n", .setup = list_filled, .run = run_list_pop_n,
+                .teardown = list_free);
+
+    BATCH_BENCH("Queue_send", .setup = queue_new, .run = run_queue_send,
+                .teardown = queue_free);
+    BATCH_BENCH("Queue_send_n", .setup = queue_new, .run = run_queue_send_n,
+                .teardown = queue_free);
+    BATCH_BENCH("Queue_recv", .setup = queue_filled, .run = run_queue_recv,
+                .teardown = queue_free);
+    BATCH_BENCH("Queue_recv_n", .setup = queue_filled, .run = run_queue_recv_n,
+                .teardown = queue_free);
+
+    BATCH_BENCH("Stack_push", .setup = stack_new, .run = run_stack_push,
+                .teardown = stack_free);
+    BATCH_BENCH("Stack_push_n", .setup = stack_new, .run = run_stack_push_n,
+                .teardown = stack_free);
+    BATCH_BENCH("Stack_pop", .setup = stack_filled, .run = run_stack_pop,
+                .teardown = stack_free);
+    BATCH_BENCH("Stack_pop_n", .setup = stack_filled, .run = run_stack_pop_n,
+                .teardown = stack_free);
+
+#undef BATCH_BENCH
+  }
+}
+
+RUN_BENCHES(all_benches);
@@ -0,0 +1,346 @@
+#ifndef _bench_h
+#define _bench_h
+
+#include "perf_counters.h"
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#if defined(BENCH_USE_RDTSC) && (defined(__x86_64__) || defined(__i386__))
+#include <x86intrin.h>
+#define BENCH_RDTSC 1
+#else
+#define BENCH_RDTSC 0
+#endif
+
+// Tunables, all of them can be overridden from the environment with the
+// same name, e.g. `BENCH_SAMPLES=100 make bench`. BENCH_PERF=0 turns off the
+// hardware counters.
+#define BENCH_SAMPLES 25      // Timed samples per benchmark.
+#define BENCH_WARMUP 2        // Untimed samples run before the timed ones.
+#define BENCH_SAMPLE_NS 5e6   // Target duration of one sample.
+#define BENCH_MAX_ITERS (1L << 26)
+
+/**
+ * One benchmark case.
+ *
+ * `run` must perform exactly `iters` operations, `setup` and `teardown` are
+ * called around every sample and are not timed, so `run` can consume state
+ * prepared for it (e.g. pop from a list that setup filled).
+ */
+typedef struct Bench {
+  const char *name;
+  void (*setup)(void *ctx, long iters);
+  void (*run)(void *ctx, long iters);
+  void (*teardown)(void *ctx);
+  void *ctx;
+  long bytes_per_op; // When set, throughput is reported as well.
+  long items_per_op; // When set, the time per item (e.g. node) is too.
+} Bench;
+
+typedef struct BenchResult {
+  long iters; // Operations per sample.
+  int samples;
+  double median_ns; // All the times are per operation.
+  double p99_ns;
+  double mean_ns;
+  double stddev_ns;
+  double min_ns;
+  // Counter totals of the timed samples divided by their operations, only
+  // meaningful where PerfCounters_available() says so.
+  double per_op[PERF_COUNTER_MAX];
+  double perf_running; // PerfCounters_running_ratio of the samples.
+} BenchResult;
+
+int benches_run;
+const char *bench_suite = "";
+
+static PerfCounters bench_perf;
+static int bench_perf_state = 0; // 0: not opened yet, 1: open, -1: off
+
+/**
+ * Keeps the compiler from proving a value unused and deleting the code that
+ * produced it.
+ */
+static inline void bench_escape(const void *p) {
+  __asm__ __volatile__("" : : "g"(p) : "memory");
+}
+
+/**
+ * Forces every pending store to be considered observable.
+ */
+static inline void bench_clobber() { __asm__ __volatile__("" : : : "memory"); }
+
+#define bench_do_not_optimize(V) bench_escape(&(V))
+
+static inline uint64_t bench_monotonic_ns() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+#if BENCH_RDTSC
+static double bench_tsc_per_ns = 0;
+
+static inline uint64_t bench_ticks() {
+  _mm_lfence();
+  return __rdtsc();
+}
+
+static inline double bench_ticks_to_ns(uint64_t ticks) {
+  if (bench_tsc_per_ns == 0) {
+    // calibrate once against the monotonic clock
+    uint64_t ns = bench_monotonic_ns(), tsc = __rdtsc();
+    while (bench_monotonic_ns() - ns < 10000000)
+      ;
+    bench_tsc_per_ns = (double)(__rdtsc() - tsc) /
+                       (double)(bench_monotonic_ns() - ns);
+  }
+  return ticks / bench_tsc_per_ns;
+}
+#else
+static inline uint64_t bench_ticks() { return bench_monotonic_ns(); }
+
+static inline double bench_ticks_to_ns(uint64_t ticks) { return ticks; }
+#endif
+
+static inline double bench_env(const char *name, double fallback) {
+  const char *val = getenv(name);
+  return val && *val ? atof(val) : fallback;
+}
+
+static inline int bench_perf_enabled() {
+  if (bench_perf_state == 0) {
+    bench_perf_state = -1;
+
+    if (bench_env("BENCH_PERF", 1) != 0) {
+      if (PerfCounters_open(&bench_perf) > 0) {
+        bench_perf_state = 1;
+      } else {
+        fprintf(stderr, "bench: no performance counters available, "
+                        "reporting times only\n");
+      }
+    }
+  }
+
+  return bench_perf_state == 1;
+}
+
+/**
+ * Counts around code that doesn't fit a Bench, e.g. a whole run of threads
+ * timed by hand, until bench_counters_stop. Nothing when counters are off.
+ */
+static inline void bench_counters_start() {
+  if (bench_perf_enabled())
+    PerfCounters_start(&bench_perf);
+}
+
+static inline void bench_counters_stop() {
+  if (bench_perf_state == 1)
+    PerfCounters_stop(&bench_perf);
+}
+
+// The counter totals since the last reset divided by `ops`.
+static inline void bench_counters_per(double *per_op, double ops) {
+  for (int i = 0; i < PERF_COUNTER_MAX; i++) {
+    per_op[i] = (double)bench_perf.values[i] / ops;
+  }
+}
+
+// Prints the counters line under a result, per `unit` (e.g. "op"). A
+// running ratio below 1 means the PMU was multiplexed and the values are
+// extrapolated.
+static inline void bench_counters_print(const double *per_op, double running,
+                                        const char *unit) {
+  printf("%-44s", "");
+  for (int i = 0; i < PERF_COUNTER_MAX; i++) {
+    if (PerfCounters_available(&bench_perf, i))
+      printf(" %s %.4g", perf_counter_names[i], per_op[i]);
+  }
+  if (PerfCounters_available(&bench_perf, PERF_CYCLES) &&
+      PerfCounters_available(&bench_perf, PERF_INSTRUCTIONS) &&
+      per_op[PERF_CYCLES] > 0) {
+    printf(" ipc %.2f", per_op[PERF_INSTRUCTIONS] / per_op[PERF_CYCLES]);
+  }
+  if (running < 1) {
+    printf("  counted %.0f%%", running * 100);
+  }
+  printf("  (per %s)\n", unit);
+}
+
+// Appends the counters to an open JSON object.
+static inline void bench_counters_json(FILE *out, const double *per_op,
+                                       double running, const char *unit) {
+  for (int i = 0; i < PERF_COUNTER_MAX; i++) {
+    if (PerfCounters_available(&bench_perf, i))
+      fprintf(out, ", \"%s_per_%s\": %.3f", perf_counter_names[i], unit,
+              per_op[i]);
+  }
+  fprintf(out, ", \"perf_running_ratio\": %.3f", running);
+}
+
+// Times one sample of `iters` operations, in nanoseconds. When `counted` is
+// set the hardware counters run around the timed region too.
+static inline double bench_sample(Bench *bench, long iters, int counted) {
+  counted = counted && bench_perf_enabled();
+
+  if (bench->setup)
+    bench->setup(bench->ctx, iters);
+
+  if (counted)
+    PerfCounters_start(&bench_perf);
+
+  bench_clobber();
+  uint64_t start = bench_ticks();
+  bench->run(bench->ctx, iters);
+  bench_clobber();
+  uint64_t end = bench_ticks();
+
+  if (counted)
+    PerfCounters_stop(&bench_perf);
+
+  if (bench->teardown)
+    bench->teardown(bench->ctx);
+
+  return bench_ticks_to_ns(end - start);
+}
+
+// Grows the iteration count until one sample takes about `target_ns`.
+static inline long bench_calibrate(Bench *bench, double target_ns) {
+  long iters = 1;
+
+  for (;;) {
+    double ns = bench_sample(bench, iters, 0);
+
+    if (ns >= target_ns * 0.9 || iters >= BENCH_MAX_ITERS)
+      return iters;
+
+    // extrapolate once the sample is long enough to trust, but re-measure
+    // since a cold first sample overestimates the cost
+    long next = ns >= target_ns / 100 ? (long)(iters * (target_ns / ns))
+                                      : iters * 2;
+    if (next <= iters)
+      next = iters + 1;
+
+    iters = next < BENCH_MAX_ITERS ? next : BENCH_MAX_ITERS;
+  }
+}
+
+static inline int bench_cmp_double(const void *a, const void *b) {
+  double x = *(const double *)a, y = *(const double *)b;
+  return (x > y) - (x < y);
+}
+
+static inline void bench_report(Bench *bench, BenchResult *r) {
+  int counters = bench_perf_state == 1;
+
+  printf("%-44s %12.2f ns/op  p99 %12.2f  sd %10.2f  (%ld ops x %d)",
+         bench->name, r->median_ns, r->p99_ns, r->stddev_ns, r->iters,
+         r->samples);
+  if (bench->bytes_per_op > 0) {
+    printf("  %.2f MB/s",
+           bench->bytes_per_op / r->median_ns * 1e9 / (1024.0 * 1024.0));
+  }
+  if (bench->items_per_op > 0) {
+    printf("  %.2f ns/item", r->median_ns / bench->items_per_op);
+  }
+  printf("\n");
+
+  if (counters) {
+    bench_counters_print(r->per_op, r->perf_running, "op");
+  }
+
+  const char *json = getenv("BENCH_JSON");
+  if (json && *json) {
+    FILE *out = fopen(json, "a");
+    if (out) {
+      fprintf(out,
+              "{\"suite\": \"%s\", \"name\": \"%s\", \"iters\": %ld, "
+              "\"samples\": %d, "
+              "\"median_ns\": %.3f, \"p99_ns\": %.3f, \"mean_ns\": %.3f, "
+              "\"stddev_ns\": %.3f, \"min_ns\": %.3f, \"bytes_per_op\": %ld, "
+              "\"items_per_op\": %ld",
+              bench_suite, bench->name, r->iters, r->samples, r->median_ns,
+              r->p99_ns, r->mean_ns, r->stddev_ns, r->min_ns,
+              bench->bytes_per_op, bench->items_per_op);
+      if (counters) {
+        bench_counters_json(out, r->per_op, r->perf_running, "op");
+      }
+      fprintf(out, "}\n");
+      fclose(out);
+    }
+  }
+}
+
+/**
+ * Calibrates, warms up and samples one benchmark, then reports it on stdout
+ * and, when BENCH_JSON names a file, appends it there as a JSON line.
+ */
+static inline BenchResult Bench_run(Bench *bench) {
+  BenchResult r = {0};
+  int samples = (int)bench_env("BENCH_SAMPLES", BENCH_SAMPLES);
+  int warmup = (int)bench_env("BENCH_WARMUP", BENCH_WARMUP);
+  double target_ns = bench_env("BENCH_SAMPLE_NS", BENCH_SAMPLE_NS);
+
+  if (samples < 1)
+    samples = 1;
+
+  double *times = malloc(sizeof(double) * samples);
+  if (!times) {
+    fprintf(stderr, "bench: out of memory\n");
+    exit(1);
+  }
+
+  r.iters = bench_calibrate(bench, target_ns);
+  r.samples = samples;
+
+  for (int i = 0; i < warmup; i++) {
+    bench_sample(bench, r.iters, 0);
+  }
+
+  PerfCounters_reset(&bench_perf);
+  for (int i = 0; i < samples; i++) {
+    times[i] = bench_sample(bench, r.iters, 1) / r.iters;
+    r.mean_ns += times[i];
+  }
+  r.mean_ns /= samples;
+
+  bench_counters_per(r.per_op, (double)r.iters * samples);
+  r.perf_running = PerfCounters_running_ratio(&bench_perf);
+
+  for (int i = 0; i < samples; i++) {
+    r.stddev_ns += (times[i] - r.mean_ns) * (times[i] - r.mean_ns);
+  }
+  r.stddev_ns = samples > 1 ? sqrt(r.stddev_ns / (samples - 1)) : 0;
+
+  qsort(times, samples, sizeof(double), bench_cmp_double);
+  r.min_ns = times[0];
+  r.median_ns = samples % 2 ? times[samples / 2]
+                            : (times[samples / 2 - 1] + times[samples / 2]) / 2;
+  r.p99_ns = times[(int)ceil(samples * 0.99) - 1];
+
+  free(times);
+  benches_run++;
+  bench_report(bench, &r);
+
+  return r;
+}
+
+#define bench_run(...) Bench_run(&(Bench){__VA_ARGS__})
+
+#define RUN_BENCHES(name)                                                      \
+  int main(int argc, char *argv[]) {                                           \
+    (void)argc;                                                                \
+    bench_suite = argv[0];                                                     \
+    printf("----\nBENCHMARKING: %s\n", argv[0]);                               \
+    /* before the suite starts threads, so they inherit the counters */        \
+    bench_perf_enabled();                                                      \
+    name();                                                                    \
+    printf("Benchmarks run: %d\n", benches_run);                               \
+    return 0;                                                                  \
+  }
+
+#endif
@@ -0,0 +1,163 @@
+#include "bench.h"
+#include <lcthw/broadcast_ringbuffer.h>
+#include <lcthw/posix_ringbuffer.h>
+#include <pthread.h>
+#include <unistd.h>
+
+// One producer fans MESSAGES messages out to CONSUMERS consumer threads,
+// through one BroadcastRingBuffer or through a PosixRingBuffer per consumer
+// that the producer writes every message into. Both sides block with the
+// rings' futex waits rather than spin, so the numbers mean something on a
+// machine with fewer CPUs than threads. A run is timed whole, the best of
+// RUNS is reported.
+#define CONSUMERS 4
+#define MESSAGES (1 << 20)
+#define MSG_SIZE 64
+#define RING_SIZE (1 << 20)
+#define RUNS 3
+
+static BroadcastRingBuffer *broadcast = NULL;
+static PosixRingBuffer *rings[CONSUMERS];
+static long checksums[CONSUMERS];
+
+static void *broadcast_consumer(void *arg) {
+  int consumer = (int)(intptr_t)arg;
+  char msg[MSG_SIZE];
+  long sum = 0;
+
+  for (long i = 0; i < MESSAGES; i++) {
+    BroadcastRingBuffer_wait_data(broadcast, consumer, MSG_SIZE, -1);
+    BroadcastRingBuffer_read(broadcast, consumer, msg, MSG_SIZE);
+    sum += msg[0];
+  }
+  checksums[consumer] = sum;
+  return NULL;
+}
+
+static void broadcast_producer(const char *msg) {
+  for (long i = 0; i < MESSAGES; i++) {
+    while (BroadcastRingBuffer_write(broadcast, msg, MSG_SIZE) == 0) {
+      BroadcastRingBuffer_wait_space(broadcast, MSG_SIZE, -1);
+    }
+  }
+}
+
+static void *copies_consumer(void *arg) {
+  int consumer = (int)(intptr_t)arg;
+  char msg[MSG_SIZE];
+  long sum = 0;
+
+  for (long i = 0; i < MESSAGES; i++) {
+    PosixRingBuffer_wait_data(rings[consumer], MSG_SIZE, -1);
+    PosixRingBuffer_read(rings[consumer], msg, MSG_SIZE);
+    sum += msg[0];
+  }
+  checksums[consumer] = sum;
+  return NULL;
+}
+
+static void copies_producer(const char *msg) {
+  for (long i = 0; i < MESSAGES; i++) {
+    for (int c = 0; c < CONSUMERS; c++) {
+      PosixRingBuffer_wait_space(rings[c], MSG_SIZE, -1);
+      PosixRingBuffer_write(rings[c], msg, MSG_SIZE);
+    }
+  }
+}
+
+static double run_once(int use_broadcast) {
+  pthread_t threads[CONSUMERS];
+  char msg[MSG_SIZE];
+  memset(msg, 1, sizeof(msg));
+
+  if (use_broadcast) {
+    broadcast = BroadcastRingBuffer_create(RING_SIZE, CONSUMERS, 0);
+  } else {
+    for (int c = 0; c < CONSUMERS; c++) {
+      rings[c] = PosixRingBuffer_create_pow2(RING_SIZE);
+      PosixRingBuffer_enable_notify(rings[c]);
+    }
+  }
+
+  bench_counters_start();
+  uint64_t start = bench_monotonic_ns();
+  for (int c = 0; c < CONSUMERS; c++) {
+    pthread_create(&threads[c], NULL,
+                   use_broadcast ? broadcast_consumer : copies_consumer,
+                   (void *)(intptr_t)c);
+  }
+  if (use_broadcast) {
+    broadcast_producer(msg);
+  } else {
+    copies_producer(msg);
+  }
+  for (int c = 0; c < CONSUMERS; c++) {
+    pthread_join(threads[c], NULL);
+    if (checksums[c] != MESSAGES) {
+      fprintf(stderr, "consumer %d lost messages\n", c);
+      exit(1);
+    }
+  }
+  double ns = bench_monotonic_ns() - start;
+  bench_counters_stop();
+
+  if (use_broadcast) {
+    BroadcastRingBuffer_destroy(broadcast);
+  } else {
+    for (int c = 0; c < CONSUMERS; c++) {
+      PosixRingBuffer_destroy(rings[c]);
+    }
+  }
+  return ns;
+}
+
+static void report(const char *name, int use_broadcast) {
+  double per_msg[PERF_COUNTER_MAX];
+  double best = 0;
+
+  // the consumers inherit the counters, so they count every thread
+  PerfCounters_reset(&bench_perf);
+  for (int i = 0; i < RUNS; i++) {
+    double ns = run_once(use_broadcast);
+    if (best == 0 || ns < best) {
+      best = ns;
+    }
+  }
+
+  double ns_per_msg = best / MESSAGES;
+  double mb_s = (double)MESSAGES * MSG_SIZE * CONSUMERS / best * 1e9 /
+                (1024.0 * 1024.0);
+  printf("%-44s %12.2f ns/msg  %10.2f MB/s delivered\n", name, ns_per_msg,
+         mb_s);
+  bench_counters_per(per_msg, (double)RUNS * MESSAGES);
+  if (bench_perf_state == 1) {
+    bench_counters_print(per_msg, PerfCounters_running_ratio(&bench_perf),
+                         "msg");
+  }
+  benches_run++;
+
+  const char *json = getenv("BENCH_JSON");
+  FILE *out = json && *json ? fopen(json, "a") : NULL;
+  if (out) {
+    fprintf(out,
+            "{\"suite\": \"%s\", \"name\": \"%s\", \"ns_per_msg\": %.3f, "
+            "\"mb_per_s\": %.2f",
+            bench_suite, name, ns_per_msg, mb_s);
+    if (bench_perf_state == 1) {
+      bench_counters_json(out, per_msg,
+                          PerfCounters_running_ratio(&bench_perf), "msg");
+    }
+    fprintf(out, "}\n");
+    fclose(out);
+  }
+}
+
+void all_benches() {
+  printf("1 producer, %d consumers, %d messages of %d bytes, %ld CPUs online\n",
+         CONSUMERS, MESSAGES, MSG_SIZE, sysconf(_SC_NPROCESSORS_ONLN));
+
+  report("BroadcastRingBuffer 1P/4C", 1);
+  report("PosixRingBuffer per consumer 1P/4C", 0);
+}
+
+RUN_BENCHES(all_benches);
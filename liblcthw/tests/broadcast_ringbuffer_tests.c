@@ -0,0 +1,179 @@
+#include "minunit.h"
+#include <lcthw/broadcast_ringbuffer.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <string.h>
+
+#define CONSUMERS 3
+#define MESSAGES 200000
+
+char *test_fan_out() {
+  BroadcastRingBuffer *ring = BroadcastRingBuffer_create(4096, CONSUMERS, 0);
+  mu_assert(ring != NULL, "Failed to create the ring.");
+  mu_assert(BroadcastRingBuffer_create(4096, 0, 0) == NULL,
+            "A ring needs consumers.");
+
+  mu_assert(BroadcastRingBuffer_write(ring, "hello", 5) == 5,
+            "Failed to write.");
+  for (int i = 0; i < CONSUMERS; i++) {
+    char out[8] = {0};
+    mu_assert(BroadcastRingBuffer_available(ring, i) == 5,
+              "Every consumer should see the write.");
+    mu_assert(BroadcastRingBuffer_read(ring, i, out, sizeof(out)) == 5,
+              "Failed to read.");
+    mu_assert(strcmp(out, "hello") == 0, "Wrong bytes read.");
+    mu_assert(BroadcastRingBuffer_available(ring, i) == 0,
+              "Reading should only move this consumer.");
+  }
+
+  BroadcastRingBuffer_destroy(ring);
+  return NULL;
+}
+
+char *test_gated() {
+  BroadcastRingBuffer *ring = BroadcastRingBuffer_create(4096, CONSUMERS, 0);
+  char block[1024];
+  const char *data = NULL;
+  memset(block, 'x', sizeof(block));
+
+  // consumer 2 never reads, so the writer fills one ring and stops
+  for (int i = 0; i < 4; i++) {
+    mu_assert(BroadcastRingBuffer_write(ring, block, sizeof(block)) ==
+                  sizeof(block),
+              "Failed to fill the ring.");
+    BroadcastRingBuffer_read(ring, 0, block, sizeof(block));
+    BroadcastRingBuffer_read(ring, 1, block, sizeof(block));
+  }
+  mu_assert(BroadcastRingBuffer_write(ring, block, 1) == 0,
+            "The slowest consumer should gate the writer.");
+  mu_assert(BroadcastRingBuffer_wait_space(ring, 1, 10) == -1,
+            "Waiting for space should time out.");
+  mu_assert(BroadcastRingBuffer_write(ring, block, 4097) == -1,
+            "A write past the capacity can never fit.");
+
+  // it reads in place, and past the end of the buffer through the mirror
+  mu_assert(BroadcastRingBuffer_peek(ring, 2, &data) == 4096,
+            "Slowest consumer should see the whole ring.");
+  mu_assert(BroadcastRingBuffer_consume(ring, 2, 4097) == -1,
+            "Consuming more than was written should fail.");
+  mu_assert(BroadcastRingBuffer_consume(ring, 2, -1) == -1,
+            "Consuming a negative amount should fail.");
+  mu_assert(BroadcastRingBuffer_consume(ring, 2, 1000) == 1000,
+            "Failed to consume in place.");
+  mu_assert(BroadcastRingBuffer_write(ring, block, 1000) == 1000,
+            "Consuming should make room.");
+  mu_assert(BroadcastRingBuffer_peek(ring, 2, &data) == 4096 &&
+                data + 4096 > ring->buffer + ring->capacity,
+            "The view should run through the mirror.");
+
+  BroadcastRingBuffer_destroy(ring);
+  return NULL;
+}
+
+char *test_drop_slow() {
+  BroadcastRingBuffer *ring =
+      BroadcastRingBuffer_create(4096, CONSUMERS, BROADCAST_DROP_SLOW);
+  char block[1024];
+  const char *data = NULL;
+  memset(block, 'x', sizeof(block));
+
+  for (int i = 0; i < 4; i++) {
+    BroadcastRingBuffer_write(ring, block, sizeof(block));
+    BroadcastRingBuffer_read(ring, 0, block, sizeof(block));
+  }
+  // consumer 2 looks at its bytes in place while the writer laps it
+  mu_assert(BroadcastRingBuffer_peek(ring, 2, &data) == 4096,
+            "Consumer 2 should see the whole ring.");
+  mu_assert(BroadcastRingBuffer_write(ring, block, 100) == 100,
+            "The writer shouldn't wait for slow consumers.");
+
+  mu_assert(BroadcastRingBuffer_consume(ring, 2, 100) == -1,
+            "Consuming overwritten bytes should fail.");
+  mu_assert(BroadcastRingBuffer_available(ring, 1) == -1,
+            "Consumer 1 was a ring behind too.");
+  mu_assert(BroadcastRingBuffer_available(ring, 0) == 100,
+            "Consumer 0 kept up.");
+  mu_assert(BroadcastRingBuffer_wait_data(ring, 1, 1, -1) == -1,
+            "A dropped consumer has nothing to wait for.");
+
+  BroadcastRingBuffer_rejoin(ring, 1);
+  mu_assert(BroadcastRingBuffer_available(ring, 1) == 0,
+            "A rejoined consumer starts at the newest data.");
+  BroadcastRingBuffer_write(ring, "abc", 3);
+  mu_assert(BroadcastRingBuffer_read(ring, 1, block, sizeof(block)) == 3 &&
+                memcmp(block, "abc", 3) == 0,
+            "A rejoined consumer should read again.");
+
+  BroadcastRingBuffer_destroy(ring);
+  return NULL;
+}
+
+typedef struct {
+  BroadcastRingBuffer *ring;
+  int consumer;
+  int failed;
+} Reader;
+
+// Reads MESSAGES counters in whatever pieces they arrive in.
+static void *reader(void *arg) {
+  Reader *r = arg;
+  uint32_t value = 0;
+
+  for (uint32_t expect = 0; expect < MESSAGES; expect++) {
+    if (BroadcastRingBuffer_wait_data(r->ring, r->consumer, sizeof(value),
+                                      5000) < (int)sizeof(value) ||
+        BroadcastRingBuffer_read(r->ring, r->consumer, (char *)&value,
+                                 sizeof(value)) != sizeof(value) ||
+        value != expect) {
+      r->failed = 1;
+      break;
+    }
+  }
+  return NULL;
+}
+
+char *test_threads() {
+  BroadcastRingBuffer *ring = BroadcastRingBuffer_create(4096, CONSUMERS, 0);
+  pthread_t threads[CONSUMERS];
+  Reader readers[CONSUMERS];
+
+  for (int i = 0; i < CONSUMERS; i++) {
+    readers[i] = (Reader){ring, i, 0};
+    mu_assert(pthread_create(&threads[i], NULL, reader, &readers[i]) == 0,
+              "Failed to start a reader.");
+  }
+
+  uint32_t batch[5];
+  for (uint32_t next = 0; next < MESSAGES;) {
+    int count = 0;
+    while (count < 5 && next < MESSAGES) {
+      batch[count++] = next++;
+    }
+    int size = count * sizeof(uint32_t);
+    while (BroadcastRingBuffer_write(ring, (char *)batch, size) == 0) {
+      mu_assert(BroadcastRingBuffer_wait_space(ring, size, 5000) >= size,
+                "Readers stalled.");
+    }
+  }
+
+  for (int i = 0; i < CONSUMERS; i++) {
+    pthread_join(threads[i], NULL);
+    mu_assert(!readers[i].failed, "A reader lost track of the stream.");
+  }
+
+  BroadcastRingBuffer_destroy(ring);
+  return NULL;
+}
+
+char *all_tests() {
+  mu_suite_start();
+
+  mu_run_test(test_fan_out);
+  mu_run_test(test_gated);
+  mu_run_test(test_drop_slow);
+  mu_run_test(test_threads);
+
+  return NULL;
+}
+
+RUN_TESTS(all_tests);
@@ -0,0 +1,106 @@
+#include "bench.h"
+#include <lcthw/bstrlib.h>
+
+#define HAYSTACK_WORDS 1000
+
+static bstring word = NULL;
+static bstring other = NULL;
+static bstring haystack = NULL;
+static bstring needle = NULL;
+static bstring out = NULL;
+
+static void out_new(void *ctx, long iters) {
+  (void)ctx;
+  (void)iters;
+  out = bfromcstr("");
+}
+
+static void out_free(void *ctx) {
+  (void)ctx;
+  bdestroy(out);
+}
+
+static void run_bfromcstr(void *ctx, long iters) {
+  (void)ctx;
+  for (long i = 0; i < iters; i++) {
+    bstring b = bfromcstr("The quick brown fox jumps over the lazy dog");
+    bench_do_not_optimize(b);
+    bdestroy(b);
+  }
+}
+
+static void run_bconcat(void *ctx, long iters) {
+  (void)ctx;
+  for (long i = 0; i < iters; i++) {
+    bconcat(out, word);
+  }
+  bench_escape(out->data);
+}
+
+static void run_bstrcmp(void *ctx, long iters) {
+  (void)ctx;
+  int sum = 0;
+  for (long i = 0; i < iters; i++) {
+    sum += bstrcmp(word, other);
+    bench_clobber();
+  }
+  bench_do_not_optimize(sum);
+}
+
+static void run_binstr(void *ctx, long iters) {
+  (void)ctx;
+  int sum = 0;
+  for (long i = 0; i < iters; i++) {
+    sum += binstr(haystack, 0, needle);
+    bench_clobber();
+  }
+  bench_do_not_optimize(sum);
+}
+
+static void run_bsplit(void *ctx, long iters) {
+  (void)ctx;
+  for (long i = 0; i < iters; i++) {
+    struct bstrList *parts = bsplit(haystack, ' ');
+    bench_do_not_optimize(parts);
+    bstrListDestroy(parts);
+  }
+}
+
+static void run_bformat(void *ctx, long iters) {
+  (void)ctx;
+  for (long i = 0; i < iters; i++) {
+    bstring b = bformat("%ld: %s", i, bdata(word));
+    bench_do_not_optimize(b);
+    bdestroy(b);
+  }
+}
+
+void all_benches() {
+  word = bfromcstr("liblcthw-benchmark-word");
+  other = bfromcstr("liblcthw-benchmark-wore");
+  needle = bfromcstr("needle");
+
+  // the needle sits at the very end so binstr scans the whole haystack
+  haystack = bfromcstr("");
+  for (int i = 0; i < HAYSTACK_WORDS; i++) {
+    bformata(haystack, "word%d ", i);
+  }
+  bconcat(haystack, needle);
+
+  bench_run(.name = "bfromcstr+bdestroy", .run = run_bfromcstr);
+  bench_run(.name = "bconcat", .setup = out_new, .run = run_bconcat,
+            .teardown = out_free, .bytes_per_op = blength(word));
+  bench_run(.name = "bstrcmp", .run = run_bstrcmp);
+  bench_run(.name = "binstr/1000 words", .run = run_binstr,
+            .bytes_per_op = blength(haystack));
+  bench_run(.name = "bsplit/1000 words", .run = run_bsplit,
+            .bytes_per_op = blength(haystack));
+  bench_run(.name = "bformat", .run = run_bformat);
+
+  bdestroy(word);
+  bdestroy(other);
+  bdestroy(needle);
+  bdestroy(haystack);
+}
+
+RUN_BENCHES(all_benches);
@@ -0,0 +1,144 @@
+#include "minunit.h"
+#include <algorithm>
+#include <cstdint>
+#include <lcthw/bstring.hpp>
+#include <lcthw/darray.hpp>
+#include <lcthw/list.hpp>
+#include <lcthw/ringbuffer.hpp>
+#include <numeric>
+#include <string>
+
+using lcthw::BString;
+
+static_assert(lcthw::detail::ValueSlot<int64_t>::is_inline,
+              "int64_t should be stored in the slot.");
+static_assert(!lcthw::detail::ValueSlot<std::string>::is_inline,
+              "std::string must be boxed.");
+
+char *test_darray() {
+  lcthw::DArray<int64_t> array;
+
+  for (int64_t i = 0; i < 1000; i++) {
+    array.push_back((i * 7919) % 1000);
+  }
+  mu_assert(array.size() == 1000, "Wrong size.");
+
+  // the value is in the slot, not behind a pointer
+  int64_t raw = 0;
+  std::memcpy(&raw, &array.get()->contents[1], sizeof(raw));
+  mu_assert(raw == 7919 % 1000, "Value not stored inline.");
+
+  std::sort(array.begin(), array.end());
+  mu_assert(std::is_sorted(array.cbegin(), array.cend()), "Not sorted.");
+  mu_assert(array.front() == 0 && array.back() == 999, "Wrong ends.");
+  mu_assert(std::accumulate(array.begin(), array.end(), int64_t(0)) ==
+                999 * 1000 / 2,
+            "Wrong sum.");
+
+  lcthw::DArray<int64_t> moved(std::move(array));
+  mu_assert(moved.size() == 1000, "Move lost values.");
+  mu_assert(moved.pop_back() == 999, "Wrong pop.");
+
+  bool thrown = false;
+  try {
+    moved.at(5000);
+  } catch (const std::out_of_range &) {
+    thrown = true;
+  }
+  mu_assert(thrown, "at() should throw past the end.");
+
+  lcthw::DArray<std::string> strings = {"gamma", "alpha", "beta"};
+  std::sort(strings.begin(), strings.end());
+  mu_assert(strings[0] == "alpha" && strings[2] == "gamma",
+            "Boxed values not sorted.");
+  mu_assert(strings.pop_back() == "gamma", "Wrong boxed pop.");
+
+  return NULL;
+}
+
+char *test_list() {
+  lcthw::List<int> list = {3, 1, 2};
+
+  list.push_front(0);
+  list.emplace_back(4);
+  mu_assert(list.size() == 5, "Wrong size.");
+  mu_assert(list.front() == 0 && list.back() == 4, "Wrong ends.");
+  mu_assert(*std::max_element(list.begin(), list.end()) == 4, "Wrong max.");
+  mu_assert(*--list.end() == 4, "Can't step back from end().");
+
+  auto it = std::find(list.begin(), list.end(), 1);
+  mu_assert(it != list.end(), "find failed.");
+  it = list.erase(it);
+  mu_assert(*it == 2 && list.size() == 4, "Wrong erase.");
+
+  lcthw::List<int> tail = {5, 6};
+  list.splice(tail);
+  mu_assert(list.size() == 6 && tail.empty(), "Wrong splice.");
+  mu_assert(list.pop_back() == 6 && list.pop_front() == 0, "Wrong pops.");
+
+  lcthw::List<std::string> names;
+  names.push_back("b");
+  names.push_front("a");
+  lcthw::List<std::string> other = std::move(names);
+  mu_assert(other.pop_front() == "a" && other.front() == "b",
+            "Boxed list went wrong.");
+
+  return NULL;
+}
+
+char *test_bstring() {
+  BString s("hello");
+  std::string_view view = s;
+
+  mu_assert(view == "hello" && s.size() == 5, "Wrong view.");
+  mu_assert(std::strcmp(s.c_str(), "hello") == 0, "Wrong c_str.");
+
+  BString copy = s;
+  copy += ", world";
+  mu_assert(copy == "hello, world" && s == "hello", "Copy isn't deep.");
+
+  BString moved = std::move(copy);
+  mu_assert(moved == "hello, world" && copy.empty(), "Wrong move.");
+
+  std::transform(s.begin(), s.end(), s.begin(), ::toupper);
+  mu_assert(s == "HELLO", "Iterators can't write.");
+
+  BString adopted = BString::adopt(bfromcstr("raw"));
+  mu_assert(adopted.view() == "raw", "Wrong adopt.");
+  bstring raw = adopted.release();
+  mu_assert(adopted.get() == NULL, "Release kept the bstring.");
+  bdestroy(raw);
+
+  return NULL;
+}
+
+char *test_ringbuffer() {
+  lcthw::RingBuffer buffer(64);
+
+  mu_assert(buffer.empty(), "Should start empty.");
+  mu_assert(buffer.write("hello world") == 11, "Wrong write.");
+  mu_assert(buffer.size() == 11, "Wrong size.");
+
+  char out[5];
+  mu_assert(buffer.read(out, 5) == 5, "Wrong read.");
+  mu_assert(std::string_view(out, 5) == "hello", "Wrong data read.");
+
+  auto rest = buffer.gets(6);
+  mu_assert(rest && *rest == " world", "Wrong gets.");
+  mu_assert(!buffer.gets(1), "gets past the data should be empty.");
+
+  return NULL;
+}
+
+char *all_tests() {
+  mu_suite_start();
+
+  mu_run_test(test_darray);
+  mu_run_test(test_list);
+  mu_run_test(test_bstring);
+  mu_run_test(test_ringbuffer);
+
+  return NULL;
+}
+
+RUN_TESTS(all_tests);
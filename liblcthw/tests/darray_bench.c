@@ -0,0 +1,94 @@
+#include "bench.h"
+#include <lcthw/darray.h>
+
+static DArray *array = NULL;
+static long *indexes = NULL;
+
+static void array_new(void *ctx, long iters) {
+  (void)ctx;
+  (void)iters;
+  array = DArray_create(sizeof(long), DEFAULT_EXPAND_RATE);
+}
+
+static void array_filled(void *ctx, long iters) {
+  (void)ctx;
+  array = DArray_create(sizeof(long), DEFAULT_EXPAND_RATE);
+  for (long i = 0; i < iters; i++) {
+    DArray_push(array, (void *)i);
+  }
+}
+
+static void array_random_filled(void *ctx, long iters) {
+  array_filled(ctx, iters);
+
+  indexes = malloc(sizeof(long) * iters);
+  for (long i = 0; i < iters; i++) {
+    indexes[i] = rand() % iters;
+  }
+}
+
+static void array_free(void *ctx) {
+  (void)ctx;
+  // the contents are fake pointers, don't DArray_clear them
+  DArray_destroy(array);
+  free(indexes);
+  indexes = NULL;
+}
+
+static void run_push(void *ctx, long iters) {
+  (void)ctx;
+  for (long i = 0; i < iters; i++) {
+    DArray_push(array, (void *)i);
+  }
+}
+
+static void run_pop(void *ctx, long iters) {
+  (void)ctx;
+  for (long i = 0; i < iters; i++) {
+    void *val = DArray_pop(array);
+    bench_do_not_optimize(val);
+  }
+}
+
+static void run_get_sequential(void *ctx, long iters) {
+  (void)ctx;
+  long sum = 0;
+  for (long i = 0; i < iters; i++) {
+    sum += (long)DArray_get(array, i);
+  }
+  bench_do_not_optimize(sum);
+}
+
+static void run_get_random(void *ctx, long iters) {
+  (void)ctx;
+  long sum = 0;
+  for (long i = 0; i < iters; i++) {
+    sum += (long)DArray_get(array, indexes[i]);
+  }
+  bench_do_not_optimize(sum);
+}
+
+static void run_set(void *ctx, long iters) {
+  (void)ctx;
+  for (long i = 0; i < iters; i++) {
+    DArray_set(array, i, (void *)(i + 1));
+  }
+  bench_clobber();
+}
+
+void all_benches() {
+  srand(42);
+
+  bench_run(.name = "DArray_push", .setup = array_new, .run = run_push,
+            .teardown = array_free);
+  bench_run(.name = "DArray_pop", .setup = array_filled, .run = run_pop,
+            .teardown = array_free);
+  bench_run(.name = "DArray_get sequential", .setup = array_filled,
+            .run = run_get_sequential, .teardown = array_free);
+  bench_run(.name = "DArray_get random", .setup = array_random_filled,
+            .run = run_get_random, .teardown = array_free);
+  bench_run(.name = "DArray_set", .setup = array_filled, .run = run_set,
+            .teardown = array_free);
+}
+
+RUN_BENCHES(all_benches);
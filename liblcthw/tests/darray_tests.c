@@ -74,6 +74,10 @@ char *test_expand_contract()
     DArray_expand(array);
     mu_assert((unsigned int)array->max == old_max + array->expand_rate, "Wrong size after expand.");
 
+    mu_assert(DArray_resize(array, 1000) == 0, "Failed to resize.");
+    mu_assert(array->max == 1000, "Wrong size after resize.");
+    mu_assert(DArray_resize(array, array->end) == -1, "Should keep the slot past the end.");
+
     DArray_contract(array);
     mu_assert((unsigned int)array->max == array->expand_rate + 1, "Should stay at the expand_rate at least.");
 
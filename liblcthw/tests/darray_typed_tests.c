@@ -0,0 +1,101 @@
+#include "minunit.h"
+#include <lcthw/darray_typed.h>
+#include <stdint.h>
+
+DARRAY_DEFINE(I64Array, int64_t)
+
+typedef struct Point {
+  int x;
+  int y;
+} Point;
+
+DARRAY_DEFINE(PointArray, Point)
+STACK_DEFINE(I64Stack, int64_t)
+
+char *test_push_pop() {
+  I64Array *array = I64Array_create(1);
+  int64_t v = 0;
+
+  mu_assert(array != NULL, "Failed to create array.");
+  mu_assert(I64Array_create(0) == NULL, "Zero initial max should fail.");
+
+  // grows from a single slot
+  for (int64_t i = 0; i < 1000; i++) {
+    mu_assert(I64Array_push(array, i * i) == 0, "Push failed.");
+  }
+
+  mu_assert(I64Array_count(array) == 1000, "Wrong count after push.");
+  mu_assert(I64Array_get(array, 999) == 999 * 999, "Wrong value.");
+
+  I64Array_set(array, 0, -1);
+  mu_assert(I64Array_get(array, 0) == -1, "Set didn't stick.");
+
+  for (int64_t i = 999; i > 0; i--) {
+    mu_assert(I64Array_pop(array, &v) == 0 && v == i * i, "Wrong pop.");
+  }
+  mu_assert(I64Array_pop(array, &v) == 0 && v == -1, "Wrong last pop.");
+  mu_assert(I64Array_pop(array, &v) == -1, "Empty pop should fail.");
+
+  int64_t batch[300];
+  for (int i = 0; i < 300; i++) {
+    batch[i] = i;
+  }
+  mu_assert(I64Array_push_n(array, batch, 300) == 0, "push_n failed.");
+  mu_assert(I64Array_count(array) == 300, "Wrong count after push_n.");
+  mu_assert(I64Array_get(array, 299) == 299, "Wrong value after push_n.");
+
+  I64Array_destroy(array);
+
+  return NULL;
+}
+
+char *test_structs() {
+  PointArray *points = PointArray_create(4);
+
+  for (int i = 0; i < 10; i++) {
+    PointArray_push(points, (Point){i, -i});
+  }
+
+  Point p = {0, 0};
+  PointArray_pop(points, &p);
+  mu_assert(p.x == 9 && p.y == -9, "Structs stored by value.");
+  mu_assert(PointArray_get(points, 3).y == -3, "Wrong struct.");
+
+  PointArray_destroy(points);
+
+  return NULL;
+}
+
+char *test_stack() {
+  I64Stack *stack = I64Stack_create();
+  int64_t v = 0;
+
+  mu_assert(I64Stack_peek(stack, &v) == -1, "Empty stack peek.");
+
+  for (int64_t i = 0; i < 500; i++) {
+    I64Stack_push(stack, i);
+  }
+
+  mu_assert(I64Stack_count(stack) == 500, "Wrong stack count.");
+  mu_assert(I64Stack_peek(stack, &v) == 0 && v == 499, "Wrong top.");
+
+  for (int64_t i = 499; i >= 0; i--) {
+    mu_assert(I64Stack_pop(stack, &v) == 0 && v == i, "Wrong stack pop.");
+  }
+
+  I64Stack_destroy(stack);
+
+  return NULL;
+}
+
+char *all_tests() {
+  mu_suite_start();
+
+  mu_run_test(test_push_pop);
+  mu_run_test(test_structs);
+  mu_run_test(test_stack);
+
+  return NULL;
+}
+
+RUN_TESTS(all_tests);
@@ -0,0 +1,151 @@
+#include "minunit.h"
+#include <unistd.h>
+
+#define STORM 100000
+
+static char text[1 << 16];
+static char path[] = "/tmp/dbg_tests.XXXXXX";
+static int saved_stderr = -1;
+
+// Sends stderr to a temp file until captured() hands back what was written.
+static void capture() {
+  int fd = mkstemp(path);
+
+  fflush(stderr);
+  saved_stderr = dup(STDERR_FILENO);
+  dup2(fd, STDERR_FILENO);
+  close(fd);
+}
+
+static char *captured() {
+  FILE *in = fopen(path, "r");
+  size_t n = 0;
+
+#ifdef LCTHW_ASYNC_LOG
+  FastLog_flush();
+#endif
+  fflush(stderr);
+  dup2(saved_stderr, STDERR_FILENO);
+  close(saved_stderr);
+
+  if (in) {
+    n = fread(text, 1, sizeof(text) - 1, in);
+    fclose(in);
+  }
+  text[n] = '\0';
+
+  unlink(path);
+  strcpy(path, "/tmp/dbg_tests.XXXXXX");
+
+  return text;
+}
+
+static int count_lines(const char *s) {
+  int lines = 0;
+
+  for (; *s; s++) {
+    lines += *s == '\n';
+  }
+
+  return lines;
+}
+
+char *test_levels() {
+  capture();
+  dbg_set_log_level(LOG_LEVEL_WARN);
+  debug("hidden debug");
+  log_info("hidden info");
+  log_warn("shown warn");
+  log_err("shown err");
+  dbg_set_log_level(LOG_LEVEL_DEBUG);
+  log_info("shown info");
+  char *out = captured();
+
+  mu_assert(strstr(out, "hidden") == NULL, "Filtered levels were written.");
+  mu_assert(strstr(out, "[WARN]") && strstr(out, "shown warn\n"),
+            "Warn missing.");
+  mu_assert(strstr(out, "[ERROR]") && strstr(out, "shown err\n"),
+            "Err missing.");
+  mu_assert(strstr(out, "[INFO]") && strstr(out, "shown info\n"),
+            "Info missing after lowering the level.");
+
+  return NULL;
+}
+
+char *test_rate_limit() {
+  capture();
+  for (int i = 0; i < STORM; i++) {
+    log_err("storm %d", i);
+  }
+  char *out = captured();
+
+  // a second boundary in the middle lets one more burst and a summary out
+  int lines = count_lines(out);
+  mu_assert(lines >= LOG_RATE_BURST, "Too few messages got through.");
+  mu_assert(lines <= 2 * LOG_RATE_BURST + 1, "The storm wasn't limited.");
+  mu_assert(strstr(out, "storm 0\n") != NULL, "First message missing.");
+
+  return NULL;
+}
+
+char *test_suppressed_summary() {
+  DbgRateLimit limit = {.burst = LOG_RATE_BURST};
+  unsigned long suppressed = 0;
+  int allowed = 0;
+
+  for (int i = 0; i < LOG_RATE_BURST + 5; i++) {
+    allowed += dbg_rate_allow(&limit, &suppressed);
+  }
+  mu_assert(suppressed == 0, "Nothing to report yet.");
+
+  // pretend a second went by
+  unsigned long dropped = LOG_RATE_BURST + 5 - allowed;
+  limit.window--;
+
+  mu_assert(dbg_rate_allow(&limit, &suppressed), "New window should allow.");
+  mu_assert(suppressed == dropped, "Wrong suppressed count.");
+  mu_assert(limit.suppressed == 0, "Suppressed count not reset.");
+
+  // each site carries its own burst, 0 doesn't limit
+  DbgRateLimit unlimited = {.burst = 0};
+  for (int i = 0; i < LOG_RATE_BURST + 5; i++) {
+    mu_assert(dbg_rate_allow(&unlimited, &suppressed),
+              "A zero burst shouldn't limit.");
+  }
+
+  return NULL;
+}
+
+char *test_flush_pending() {
+  capture();
+  for (int i = 0; i < STORM; i++) {
+    log_warn("burst %d", i);
+  }
+  // the storm ends, no later message would carry the count
+  dbg_rate_flush();
+  char *out = captured();
+
+  mu_assert(strstr(out, "[WARN] (tests/dbg_tests.c:") != NULL,
+            "Flush should name the call site.");
+  mu_assert(strstr(out, "suppressed") != NULL, "Pending count not flushed.");
+
+  capture();
+  dbg_rate_flush();
+  mu_assert(strstr(captured(), "suppressed") == NULL,
+            "A flushed count was reported twice.");
+
+  return NULL;
+}
+
+char *all_tests() {
+  mu_suite_start();
+
+  mu_run_test(test_levels);
+  mu_run_test(test_rate_limit);
+  mu_run_test(test_suppressed_summary);
+  mu_run_test(test_flush_pending);
+
+  return NULL;
+}
+
+RUN_TESTS(all_tests);
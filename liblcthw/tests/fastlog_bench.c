@@ -0,0 +1,60 @@
+#define LCTHW_ASYNC_LOG 1
+#include "bench.h"
+#include <lcthw/dbg.h>
+#include <lcthw/fastlog.h>
+
+#define FLUSH_EVERY 1000
+
+static FILE *devnull = NULL;
+
+// what dbg.h used to do on every call
+static void run_fprintf(void *ctx, long iters) {
+  (void)ctx;
+  for (long i = 0; i < iters; i++) {
+    fprintf(devnull, "[INFO] (%s:%d) value %ld name %s\n", __FILE__, __LINE__,
+            i, "bench");
+  }
+}
+
+// the caller's cost only, once the ring is full this is the drop path
+static void run_fastlog(void *ctx, long iters) {
+  (void)ctx;
+  for (long i = 0; i < iters; i++) {
+    FASTLOG(FASTLOG_INFO, "value %ld name %s", i, "bench");
+  }
+}
+
+// an error storm through dbg.h, nearly every call is rate limited
+static void run_log_storm(void *ctx, long iters) {
+  (void)ctx;
+  for (long i = 0; i < iters; i++) {
+    log_info("value %ld name %s", i, "bench");
+  }
+}
+
+// caller plus the formatting, all on this thread
+static void run_fastlog_flushed(void *ctx, long iters) {
+  (void)ctx;
+  for (long i = 0; i < iters; i++) {
+    FASTLOG(FASTLOG_INFO, "value %ld name %s", i, "bench");
+    if (i % FLUSH_EVERY == FLUSH_EVERY - 1)
+      FastLog_flush();
+  }
+  FastLog_flush();
+}
+
+void all_benches() {
+  devnull = fopen("/dev/null", "w");
+  FastLog_set_output(devnull);
+
+  bench_run(.name = "fprintf log line", .run = run_fprintf);
+  bench_run(.name = "FASTLOG caller", .run = run_fastlog);
+  bench_run(.name = "FASTLOG caller + format (flush/1000)",
+            .run = run_fastlog_flushed);
+  bench_run(.name = "log_info storm (rate limited)", .run = run_log_storm);
+
+  FastLog_set_output(NULL);
+  fclose(devnull);
+}
+
+RUN_BENCHES(all_benches);
@@ -0,0 +1,177 @@
+#define LCTHW_ASYNC_LOG 1
+#include "minunit.h"
+#include <lcthw/fastlog.h>
+#include <pthread.h>
+#include <string.h>
+#include <unistd.h>
+
+#define FLOOD 100000
+#define THREAD_MSGS 1000
+
+static FILE *out = NULL;
+static FILE *in = NULL; // own offset, reads what `out` wrote
+static char text[1 << 16];
+
+// Everything logged since the last call, as text.
+static char *logged() {
+  FastLog_flush();
+  clearerr(in);
+
+  size_t n = fread(text, 1, sizeof(text) - 1, in);
+  text[n] = '\0';
+
+  return text;
+}
+
+static int count_lines() {
+  int lines = 0;
+  size_t n = 0;
+
+  FastLog_flush();
+  clearerr(in);
+  while ((n = fread(text, 1, sizeof(text), in)) > 0) {
+    for (size_t i = 0; i < n; i++) {
+      lines += text[i] == '\n';
+    }
+  }
+
+  return lines;
+}
+
+char *test_create() {
+  char path[] = "/tmp/fastlog_tests.XXXXXX";
+  int fd = mkstemp(path);
+  mu_assert(fd != -1, "Failed to make a temp file.");
+
+  out = fdopen(fd, "w");
+  in = fopen(path, "r");
+  unlink(path);
+  mu_assert(out != NULL && in != NULL, "Failed to open the temp file.");
+  FastLog_set_output(out);
+
+  return NULL;
+}
+
+char *test_destroy() {
+  FastLog_set_output(NULL);
+  fclose(out);
+  fclose(in);
+
+  return NULL;
+}
+
+char *test_format() {
+  errno = 0;
+  log_info("int %d long %ld hex %#06x str '%5s' %.2f %c 100%%", -7, 1L << 40,
+           255, "ab", 3.14159, 'z');
+
+  char *line = logged();
+  mu_assert(strstr(line, "[INFO] (tests/fastlog_tests.c:") != NULL,
+            "Wrong info prefix.");
+  mu_assert(strstr(line,
+                   ") int -7 long 1099511627776 hex 0x00ff str '   ab' "
+                   "3.14 z 100%\n") != NULL,
+            "Arguments formatted wrong.");
+
+  // strings are copied, later changes must not show
+  char name[] = "before";
+  errno = ENOENT;
+  log_err("name %s", name);
+  strcpy(name, "after!");
+  errno = 0;
+
+  line = logged();
+  mu_assert(strstr(line, "errno: No such file or directory) name before\n"),
+            "Error line wrong.");
+
+  log_warn("no args");
+  line = logged();
+  mu_assert(strstr(line, "[WARN] (") != NULL, "Wrong warn prefix.");
+  mu_assert(strstr(line, "errno: None) no args\n"), "Warn line wrong.");
+
+  return NULL;
+}
+
+char *test_sync_fallback() {
+  // '*' widths can't be captured, they are formatted on the spot
+  log_info("[%*d]", 6, 42);
+
+  char *line = logged();
+  mu_assert(strstr(line, "[    42]\n") != NULL, "Fallback formatted wrong.");
+
+  return NULL;
+}
+
+char *test_check() {
+  int *p = NULL;
+  check(p != NULL, "p was %p", (void *)p);
+  mu_assert(0, "check should have jumped.");
+
+error:
+  mu_assert(strstr(logged(), "[ERROR]") != NULL, "check didn't log.");
+  return NULL;
+}
+
+char *test_flood() {
+  logged(); // skip mu_run_test's banner
+  uint64_t dropped = FastLog_dropped();
+
+  // far more than a ring holds, nothing may block or be lost silently, this
+  // goes around log_info so dbg.h's rate limit doesn't thin it out first
+  for (int i = 0; i < FLOOD; i++) {
+    FASTLOG(FASTLOG_INFO, "flood %d", i);
+  }
+
+  int lines = count_lines();
+  dropped = FastLog_dropped() - dropped;
+
+  mu_assert(lines + dropped == FLOOD, "Lines and drops don't add up.");
+  mu_assert(lines > 0, "Nothing got through.");
+
+  return NULL;
+}
+
+static void *log_thread(void *arg) {
+  for (int i = 0; i < THREAD_MSGS; i++) {
+    FASTLOG(FASTLOG_INFO, "thread %ld msg %d", (long)arg, i);
+  }
+
+  return NULL;
+}
+
+char *test_threads() {
+  pthread_t threads[4];
+  logged();
+  uint64_t dropped = FastLog_dropped();
+
+  for (long i = 0; i < 4; i++) {
+    pthread_create(&threads[i], NULL, log_thread, (void *)i);
+  }
+
+  for (int i = 0; i < 4; i++) {
+    pthread_join(threads[i], NULL);
+  }
+
+  // the exited threads' rings are still drained
+  int lines = count_lines();
+  dropped = FastLog_dropped() - dropped;
+  mu_assert(lines + dropped == 4 * THREAD_MSGS, "Lost thread messages.");
+
+  return NULL;
+}
+
+char *all_tests() {
+  mu_suite_start();
+
+  mu_run_test(test_create);
+  mu_run_test(test_format);
+  mu_run_test(test_sync_fallback);
+  mu_run_test(test_check);
+  mu_run_test(test_flood);
+  mu_run_test(test_threads);
+  mu_run_test(test_destroy);
+
+  return NULL;
+}
+
+RUN_TESTS(all_tests);
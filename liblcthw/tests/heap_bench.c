@@ -0,0 +1,85 @@
+#include "bench.h"
+#include <lcthw/heap.h>
+#include <lcthw/list.h>
+#include <lcthw/list_algos.h>
+#include <stdlib.h>
+
+#define KEYS 100000
+
+static int keys[KEYS];
+static Heap *heap = NULL;
+static List *sorted = NULL;
+
+static int int_cmp(const void *a, const void *b) {
+  int x = *(const int *)a;
+  int y = *(const int *)b;
+  return (x > y) - (x < y);
+}
+
+static void heap_new(void *ctx, long iters) {
+  (void)iters;
+  heap = Heap_create(*(int *)ctx, int_cmp);
+}
+
+static void heap_free(void *ctx) {
+  (void)ctx;
+  Heap_destroy(heap);
+}
+
+// one op is a push of a random key plus, later, its pop
+static void run_heap(void *ctx, long iters) {
+  (void)ctx;
+  for (long i = 0; i < iters; i++) {
+    Heap_push(heap, &keys[i % KEYS]);
+  }
+  for (long i = 0; i < iters; i++) {
+    void *val = Heap_pop(heap);
+    bench_do_not_optimize(val);
+  }
+}
+
+static void list_new(void *ctx, long iters) {
+  (void)ctx;
+  (void)iters;
+  sorted = List_create();
+}
+
+static void list_free(void *ctx) {
+  (void)ctx;
+  List_destroy(sorted);
+}
+
+// the sorted List approach the heap replaces
+static void run_sorted_list(void *ctx, long iters) {
+  (void)ctx;
+  for (long i = 0; i < iters; i++) {
+    ListNode *node = calloc(1, sizeof(ListNode));
+    node->value = &keys[i % KEYS];
+    List_insert_sorted(sorted, node, int_cmp);
+  }
+  for (long i = 0; i < iters; i++) {
+    void *val = List_shift(sorted);
+    bench_do_not_optimize(val);
+  }
+}
+
+void all_benches() {
+  int arities[] = {2, 4, 8};
+  const char *names[] = {"2-ary Heap push+pop", "4-ary Heap push+pop",
+                         "8-ary Heap push+pop"};
+
+  srand(42);
+  for (int i = 0; i < KEYS; i++) {
+    keys[i] = rand();
+  }
+
+  for (int i = 0; i < 3; i++) {
+    bench_run(.name = names[i], .setup = heap_new, .run = run_heap,
+              .teardown = heap_free, .ctx = &arities[i]);
+  }
+
+  bench_run(.name = "sorted List insert+shift", .setup = list_new,
+            .run = run_sorted_list, .teardown = list_free);
+}
+
+RUN_BENCHES(all_benches);
@@ -0,0 +1,133 @@
+#include "minunit.h"
+#include <lcthw/heap.h>
+#include <stdlib.h>
+
+#define NUM_VALUES 1000
+
+static Heap *heap = NULL;
+static int values[NUM_VALUES];
+static HeapNode *handles[NUM_VALUES];
+
+static int int_cmp(const void *a, const void *b) {
+  int x = *(const int *)a;
+  int y = *(const int *)b;
+  return (x > y) - (x < y);
+}
+
+char *test_create() {
+  heap = Heap_create(HEAP_DEFAULT_ARITY, int_cmp);
+  mu_assert(heap != NULL, "Failed to create heap.");
+  mu_assert(Heap_count(heap) == 0, "Heap should be empty.");
+  mu_assert(Heap_peek(heap) == NULL, "Empty heap should peek NULL.");
+  mu_assert(Heap_pop(heap) == NULL, "Empty heap should pop NULL.");
+
+  mu_assert(Heap_create(1, int_cmp) == NULL, "Arity 1 should be rejected.");
+
+  return NULL;
+}
+
+char *test_destroy() {
+  Heap_destroy(heap);
+
+  return NULL;
+}
+
+char *test_push_pop() {
+  srand(7);
+
+  for (int i = 0; i < NUM_VALUES; i++) {
+    values[i] = rand() % 500;
+    handles[i] = Heap_push(heap, &values[i]);
+    mu_assert(handles[i] != NULL, "Push failed.");
+  }
+
+  mu_assert(Heap_count(heap) == NUM_VALUES, "Wrong count after push.");
+
+  int prev = -1;
+  for (int i = 0; i < NUM_VALUES; i++) {
+    int *val = Heap_peek(heap);
+    mu_assert(val == Heap_pop(heap), "Peek and pop disagree.");
+    mu_assert(*val >= prev, "Values popped out of order.");
+    prev = *val;
+  }
+
+  mu_assert(Heap_count(heap) == 0, "Wrong count after pop.");
+
+  return NULL;
+}
+
+char *test_update_remove() {
+  for (int i = 0; i < NUM_VALUES; i++) {
+    values[i] = 1000 + i;
+    handles[i] = Heap_push(heap, &values[i]);
+  }
+
+  // decrease-key: the last value jumps to the top
+  values[NUM_VALUES - 1] = 0;
+  mu_assert(Heap_update(heap, handles[NUM_VALUES - 1]) == 0, "Update failed.");
+  mu_assert(Heap_peek(heap) == &values[NUM_VALUES - 1],
+            "Decreased key should be on top.");
+
+  // increase-key: it sinks again
+  values[NUM_VALUES - 1] = 5000;
+  Heap_update(heap, handles[NUM_VALUES - 1]);
+  mu_assert(Heap_peek(heap) == &values[0], "Smallest should be back on top.");
+
+  // remove every odd value from the middle of the heap
+  for (int i = 1; i < NUM_VALUES; i += 2) {
+    mu_assert(Heap_remove(heap, handles[i]) == &values[i],
+              "Removed the wrong value.");
+  }
+
+  mu_assert(Heap_count(heap) == NUM_VALUES / 2, "Wrong count after remove.");
+
+  for (int i = 0; i < NUM_VALUES; i += 2) {
+    mu_assert(Heap_pop(heap) == &values[i], "Wrong order after remove.");
+  }
+
+  return NULL;
+}
+
+char *test_from_array() {
+  void *ptrs[NUM_VALUES];
+
+  for (int arity = 2; arity <= 8; arity++) {
+    for (int i = 0; i < NUM_VALUES; i++) {
+      values[i] = rand() % 100;
+      ptrs[i] = &values[i];
+    }
+
+    Heap *h = Heap_from_array(ptrs, NUM_VALUES, arity, int_cmp);
+    mu_assert(h != NULL, "Failed to heapify.");
+    mu_assert(Heap_count(h) == NUM_VALUES, "Wrong count after heapify.");
+
+    int prev = -1;
+    while (Heap_count(h) > 0) {
+      int *val = Heap_pop(h);
+      mu_assert(*val >= prev, "Heapified values out of order.");
+      prev = *val;
+    }
+
+    Heap_destroy(h);
+  }
+
+  Heap *empty = Heap_from_array(NULL, 0, HEAP_DEFAULT_ARITY, int_cmp);
+  mu_assert(empty != NULL && Heap_count(empty) == 0, "Empty heapify failed.");
+  Heap_destroy(empty);
+
+  return NULL;
+}
+
+char *all_tests() {
+  mu_suite_start();
+
+  mu_run_test(test_create);
+  mu_run_test(test_push_pop);
+  mu_run_test(test_update_remove);
+  mu_run_test(test_from_array);
+  mu_run_test(test_destroy);
+
+  return NULL;
+}
+
+RUN_TESTS(all_tests);
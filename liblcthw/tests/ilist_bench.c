@@ -0,0 +1,165 @@
+#include "bench.h"
+#include <lcthw/ilist.h>
+#include <lcthw/list.h>
+#include <lcthw/list_algos.h>
+#include <stdlib.h>
+
+#define ITEMS 1000000
+#define SORT_ITEMS 10000
+
+typedef struct Item {
+  long key;
+  IListNode link;
+} Item;
+
+static Item *items = NULL;
+static IList ilist;
+static List *list = NULL;
+
+static IList *ilists = NULL;
+static List **lists = NULL;
+static long lists_count = 0;
+
+static int item_cmp(const IListNode *a, const IListNode *b) {
+  long x = IList_entry(a, Item, link)->key;
+  long y = IList_entry(b, Item, link)->key;
+  return (x > y) - (x < y);
+}
+
+static int value_cmp(const void *a, const void *b) {
+  long x = ((const Item *)a)->key;
+  long y = ((const Item *)b)->key;
+  return (x > y) - (x < y);
+}
+
+static void both_new(void *ctx, long iters) {
+  (void)ctx;
+  (void)iters;
+  IList_init(&ilist);
+  list = List_create();
+}
+
+// a node can only be linked once, past ITEMS the runs walk the lists again
+static void both_filled(void *ctx, long iters) {
+  (void)ctx;
+  IList_init(&ilist);
+  list = List_create();
+  for (long i = 0; i < iters && i < ITEMS; i++) {
+    IList_push(&ilist, &items[i % ITEMS].link);
+    List_push(list, &items[i % ITEMS]);
+  }
+}
+
+static void both_free(void *ctx) {
+  (void)ctx;
+  List_destroy(list);
+}
+
+static void run_ilist_push(void *ctx, long iters) {
+  (void)ctx;
+  for (long i = 0; i < iters; i++) {
+    IList_push(&ilist, &items[i % ITEMS].link);
+  }
+}
+
+static void run_list_push(void *ctx, long iters) {
+  (void)ctx;
+  for (long i = 0; i < iters; i++) {
+    List_push(list, &items[i % ITEMS]);
+  }
+}
+
+static void run_ilist_foreach(void *ctx, long iters) {
+  (void)ctx;
+  long sum = 0;
+  for (long done = 0; done < iters; done += IList_count(&ilist)) {
+    ILIST_FOREACH_ENTRY(&ilist, Item, link, cur) { sum += cur->key; }
+  }
+  bench_do_not_optimize(sum);
+}
+
+static void run_list_foreach(void *ctx, long iters) {
+  (void)ctx;
+  long sum = 0;
+  for (long done = 0; done < iters; done += List_count(list)) {
+    LIST_FOREACH(list, first, next, cur) { sum += ((Item *)cur->value)->key; }
+  }
+  bench_do_not_optimize(sum);
+}
+
+// ---- sorts, one op is sorting a whole list of SORT_ITEMS --------------------
+
+static void lists_setup(void *ctx, long iters) {
+  (void)ctx;
+  lists_count = iters;
+  ilists = calloc(iters, sizeof(IList));
+  lists = calloc(iters, sizeof(List *));
+
+  // each IList needs its own nodes, so every op sorts a fresh copy
+  for (long i = 0; i < iters; i++) {
+    Item *copy = malloc(sizeof(Item) * SORT_ITEMS);
+    IList_init(&ilists[i]);
+    lists[i] = List_create();
+
+    for (long j = 0; j < SORT_ITEMS; j++) {
+      copy[j].key = items[j].key;
+      IList_push(&ilists[i], &copy[j].link);
+      List_push(lists[i], &copy[j]);
+    }
+  }
+}
+
+static void lists_teardown(void *ctx) {
+  (void)ctx;
+  for (long i = 0; i < lists_count; i++) {
+    Item *min = NULL;
+    ILIST_FOREACH_ENTRY(&ilists[i], Item, link, cur) {
+      if (min == NULL || cur < min)
+        min = cur;
+    }
+    free(min);
+    List_destroy(lists[i]);
+  }
+
+  free(ilists);
+  free(lists);
+}
+
+static void run_ilist_sort(void *ctx, long iters) {
+  (void)ctx;
+  for (long i = 0; i < iters; i++) {
+    IList_merge_sort(&ilists[i], item_cmp);
+  }
+}
+
+static void run_list_sort(void *ctx, long iters) {
+  (void)ctx;
+  for (long i = 0; i < iters; i++) {
+    List_merge_sort_bottom_up(lists[i], value_cmp);
+  }
+}
+
+void all_benches() {
+  srand(42);
+  items = malloc(sizeof(Item) * ITEMS);
+  for (long i = 0; i < ITEMS; i++) {
+    items[i].key = rand();
+  }
+
+  bench_run(.name = "IList_push", .setup = both_new, .run = run_ilist_push,
+            .teardown = both_free);
+  bench_run(.name = "List_push", .setup = both_new, .run = run_list_push,
+            .teardown = both_free);
+  bench_run(.name = "ILIST_FOREACH_ENTRY (per node)", .setup = both_filled,
+            .run = run_ilist_foreach, .teardown = both_free);
+  bench_run(.name = "LIST_FOREACH + value (per node)", .setup = both_filled,
+            .run = run_list_foreach, .teardown = both_free);
+  bench_run(.name = "IList_merge_sort/10000", .setup = lists_setup,
+            .run = run_ilist_sort, .teardown = lists_teardown);
+  bench_run(.name = "List_merge_sort_bottom_up/10000", .setup = lists_setup,
+            .run = run_list_sort, .teardown = lists_teardown);
+
+  free(items);
+}
+
+RUN_BENCHES(all_benches);
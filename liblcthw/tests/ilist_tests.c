@@ -0,0 +1,165 @@
+#include "minunit.h"
+#include <lcthw/ilist.h>
+#include <stdlib.h>
+
+#define NUM_ITEMS 1000
+
+typedef struct Item {
+  int key;
+  int order; // Position before sorting, to check stability.
+  IListNode link;
+} Item;
+
+static IList list;
+static Item items[NUM_ITEMS];
+
+static int item_cmp(const IListNode *a, const IListNode *b) {
+  int x = IList_entry(a, Item, link)->key;
+  int y = IList_entry(b, Item, link)->key;
+  return (x > y) - (x < y);
+}
+
+// Walks both ways and checks the links agree with the count.
+static int consistent(IList *l) {
+  int n = 0;
+  IListNode *prev = NULL;
+
+  for (IListNode *cur = l->first; cur != NULL; cur = cur->next) {
+    if (cur->prev != prev)
+      return 0;
+    prev = cur;
+    n++;
+  }
+
+  return n == l->count && l->last == prev;
+}
+
+char *test_push_pop() {
+  IList_init(&list);
+  mu_assert(IList_pop(&list) == NULL, "Empty list should pop NULL.");
+  mu_assert(IList_shift(&list) == NULL, "Empty list should shift NULL.");
+
+  for (int i = 0; i < NUM_ITEMS; i++) {
+    items[i].key = i;
+    IList_push(&list, &items[i].link);
+  }
+
+  mu_assert(IList_count(&list) == NUM_ITEMS, "Wrong count after push.");
+  mu_assert(consistent(&list), "Links broken after push.");
+  mu_assert(IList_entry(IList_first(&list), Item, link) == &items[0],
+            "Wrong first entry.");
+
+  for (int i = NUM_ITEMS - 1; i >= 0; i--) {
+    IListNode *node = IList_pop(&list);
+    mu_assert(IList_entry(node, Item, link)->key == i, "Wrong pop order.");
+  }
+
+  mu_assert(IList_count(&list) == 0, "Wrong count after pop.");
+
+  for (int i = 0; i < NUM_ITEMS; i++) {
+    IList_unshift(&list, &items[i].link);
+  }
+
+  for (int i = NUM_ITEMS - 1; i >= 0; i--) {
+    IListNode *node = IList_shift(&list);
+    mu_assert(IList_entry(node, Item, link)->key == i, "Wrong shift order.");
+  }
+
+  mu_assert(list.first == NULL && list.last == NULL, "List should be empty.");
+
+  return NULL;
+}
+
+char *test_remove_insert() {
+  IList_init(&list);
+  for (int i = 0; i < NUM_ITEMS; i++) {
+    items[i].key = i;
+    IList_push(&list, &items[i].link);
+  }
+
+  // removing while iterating, given only the element
+  ILIST_FOREACH_ENTRY(&list, Item, link, cur) {
+    if (cur->key % 2) {
+      IList_remove(&list, &cur->link);
+    }
+  }
+
+  mu_assert(IList_count(&list) == NUM_ITEMS / 2, "Wrong count after remove.");
+  mu_assert(consistent(&list), "Links broken after remove.");
+
+  IList_remove(&list, &items[0].link);
+  IList_remove(&list, &items[NUM_ITEMS - 2].link);
+  mu_assert(consistent(&list), "Links broken removing the ends.");
+
+  // put the odd ones back after their even neighbour, where it's still there
+  for (int i = 1; i < NUM_ITEMS - 3; i += 2) {
+    IList_insert_after(&list, &items[i + 1].link, &items[i].link);
+  }
+  IList_insert_after(&list, IList_last(&list), &items[NUM_ITEMS - 1].link);
+
+  mu_assert(consistent(&list), "Links broken after insert.");
+  mu_assert(IList_last(&list) == &items[NUM_ITEMS - 1].link,
+            "Insert after last should update last.");
+
+  int n = 0;
+  ILIST_FOREACH(&list, last, prev, cur) { n++; }
+  mu_assert(n == IList_count(&list), "Reverse walk missed nodes.");
+
+  return NULL;
+}
+
+char *test_merge_sort() {
+  srand(42);
+  IList_init(&list);
+
+  for (int i = 0; i < NUM_ITEMS; i++) {
+    items[i].key = rand() % 100; // lots of ties
+    items[i].order = i;
+    IList_push(&list, &items[i].link);
+  }
+
+  IList_merge_sort(&list, item_cmp);
+
+  mu_assert(IList_count(&list) == NUM_ITEMS, "Sort lost nodes.");
+  mu_assert(consistent(&list), "Links broken after sort.");
+
+  Item *prev = NULL;
+  ILIST_FOREACH_ENTRY(&list, Item, link, cur) {
+    if (prev) {
+      mu_assert(prev->key <= cur->key, "Not sorted.");
+      mu_assert(prev->key < cur->key || prev->order < cur->order,
+                "Sort isn't stable.");
+    }
+    prev = cur;
+  }
+
+  // sizes that aren't a power of two, and trivial ones
+  for (int n = 0; n < 40; n++) {
+    IList_init(&list);
+    for (int i = 0; i < n; i++) {
+      items[i].key = n - i;
+      IList_push(&list, &items[i].link);
+    }
+
+    IList_merge_sort(&list, item_cmp);
+    mu_assert(consistent(&list), "Links broken sorting a short list.");
+    if (n > 0) {
+      mu_assert(IList_entry(IList_first(&list), Item, link)->key == 1,
+                "Short list not sorted.");
+    }
+  }
+
+  return NULL;
+}
+
+char *all_tests() {
+  mu_suite_start();
+
+  mu_run_test(test_push_pop);
+  mu_run_test(test_remove_insert);
+  mu_run_test(test_merge_sort);
+
+  return NULL;
+}
+
+RUN_TESTS(all_tests);
@@ -7,7 +7,6 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
-#include <time.h>
 
 char *values[] = {"XXXX", "1234", "abcd", "xjvef", "NDSS"};
 #define NUM_VALUES 5
@@ -45,7 +44,6 @@ char *gen_rand_len_str(size_t min_eq_len, size_t max_eq_len) {
   return gen_rand_str(rand_len);
 }
 
-#define LOTS_WORDS_COUNT 51200
 #define MIN_RAND_STR_LEN 16
 #define MAX_RAND_STR_LEN 64
 List *create_lots_words(unsigned long long count) {
@@ -105,14 +103,13 @@ char *test_bubble_sort() {
 char *test_merge_sort() {
   List *words = create_words();
 
-  // should work on a list that needs sorting
+  // should work on a list that needs sorting, in place
   List *res = List_merge_sort(words, (List_compare)strcmp);
+  mu_assert(res == words, "Merge sort should sort in place.");
   mu_assert(is_sorted(res), "Words are not sorted after merge sort.");
 
   List *res2 = List_merge_sort(res, (List_compare)strcmp);
-  mu_assert(is_sorted(res), "Should still be sorted after merge sort.");
-  List_destroy(res2);
-  List_destroy(res);
+  mu_assert(is_sorted(res2), "Should still be sorted after merge sort.");
 
   List_destroy(words);
 
@@ -121,158 +118,219 @@ char *test_merge_sort() {
   mu_assert(is_sorted(sorted), "Words are not sorted after merge sort.");
 
   List_clear_destroy(lots_words);
-  List_destroy(sorted);
 
   List *lots_words2 = create_lots_words(10240);
   List *sorted2 = List_merge_sort_bottom_up(lots_words2, (List_compare)strcmp);
   mu_assert(is_sorted(sorted2), "Words are not sorted after merge sort.");
 
   // the bottom up merge sort do NOT allocate new nodes.
-  // List_clear_destroy(sorted2);
+  List_clear_destroy(sorted2);
 
   return NULL;
 }
 
-// answer
-static void ListNode_swap(ListNode *a, ListNode *b) {
-  void *temp = a->value;
-  a->value = b->value;
-  b->value = temp;
-}
+typedef struct Keyed {
+  int key;
+  int order; // Position before sorting, to check stability.
+} Keyed;
 
-int List_bubble_sort_ans(List *list, List_compare cmp) {
-  int sorted = 1;
+static int keyed_cmp(const void *a, const void *b) {
+  int x = ((const Keyed *)a)->key;
+  int y = ((const Keyed *)b)->key;
+  return (x > y) - (x < y);
+}
 
-  if (List_count(list) <= 1) {
-    return 0; // already sorted
+enum {
+  SHAPE_RANDOM,
+  SHAPE_SORTED,
+  SHAPE_REVERSED,
+  SHAPE_FEW_UNIQUE,
+  SHAPE_SAWTOOTH,
+  SHAPE_MAX
+};
+
+static int shape_key(int shape, int i, int n) {
+  switch (shape) {
+  case SHAPE_SORTED:
+    return i;
+  case SHAPE_REVERSED:
+    return n - i;
+  case SHAPE_FEW_UNIQUE:
+    return rand() % 4;
+  case SHAPE_SAWTOOTH:
+    return i % 100;
+  default:
+    return rand();
   }
+}
 
-  do {
-    sorted = 1;
-    LIST_FOREACH(list, first, next, cur) {
-      if (cur->next) {
-        if (cmp(cur->value, cur->next->value) > 0) {
-          ListNode_swap(cur, cur->next);
-          sorted = 0;
-        }
-      }
+static int sorted_and_stable(List *list) {
+  ListNode *prev = NULL;
+  int n = 0;
+
+  LIST_FOREACH(list, first, next, cur) {
+    if (cur->prev != prev)
+      return 0;
+
+    if (prev) {
+      Keyed *a = prev->value;
+      Keyed *b = cur->value;
+      if (a->key > b->key || (a->key == b->key && a->order > b->order))
+        return 0;
     }
-  } while (!sorted);
 
-  return 0;
+    prev = cur;
+    n++;
+  }
+
+  return n == List_count(list) && list->last == prev;
 }
 
-// answer
-static List *List_merge_ans(List *left, List *right, List_compare cmp) {
-  List *result = List_create();
-  void *val = NULL;
-
-  while (List_count(left) > 0 || List_count(right) > 0) {
-    if (List_count(left) > 0 && List_count(right) > 0) {
-      if (cmp(List_first(left), List_first(right)) <= 0) {
-        val = List_shift(left);
-      } else {
-        val = List_shift(right);
+char *test_sort() {
+  const int sizes[] = {0, 1, 2, 3, 7, 64, 1000, 20000};
+  Keyed *keyed = malloc(sizeof(Keyed) * 20000);
+
+  for (int shape = 0; shape < SHAPE_MAX; shape++) {
+    for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+      List *list = List_create();
+
+      for (int i = 0; i < sizes[s]; i++) {
+        keyed[i].key = shape_key(shape, i, sizes[s]);
+        keyed[i].order = i;
+        List_push(list, &keyed[i]);
+      }
+
+      int rc = List_sort(list, keyed_cmp);
+      mu_assert(rc == 0, "List_sort failed.");
+      mu_assert(sorted_and_stable(list), "List_sort result is wrong.");
+
+      // the prefetching variant must sort the same input the same way
+      List_destroy(list);
+      list = List_create();
+      for (int i = 0; i < sizes[s]; i++) {
+        keyed[i].key = shape_key(shape, i, sizes[s]);
+        keyed[i].order = i;
+        List_push(list, &keyed[i]);
       }
 
-      List_push(result, val);
-    } else if (List_count(left) > 0) {
-      val = List_shift(left);
-      List_push(result, val);
-    } else if (List_count(right) > 0) {
-      val = List_shift(right);
-      List_push(result, val);
+      rc = List_sort_prefetch(list, keyed_cmp);
+      mu_assert(rc == 0, "List_sort_prefetch failed.");
+      mu_assert(sorted_and_stable(list), "List_sort_prefetch result is wrong.");
+
+      List_destroy(list);
     }
   }
 
-  return result;
+  free(keyed);
+
+  return NULL;
 }
 
-List *List_merge_sort_ans(List *list, List_compare cmp) {
-  if (List_count(list) <= 1) {
-    return list;
-  }
+typedef struct Record {
+  uint64_t stamp;
+  bstring name;
+  int order;
+} Record;
 
-  List *left = List_create();
-  List *right = List_create();
-  int middle = List_count(list) / 2;
+static uint64_t record_stamp(const void *value) {
+  return ((const Record *)value)->stamp;
+}
 
-  LIST_FOREACH(list, first, next, cur) {
-    if (middle > 0) {
-      List_push(left, cur->value);
-    } else {
-      List_push(right, cur->value);
-    }
+static bstring record_name(const void *value) {
+  return ((const Record *)value)->name;
+}
 
-    middle--;
+char *test_radix_sort() {
+  const int count = 20000;
+  Record *records = malloc(sizeof(Record) * count);
+  List *list = List_create();
+
+  // timestamps close together plus a few far out, with duplicates
+  for (int i = 0; i < count; i++) {
+    records[i].stamp = 1700000000000000000ULL + rand() % 5000;
+    if (i % 1000 == 0)
+      records[i].stamp = (uint64_t)rand() << 40;
+    records[i].order = i;
+    records[i].name = NULL;
+    List_push(list, &records[i]);
   }
 
-  List *sort_left = List_merge_sort_ans(left, cmp);
-  List *sort_right = List_merge_sort_ans(right, cmp);
+  mu_assert(List_radix_sort_u64(list, record_stamp) == 0, "u64 radix failed.");
+
+  ListNode *prev = NULL;
+  for (ListNode *cur = list->first; cur != NULL; cur = cur->next) {
+    mu_assert(cur->prev == prev, "u64 radix broke the prev links.");
+    if (prev) {
+      Record *a = prev->value;
+      Record *b = cur->value;
+      mu_assert(a->stamp < b->stamp ||
+                    (a->stamp == b->stamp && a->order < b->order),
+                "u64 radix out of order or unstable.");
+    }
+    prev = cur;
+  }
+  mu_assert(list->last == prev, "u64 radix broke last.");
+  List_destroy(list);
+
+  // names with shared prefixes, empty ones, long ones and high bytes
+  list = List_create();
+  for (int i = 0; i < count; i++) {
+    char buf[128];
+    int len = 0;
+
+    switch (i % 4) {
+    case 0:
+      len = snprintf(buf, sizeof(buf), "user-%d", rand() % 3000);
+      break;
+    case 1:
+      len = snprintf(buf, sizeof(buf), "%.*s%d", 90,
+                     "shared-prefix-shared-prefix-shared-prefix-shared-prefix-"
+                     "shared-prefix-shared-prefix-shared",
+                     rand() % 100);
+      break;
+    case 2:
+      len = rand() % 3;
+      memset(buf, 'a', len);
+      break;
+    default:
+      len = 1 + rand() % 8;
+      for (int j = 0; j < len; j++) {
+        buf[j] = (char)(rand() % 256);
+      }
+    }
 
-  if (sort_left != left)
-    List_destroy(left);
-  if (sort_right != right)
-    List_destroy(right);
+    records[i].name = blk2bstr(buf, len);
+    records[i].order = i;
+    List_push(list, &records[i]);
+  }
 
-  return List_merge_ans(sort_left, sort_right, cmp);
-}
+  mu_assert(List_radix_sort_bstr(list, record_name) == 0, "bstr radix failed.");
+  mu_assert(List_count(list) == count, "bstr radix lost nodes.");
+
+  prev = NULL;
+  for (ListNode *cur = list->first; cur != NULL; cur = cur->next) {
+    mu_assert(cur->prev == prev, "bstr radix broke the prev links.");
+    if (prev) {
+      bstring a = ((Record *)prev->value)->name;
+      bstring b = ((Record *)cur->value)->name;
+      int n = a->slen < b->slen ? a->slen : b->slen;
+      int rc = memcmp(a->data, b->data, n);
+      if (rc == 0)
+        rc = (a->slen > b->slen) - (a->slen < b->slen);
+
+      mu_assert(rc < 0 || (rc == 0 && ((Record *)prev->value)->order <
+                                           ((Record *)cur->value)->order),
+                "bstr radix out of order or unstable.");
+    }
+    prev = cur;
+  }
+  mu_assert(list->last == prev, "bstr radix broke last.");
 
-char *test_performance() {
-  List *words_my_bubble = create_lots_words(LOTS_WORDS_COUNT);
-  List *words_my_merge = List_duplicate(words_my_bubble);
-  List *words_my_merge_btm = List_duplicate(words_my_bubble);
-  List *words_ans_bubble = List_duplicate(words_my_bubble);
-  List *words_ans_merge = List_duplicate(words_my_bubble);
-
-  List *ret = NULL;
-  clock_t start, end;
-  double cpu_time_used = 0;
-
-  start = clock();
-  List_bubble_sort(words_my_bubble, (List_compare)strcmp);
-  end = clock();
-  cpu_time_used = ((double)end - start) / CLOCKS_PER_SEC;
-  // 26.338744
-  printf("My bubble sort execution time: %.6f seconds\n", cpu_time_used);
-
-  start = clock();
-  List_bubble_sort_ans(words_ans_bubble, (List_compare)strcmp);
-  end = clock();
-  cpu_time_used = ((double)end - start) / CLOCKS_PER_SEC;
-  // 49.355409
-  printf("Ans bubble sort execution time: %.6f seconds\n", cpu_time_used);
-
-  start = clock();
-  ret = List_merge_sort(words_my_merge, (List_compare)strcmp);
-  end = clock();
-  cpu_time_used = ((double)end - start) / CLOCKS_PER_SEC;
-  // 0.100301
-  printf("My merge sort execution time: %.6f seconds\n", cpu_time_used);
-  List_destroy(ret);
-
-  start = clock();
-  ret = List_merge_sort_bottom_up(words_my_merge_btm, (List_compare)strcmp);
-  end = clock();
-  cpu_time_used = ((double)end - start) / CLOCKS_PER_SEC;
-  // 0.040414
-  printf("My bottom up merge sort execution time: %.6f seconds\n",
-         cpu_time_used);
-  List_destroy(ret);
-
-  start = clock();
-  ret = List_merge_sort_ans(words_ans_merge, (List_compare)strcmp);
-  end = clock();
-  cpu_time_used = ((double)end - start) / CLOCKS_PER_SEC;
-  // 0.115535
-  printf("Ans merge sort execution time: %.6f seconds\n", cpu_time_used);
-  List_clear_destroy(ret);
-
-  // TODO: our `List_duplicate` is shallow copy, so we can NOT free the value by following
-  // way. List_clear_destroy(words_my_bubble);
-  // List_clear_destroy(words_my_merge);
-  // List_clear_destroy(words_ans_bubble);
-  // List_clear_destroy(words_ans_merge);
+  for (int i = 0; i < count; i++) {
+    bdestroy(records[i].name);
+  }
+  List_destroy(list);
+  free(records);
 
   return NULL;
 }
@@ -282,7 +340,8 @@ char *all_tests() {
 
   mu_run_test(test_bubble_sort);
   mu_run_test(test_merge_sort);
-  mu_run_test(test_performance);
+  mu_run_test(test_sort);
+  mu_run_test(test_radix_sort);
 
   return NULL;
 }
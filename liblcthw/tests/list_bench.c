@@ -0,0 +1,505 @@
+#include "bench.h"
+#include <lcthw/list.h>
+#include <lcthw/list_algos.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define SORT_WORDS 10000
+#define BUBBLE_WORDS 1000
+#define MIN_RAND_STR_LEN 16
+#define MAX_RAND_STR_LEN 64
+
+static List *list = NULL;
+static List *words = NULL;
+static List **lists = NULL;
+static List **sorted = NULL;
+static long lists_count = 0;
+static int sort_size = 0;
+
+static char *gen_rand_str(size_t length) {
+  const char charset[] =
+      "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789";
+  char *str = malloc(length + 1);
+
+  for (size_t i = 0; i < length; i++) {
+    str[i] = charset[rand() % (sizeof(charset) - 1)];
+  }
+  str[length] = '\0';
+
+  return str;
+}
+
+static List *create_words(int count) {
+  List *l = List_create();
+
+  for (int i = 0; i < count; i++) {
+    size_t len = MIN_RAND_STR_LEN +
+                 rand() % (MAX_RAND_STR_LEN - MIN_RAND_STR_LEN + 1);
+    List_push(l, gen_rand_str(len));
+  }
+
+  return l;
+}
+
+// ---- push / pop / traversal ------------------------------------------------
+
+static void list_new(void *ctx, long iters) {
+  (void)ctx;
+  (void)iters;
+  list = List_create();
+}
+
+static void list_filled(void *ctx, long iters) {
+  (void)ctx;
+  list = List_create();
+  for (long i = 0; i < iters; i++) {
+    List_push(list, (void *)i);
+  }
+}
+
+static void list_free(void *ctx) {
+  (void)ctx;
+  List_destroy(list);
+}
+
+static void run_push(void *ctx, long iters) {
+  (void)ctx;
+  for (long i = 0; i < iters; i++) {
+    List_push(list, (void *)i);
+  }
+}
+
+static void run_unshift(void *ctx, long iters) {
+  (void)ctx;
+  for (long i = 0; i < iters; i++) {
+    List_unshift(list, (void *)i);
+  }
+}
+
+static void run_pop(void *ctx, long iters) {
+  (void)ctx;
+  for (long i = 0; i < iters; i++) {
+    void *val = List_pop(list);
+    bench_do_not_optimize(val);
+  }
+}
+
+static void run_shift(void *ctx, long iters) {
+  (void)ctx;
+  for (long i = 0; i < iters; i++) {
+    void *val = List_shift(list);
+    bench_do_not_optimize(val);
+  }
+}
+
+static void run_foreach(void *ctx, long iters) {
+  (void)ctx;
+  (void)iters;
+  long sum = 0;
+  LIST_FOREACH(list, first, next, cur) { sum += (long)cur->value; }
+  bench_do_not_optimize(sum);
+}
+
+// ---- sorts, one op is sorting a whole list of `sort_size` words -------------
+
+static void lists_setup(void *ctx, long iters) {
+  (void)ctx;
+  lists_count = iters;
+  lists = calloc(iters, sizeof(List *));
+  sorted = calloc(iters, sizeof(List *));
+
+  for (long i = 0; i < iters; i++) {
+    lists[i] = List_create();
+    int n = 0;
+    LIST_FOREACH(words, first, next, cur) {
+      if (n++ == sort_size)
+        break;
+      List_push(lists[i], cur->value);
+    }
+  }
+}
+
+static void lists_teardown(void *ctx) {
+  (void)ctx;
+  for (long i = 0; i < lists_count; i++) {
+    if (sorted[i] && sorted[i] != lists[i]) {
+      List_destroy(sorted[i]);
+    }
+    List_destroy(lists[i]);
+  }
+
+  free(lists);
+  free(sorted);
+}
+
+static void run_bubble_sort(void *ctx, long iters) {
+  (void)ctx;
+  for (long i = 0; i < iters; i++) {
+    List_bubble_sort(lists[i], (List_compare)strcmp);
+  }
+}
+
+static void run_merge_sort(void *ctx, long iters) {
+  (void)ctx;
+  for (long i = 0; i < iters; i++) {
+    sorted[i] = List_merge_sort(lists[i], (List_compare)strcmp);
+  }
+}
+
+static void run_merge_sort_bottom_up(void *ctx, long iters) {
+  (void)ctx;
+  for (long i = 0; i < iters; i++) {
+    sorted[i] = List_merge_sort_bottom_up(lists[i], (List_compare)strcmp);
+  }
+}
+
+// ---- input shapes, one op is sorting SHAPE_SIZE integers -------------------
+
+#define SHAPE_SIZE 100000
+
+enum { SHAPE_RANDOM, SHAPE_SORTED, SHAPE_REVERSED, SHAPE_FEW_UNIQUE };
+
+static int shape = SHAPE_RANDOM;
+
+static int long_cmp(const void *a, const void *b) {
+  long x = (long)a;
+  long y = (long)b;
+  return (x > y) - (x < y);
+}
+
+static void shaped_setup(void *ctx, long iters) {
+  (void)ctx;
+  lists_count = iters;
+  lists = calloc(iters, sizeof(List *));
+  sorted = calloc(iters, sizeof(List *));
+
+  for (long i = 0; i < iters; i++) {
+    lists[i] = List_create();
+    for (long j = 0; j < SHAPE_SIZE; j++) {
+      long v = shape == SHAPE_SORTED     ? j
+               : shape == SHAPE_REVERSED ? SHAPE_SIZE - j
+               : shape == SHAPE_FEW_UNIQUE ? rand() % 8
+                                           : rand();
+      List_push(lists[i], (void *)v);
+    }
+  }
+}
+
+static void run_sort_shaped(void *ctx, long iters) {
+  (void)ctx;
+  for (long i = 0; i < iters; i++) {
+    List_sort(lists[i], long_cmp);
+  }
+}
+
+static void run_bottom_up_shaped(void *ctx, long iters) {
+  (void)ctx;
+  for (long i = 0; i < iters; i++) {
+    List_merge_sort_bottom_up(lists[i], long_cmp);
+  }
+}
+
+// ---- radix vs comparison sorts on records ----------------------------------
+
+#define RECORDS 100000
+
+typedef struct Record {
+  uint64_t stamp;
+  bstring name;
+} Record;
+
+static Record *records = NULL;
+
+static uint64_t record_stamp(const void *value) {
+  return ((const Record *)value)->stamp;
+}
+
+static bstring record_name(const void *value) {
+  return ((const Record *)value)->name;
+}
+
+static int stamp_cmp(const void *a, const void *b) {
+  uint64_t x = ((const Record *)a)->stamp;
+  uint64_t y = ((const Record *)b)->stamp;
+  return (x > y) - (x < y);
+}
+
+static int name_cmp(const void *a, const void *b) {
+  return bstrcmp(((const Record *)a)->name, ((const Record *)b)->name);
+}
+
+static void records_setup(void *ctx, long iters) {
+  (void)ctx;
+  lists_count = iters;
+  lists = calloc(iters, sizeof(List *));
+  sorted = calloc(iters, sizeof(List *));
+
+  for (long i = 0; i < iters; i++) {
+    lists[i] = List_create();
+    for (long j = 0; j < RECORDS; j++) {
+      List_push(lists[i], &records[(j * 7919) % RECORDS]);
+    }
+  }
+}
+
+static void run_sort_stamp(void *ctx, long iters) {
+  (void)ctx;
+  for (long i = 0; i < iters; i++) {
+    List_sort(lists[i], stamp_cmp);
+  }
+}
+
+static void run_radix_stamp(void *ctx, long iters) {
+  (void)ctx;
+  for (long i = 0; i < iters; i++) {
+    List_radix_sort_u64(lists[i], record_stamp);
+  }
+}
+
+static void run_sort_name(void *ctx, long iters) {
+  (void)ctx;
+  for (long i = 0; i < iters; i++) {
+    List_sort(lists[i], name_cmp);
+  }
+}
+
+static void run_radix_name(void *ctx, long iters) {
+  (void)ctx;
+  for (long i = 0; i < iters; i++) {
+    List_radix_sort_bstr(lists[i], record_name);
+  }
+}
+
+// ---- the book's reference answers, kept to compare against ----------------
+
+static void ListNode_swap(ListNode *a, ListNode *b) {
+  void *temp = a->value;
+  a->value = b->value;
+  b->value = temp;
+}
+
+static int List_bubble_sort_ans(List *list, List_compare cmp) {
+  int sorted = 1;
+
+  if (List_count(list) <= 1) {
+    return 0; // already sorted
+  }
+
+  do {
+    sorted = 1;
+    LIST_FOREACH(list, first, next, cur) {
+      if (cur->next) {
+        if (cmp(cur->value, cur->next->value) > 0) {
+          ListNode_swap(cur, cur->next);
+          sorted = 0;
+        }
+      }
+    }
+  } while (!sorted);
+
+  return 0;
+}
+
+static List *List_merge_ans(List *left, List *right, List_compare cmp) {
+  List *result = List_create();
+  void *val = NULL;
+
+  while (List_count(left) > 0 || List_count(right) > 0) {
+    if (List_count(left) > 0 && List_count(right) > 0) {
+      if (cmp(List_first(left), List_first(right)) <= 0) {
+        val = List_shift(left);
+      } else {
+        val = List_shift(right);
+      }
+
+      List_push(result, val);
+    } else if (List_count(left) > 0) {
+      val = List_shift(left);
+      List_push(result, val);
+    } else if (List_count(right) > 0) {
+      val = List_shift(right);
+      List_push(result, val);
+    }
+  }
+
+  return result;
+}
+
+static List *List_merge_sort_ans(List *list, List_compare cmp) {
+  if (List_count(list) <= 1) {
+    return list;
+  }
+
+  List *left = List_create();
+  List *right = List_create();
+  int middle = List_count(list) / 2;
+
+  LIST_FOREACH(list, first, next, cur) {
+    if (middle > 0) {
+      List_push(left, cur->value);
+    } else {
+      List_push(right, cur->value);
+    }
+
+    middle--;
+  }
+
+  List *sort_left = List_merge_sort_ans(left, cmp);
+  List *sort_right = List_merge_sort_ans(right, cmp);
+
+  if (sort_left != left)
+    List_destroy(left);
+  if (sort_right != right)
+    List_destroy(right);
+
+  List *result = List_merge_ans(sort_left, sort_right, cmp);
+  List_destroy(sort_left);
+  List_destroy(sort_right);
+
+  return result;
+}
+
+static void run_bubble_sort_ans(void *ctx, long iters) {
+  (void)ctx;
+  for (long i = 0; i < iters; i++) {
+    List_bubble_sort_ans(lists[i], (List_compare)strcmp);
+  }
+}
+
+static void run_merge_sort_ans(void *ctx, long iters) {
+  (void)ctx;
+  for (long i = 0; i < iters; i++) {
+    sorted[i] = List_merge_sort_ans(lists[i], (List_compare)strcmp);
+  }
+}
+
+// ---- partitioning, one op splits a SPLIT_SIZE list in two and rejoins it -----
+
+#define SPLIT_SIZE 10000
+
+static void split_setup(void *ctx, long iters) {
+  (void)ctx;
+  (void)iters;
+  list = List_create();
+  for (long i = 0; i < SPLIT_SIZE; i++) {
+    List_push(list, (void *)i);
+  }
+}
+
+static void run_split_copy(void *ctx, long iters) {
+  (void)ctx;
+  for (long i = 0; i < iters; i++) {
+    List *head = NULL;
+    List *tail = NULL;
+
+    List_split(list, list->last->prev, &head, &tail);
+    List *whole = List_concat(head, tail);
+
+    List_destroy(head);
+    List_destroy(tail);
+    List_destroy(whole);
+  }
+}
+
+static void run_split_splice(void *ctx, long iters) {
+  (void)ctx;
+  for (long i = 0; i < iters; i++) {
+    List *tail = List_split_splice(list, list->last->prev);
+    List_concat_splice(list, tail);
+    List_destroy(tail);
+  }
+}
+
+static void run_split_at(void *ctx, long iters) {
+  (void)ctx;
+  for (long i = 0; i < iters; i++) {
+    List *tail = List_split_at(list, SPLIT_SIZE / 4 + i % (SPLIT_SIZE / 2));
+    List_concat_splice(list, tail);
+    List_destroy(tail);
+  }
+}
+
+void all_benches() {
+  srand(42);
+  words = create_words(SORT_WORDS);
+
+  bench_run(.name = "List_push", .setup = list_new, .run = run_push,
+            .teardown = list_free);
+  bench_run(.name = "List_unshift", .setup = list_new, .run = run_unshift,
+            .teardown = list_free);
+  bench_run(.name = "List_pop", .setup = list_filled, .run = run_pop,
+            .teardown = list_free);
+  bench_run(.name = "List_shift", .setup = list_filled, .run = run_shift,
+            .teardown = list_free);
+  bench_run(.name = "LIST_FOREACH (per node)", .setup = list_filled,
+            .run = run_foreach, .teardown = list_free);
+
+  sort_size = BUBBLE_WORDS;
+  bench_run(.name = "List_bubble_sort/1000", .setup = lists_setup,
+            .run = run_bubble_sort, .teardown = lists_teardown);
+  bench_run(.name = "List_bubble_sort_ans/1000", .setup = lists_setup,
+            .run = run_bubble_sort_ans, .teardown = lists_teardown);
+
+  sort_size = SORT_WORDS;
+  bench_run(.name = "List_merge_sort/10000", .setup = lists_setup,
+            .run = run_merge_sort, .teardown = lists_teardown);
+  bench_run(.name = "List_merge_sort_ans/10000", .setup = lists_setup,
+            .run = run_merge_sort_ans, .teardown = lists_teardown);
+  bench_run(.name = "List_merge_sort_bottom_up/10000", .setup = lists_setup,
+            .run = run_merge_sort_bottom_up, .teardown = lists_teardown);
+
+  // the copies rebuild both halves, the splices only walk to the split point
+  bench_run(.name = "List_split+List_concat/10000", .setup = split_setup,
+            .run = run_split_copy, .teardown = list_free);
+  bench_run(.name = "List_split_splice+concat near end/10000",
+            .setup = split_setup, .run = run_split_splice,
+            .teardown = list_free);
+  bench_run(.name = "List_split_at+concat middle/10000",
+            .setup = split_setup, .run = run_split_at, .teardown = list_free);
+
+  static const char *shapes[] = {"random", "sorted", "reversed",
+                                 "few-unique"};
+  char name[64];
+
+  for (shape = SHAPE_RANDOM; shape <= SHAPE_FEW_UNIQUE; shape++) {
+    snprintf(name, sizeof(name), "List_sort/%s/100000", shapes[shape]);
+    bench_run(.name = name, .setup = shaped_setup, .run = run_sort_shaped,
+              .teardown = lists_teardown);
+    snprintf(name, sizeof(name), "List_merge_sort_bottom_up/%s/100000",
+             shapes[shape]);
+    bench_run(.name = name, .setup = shaped_setup,
+              .run = run_bottom_up_shaped, .teardown = lists_teardown);
+  }
+
+  // nanosecond timestamps over about a minute, and random names
+  records = malloc(sizeof(Record) * RECORDS);
+  for (long i = 0; i < RECORDS; i++) {
+    char *name = gen_rand_str(8 + rand() % 24);
+    records[i].stamp = 1700000000000000000ULL +
+                       ((uint64_t)rand() << 4 ^ (uint64_t)rand()) % 60000000000ULL;
+    records[i].name = bfromcstr(name);
+    free(name);
+  }
+
+  bench_run(.name = "List_sort u64 key/100000", .setup = records_setup,
+            .run = run_sort_stamp, .teardown = lists_teardown,
+            .items_per_op = RECORDS);
+  bench_run(.name = "List_radix_sort_u64/100000", .setup = records_setup,
+            .run = run_radix_stamp, .teardown = lists_teardown,
+            .items_per_op = RECORDS);
+  bench_run(.name = "List_sort bstring key/100000", .setup = records_setup,
+            .run = run_sort_name, .teardown = lists_teardown,
+            .items_per_op = RECORDS);
+  bench_run(.name = "List_radix_sort_bstr/100000", .setup = records_setup,
+            .run = run_radix_name, .teardown = lists_teardown,
+            .items_per_op = RECORDS);
+
+  for (long i = 0; i < RECORDS; i++) {
+    bdestroy(records[i].name);
+  }
+  free(records);
+
+  List_clear_destroy(words);
+}
+
+RUN_BENCHES(all_benches);
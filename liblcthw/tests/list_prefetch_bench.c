@@ -0,0 +1,137 @@
+#include "bench.h"
+#include <lcthw/list.h>
+#include <lcthw/list_algos.h>
+#include <stdlib.h>
+
+// Lists from 10^4 nodes up to this many, LIST_BENCH_MAX_NODES=100000000
+// runs the full range (about 4GB of memory at the top).
+#define MAX_NODES 1000000L
+
+static List *list = NULL;
+static long *keys = NULL;
+static long nodes = 0;
+
+static int key_cmp(const void *a, const void *b) {
+  long x = *(const long *)a;
+  long y = *(const long *)b;
+  return (x > y) - (x < y);
+}
+
+// an order unrelated to key_cmp's, so sorts can alternate and both do work
+static int mix_cmp(const void *a, const void *b) {
+  unsigned long x = *(const long *)a * 0x9e3779b97f4a7c15UL;
+  unsigned long y = *(const long *)b * 0x9e3779b97f4a7c15UL;
+  return (x > y) - (x < y);
+}
+
+static void randomize_keys() {
+  for (long i = 0; i < nodes; i++) {
+    keys[i] = ((long)rand() << 16) ^ rand();
+  }
+}
+
+// Builds a list whose nodes and values are in random memory order, the way
+// a long lived list ends up, by sorting it on random keys.
+static void build(long n) {
+  nodes = n;
+  keys = malloc(sizeof(long) * n);
+  list = List_create();
+
+  for (long i = 0; i < n; i++) {
+    List_push(list, &keys[i]);
+  }
+
+  randomize_keys();
+  List_sort(list, key_cmp);
+}
+
+static void destroy() {
+  List_destroy(list);
+  free(keys);
+}
+
+// ---- one op is a walk over the whole list -----------------------------------
+
+static void run_foreach(void *ctx, long iters) {
+  (void)ctx;
+  long sum = 0;
+  for (long i = 0; i < iters; i++) {
+    LIST_FOREACH(list, first, next, cur) { sum += *(long *)cur->value; }
+  }
+  bench_do_not_optimize(sum);
+}
+
+static void run_foreach_prefetch(void *ctx, long iters) {
+  (void)ctx;
+  long sum = 0;
+  for (long i = 0; i < iters; i++) {
+    LIST_FOREACH_PREFETCH(list, first, next, cur) {
+      sum += *(long *)cur->value;
+    }
+  }
+  bench_do_not_optimize(sum);
+}
+
+// ---- one op is a sort of the whole list -------------------------------------
+
+static void keys_setup(void *ctx, long iters) {
+  (void)ctx;
+  (void)iters;
+  randomize_keys();
+}
+
+static void run_sort(void *ctx, long iters) {
+  (void)ctx;
+  for (long i = 0; i < iters; i++) {
+    List_sort(list, i % 2 ? mix_cmp : key_cmp);
+  }
+}
+
+static void run_sort_prefetch(void *ctx, long iters) {
+  (void)ctx;
+  for (long i = 0; i < iters; i++) {
+    List_sort_prefetch(list, i % 2 ? mix_cmp : key_cmp);
+  }
+}
+
+static void run_compact(void *ctx, long iters) {
+  (void)ctx;
+  for (long i = 0; i < iters; i++) {
+    List_compact(list);
+  }
+}
+
+void all_benches() {
+  long max = (long)bench_env("LIST_BENCH_MAX_NODES", MAX_NODES);
+  char name[64];
+
+  srand(42);
+
+  for (long n = 10000; n <= max; n *= 10) {
+    build(n);
+
+#define LIST_BENCH(NAME, ...)                                                  \
+  snprintf(name, sizeof(name), NAME "/%ld", n);                                \
+  bench_run(.name = name, .items_per_op = n, __VA_ARGS__)
+
+    LIST_BENCH("LIST_FOREACH scattered", .run = run_foreach);
+    LIST_BENCH("LIST_FOREACH_PREFETCH scattered", .run = run_foreach_prefetch);
+
+    // keys are reshuffled before every sample and the sorts alternate between
+    // two orders, so every sort does real work
+    LIST_BENCH("List_sort scattered", .setup = keys_setup, .run = run_sort);
+    LIST_BENCH("List_sort_prefetch scattered", .setup = keys_setup,
+               .run = run_sort_prefetch);
+
+    // the sorts leave the nodes in random memory order, lay them out again
+    LIST_BENCH("List_compact", .run = run_compact);
+    LIST_BENCH("LIST_FOREACH compacted", .run = run_foreach);
+    LIST_BENCH("LIST_FOREACH_PREFETCH compacted", .run = run_foreach_prefetch);
+
+#undef LIST_BENCH
+
+    destroy();
+  }
+}
+
+RUN_BENCHES(all_benches);
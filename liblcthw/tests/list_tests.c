@@ -84,6 +84,193 @@ char *test_shift() {
   return NULL;
 }
 
+char *test_compact() {
+  List *nums = List_create();
+  long values[100];
+
+  mu_assert(List_compact(nums) == 0, "Compacting an empty list failed.");
+
+  for (long i = 0; i < 100; i++) {
+    values[i] = i;
+    List_unshift(nums, &values[i]);
+  }
+
+  mu_assert(List_compact(nums) == 0, "List_compact failed.");
+  mu_assert(List_count(nums) == 100, "Compact changed the count.");
+
+  // nodes now sit next to each other in list order
+  long expect = 99;
+  ListNode *prev = NULL;
+  LIST_FOREACH(nums, first, next, cur) {
+    mu_assert(*(long *)cur->value == expect--, "Compact changed the order.");
+    mu_assert(cur->prev == prev, "Compact broke the prev links.");
+    mu_assert(prev == NULL || cur == prev + 1, "Nodes aren't contiguous.");
+    prev = cur;
+  }
+  mu_assert(nums->last == prev, "Compact broke last.");
+
+  // slab nodes can still be removed and added to one by one
+  mu_assert(List_shift(nums) == &values[99], "Wrong shift after compact.");
+  mu_assert(List_pop(nums) == &values[0], "Wrong pop after compact.");
+  List_push(nums, &values[0]);
+
+  // compacting again retires the first slab once its nodes are gone
+  mu_assert(List_compact(nums) == 0, "Second List_compact failed.");
+
+  long sum = 0;
+  {
+    LIST_FOREACH_PREFETCH(nums, first, next, cur) { sum += *(long *)cur->value; }
+  }
+  mu_assert(sum == 99 * 100 / 2 - 99, "LIST_FOREACH_PREFETCH missed nodes.");
+
+  List_destroy(nums);
+
+  return NULL;
+}
+
+char *test_push_pop_n() {
+  List *nums = List_create();
+  long values[100];
+  void *batch[100];
+  void *out[100];
+
+  for (long i = 0; i < 100; i++) {
+    values[i] = i;
+    batch[i] = &values[i];
+  }
+
+  mu_assert(List_push_n(nums, batch, 0) == 0, "Empty push_n failed.");
+  mu_assert(List_count(nums) == 0, "Empty push_n added nodes.");
+
+  List_push(nums, &values[0]);
+  mu_assert(List_push_n(nums, batch, 100) == 0, "List_push_n failed.");
+  mu_assert(List_push_n(nums, batch, 1) == 0, "Single push_n failed.");
+  mu_assert(List_count(nums) == 102, "Wrong count after push_n.");
+
+  long expect = 0;
+  ListNode *prev = NULL;
+  LIST_FOREACH(nums, first, next, cur) {
+    if (prev != NULL) {
+      mu_assert(*(long *)cur->value == expect++ % 100, "Wrong push_n order.");
+    }
+    mu_assert(cur->prev == prev, "push_n broke the prev links.");
+    prev = cur;
+  }
+  mu_assert(nums->last == prev, "push_n broke last.");
+
+  // batch nodes can still be removed one at a time
+  mu_assert(List_remove(nums, nums->first->next->next) == &values[1],
+            "Wrong remove from a batch.");
+
+  mu_assert(List_pop_n(nums, out, 3) == 3, "Wrong pop_n count.");
+  mu_assert(out[0] == &values[98] && out[1] == &values[99] &&
+                out[2] == &values[0],
+            "pop_n should keep list order.");
+
+  mu_assert(List_shift_n(nums, out, 3) == 3, "Wrong shift_n count.");
+  mu_assert(out[0] == &values[0] && out[1] == &values[0] &&
+                out[2] == &values[2],
+            "Wrong shift_n values.");
+  mu_assert(nums->first->prev == NULL, "shift_n left a prev link.");
+  mu_assert(nums->last->next == NULL, "pop_n left a next link.");
+
+  mu_assert(List_shift_n(nums, out, 100) == 95, "shift_n should stop.");
+  mu_assert(out[94] == &values[97], "Wrong last shift_n value.");
+  mu_assert(nums->first == NULL && nums->last == NULL,
+            "shift_n should empty the list.");
+  mu_assert(List_pop_n(nums, out, 1) == 0, "Empty pop_n.");
+
+  List_destroy(nums);
+
+  return NULL;
+}
+
+// Walks both ways and checks the links agree with the count.
+static int consistent(List *l) {
+  int n = 0;
+  ListNode *prev = NULL;
+
+  for (ListNode *cur = l->first; cur != NULL; cur = cur->next) {
+    if (cur->prev != prev)
+      return 0;
+    prev = cur;
+    n++;
+  }
+
+  return n == l->count && l->last == prev;
+}
+
+char *test_splice() {
+  List *head = List_create();
+  List *tail = List_create();
+  long values[10];
+
+  for (long i = 0; i < 10; i++) {
+    values[i] = i;
+    List_push(i < 4 ? head : tail, &values[i]);
+  }
+
+  List_concat_splice(head, tail);
+  mu_assert(List_count(head) == 10 && consistent(head), "Bad concat.");
+  mu_assert(List_count(tail) == 0 && tail->first == NULL && tail->last == NULL,
+            "Concat should empty the tail.");
+
+  // splicing in an empty list, and into one
+  List_concat_splice(head, tail);
+  mu_assert(List_count(head) == 10, "Empty concat changed the count.");
+  List_concat_splice(tail, head);
+  mu_assert(List_count(tail) == 10 && consistent(tail), "Concat into empty.");
+  List_destroy(head);
+  head = tail;
+
+  long expect = 0;
+  LIST_FOREACH(head, first, next, cur) {
+    mu_assert(*(long *)cur->value == expect++, "Concat changed the order.");
+  }
+
+  // a node near the end, found from the back
+  tail = List_split_splice(head, head->last->prev);
+  mu_assert(List_count(head) == 8 && consistent(head), "Bad split head.");
+  mu_assert(List_count(tail) == 2 && consistent(tail), "Bad split tail.");
+  mu_assert(List_first(tail) == &values[8], "Wrong split point.");
+  List_concat_splice(head, tail);
+  List_destroy(tail);
+
+  // a node near the front
+  tail = List_split_splice(head, head->first->next);
+  mu_assert(List_count(head) == 1 && List_count(tail) == 9, "Bad split.");
+  mu_assert(consistent(head) && consistent(tail), "Split broke links.");
+  List_concat_splice(head, tail);
+  List_destroy(tail);
+
+  for (int i = 0; i <= 10; i++) {
+    tail = List_split_at(head, i);
+    mu_assert(List_count(head) == i && List_count(tail) == 10 - i,
+              "Wrong counts after List_split_at.");
+    mu_assert(consistent(head) && consistent(tail), "Split broke links.");
+    mu_assert(i == 10 || List_first(tail) == &values[i],
+              "List_split_at split in the wrong place.");
+    List_concat_splice(head, tail);
+    List_destroy(tail);
+  }
+
+  mu_assert(List_split_at(head, 11) == NULL, "Index past the end.");
+  mu_assert(List_split_at(head, -1) == NULL, "Negative index.");
+
+  ListNode stranger = {NULL, NULL, NULL, NULL};
+  mu_assert(List_split_splice(head, &stranger) == NULL,
+            "Splitting at a node of another list should fail.");
+
+  tail = List_split_splice(head, NULL);
+  mu_assert(List_count(tail) == 0 && List_count(head) == 10,
+            "Splitting at NULL should move nothing.");
+  List_destroy(tail);
+
+  List_destroy(head);
+
+  return NULL;
+}
+
 char *all_tests() {
   mu_suite_start();
 
@@ -92,6 +279,9 @@ char *all_tests() {
   mu_run_test(test_unshift);
   mu_run_test(test_remove);
   mu_run_test(test_shift);
+  mu_run_test(test_compact);
+  mu_run_test(test_push_pop_n);
+  mu_run_test(test_splice);
   mu_run_test(test_destroy);
 
   return NULL;
@@ -0,0 +1,137 @@
+#include "minunit.h"
+#include <lcthw/list_typed.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#define NUM_VALUES 1000
+
+#define I64_CMP(a, b) (((a) > (b)) - ((a) < (b)))
+
+LIST_DEFINE(I64List, int64_t)
+LIST_SORT_DEFINE(I64List, int64_t, I64_CMP)
+
+// sorts by key only, `order` checks stability
+typedef struct Entry {
+  int key;
+  int order;
+} Entry;
+
+static inline int entry_cmp(Entry a, Entry b) { return I64_CMP(a.key, b.key); }
+
+LIST_DEFINE(EntryList, Entry)
+LIST_SORT_DEFINE(EntryList, Entry, entry_cmp)
+
+QUEUE_DEFINE(I64Queue, int64_t)
+
+// Walks both ways and checks the links agree with the count.
+static int consistent(I64List *l) {
+  int n = 0;
+  I64ListNode *prev = NULL;
+
+  for (I64ListNode *cur = l->first; cur != NULL; cur = cur->next) {
+    if (cur->prev != prev)
+      return 0;
+    prev = cur;
+    n++;
+  }
+
+  return n == l->count && l->last == prev;
+}
+
+char *test_push_pop() {
+  I64List *list = I64List_create();
+  int64_t v = 0;
+
+  mu_assert(I64List_pop(list, &v) == -1, "Empty pop should fail.");
+  mu_assert(I64List_shift(list, &v) == -1, "Empty shift should fail.");
+
+  for (int64_t i = 0; i < 10; i++) {
+    I64List_push(list, i);
+    I64List_unshift(list, -i);
+  }
+
+  mu_assert(I64List_count(list) == 20, "Wrong count.");
+  mu_assert(consistent(list), "Links broken.");
+  mu_assert(I64List_pop(list, &v) == 0 && v == 9, "Wrong pop.");
+  mu_assert(I64List_shift(list, &v) == 0 && v == -9, "Wrong shift.");
+
+  I64List_remove(list, list->first->next, &v);
+  mu_assert(v == -7 && consistent(list), "Wrong remove.");
+
+  I64List_destroy(list);
+
+  return NULL;
+}
+
+char *test_sort() {
+  I64List *list = I64List_create();
+  srand(42);
+
+  for (int i = 0; i < NUM_VALUES; i++) {
+    I64List_push(list, rand() - RAND_MAX / 2);
+  }
+
+  I64List_sort(list);
+  mu_assert(I64List_count(list) == NUM_VALUES, "Sort lost nodes.");
+  mu_assert(consistent(list), "Sort broke the links.");
+
+  int64_t prev = INT64_MIN;
+  LIST_TYPED_FOREACH(list, cur) {
+    mu_assert(prev <= cur->value, "Not sorted.");
+    prev = cur->value;
+  }
+
+  I64List_destroy(list);
+
+  EntryList *entries = EntryList_create();
+  for (int i = 0; i < NUM_VALUES; i++) {
+    EntryList_push(entries, (Entry){rand() % 10, i});
+  }
+
+  EntryList_sort(entries);
+
+  Entry last = {-1, -1};
+  LIST_TYPED_FOREACH(entries, cur) {
+    mu_assert(last.key <= cur->value.key, "Entries not sorted.");
+    mu_assert(last.key < cur->value.key || last.order < cur->value.order,
+              "Sort isn't stable.");
+    last = cur->value;
+  }
+
+  EntryList_destroy(entries);
+
+  return NULL;
+}
+
+char *test_queue() {
+  I64Queue *queue = I64Queue_create();
+  int64_t v = 0;
+
+  for (int64_t i = 0; i < 100; i++) {
+    I64Queue_send(queue, i);
+  }
+
+  mu_assert(I64Queue_count(queue) == 100, "Wrong queue count.");
+  mu_assert(I64Queue_peek(queue, &v) == 0 && v == 0, "Wrong peek.");
+
+  for (int64_t i = 0; i < 100; i++) {
+    mu_assert(I64Queue_recv(queue, &v) == 0 && v == i, "Wrong recv.");
+  }
+  mu_assert(I64Queue_recv(queue, &v) == -1, "Empty recv should fail.");
+
+  I64Queue_destroy(queue);
+
+  return NULL;
+}
+
+char *all_tests() {
+  mu_suite_start();
+
+  mu_run_test(test_push_pop);
+  mu_run_test(test_sort);
+  mu_run_test(test_queue);
+
+  return NULL;
+}
+
+RUN_TESTS(all_tests);
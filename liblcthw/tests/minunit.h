@@ -11,7 +11,7 @@
 #define mu_assert(test, message)                                               \
   if (!(test)) {                                                               \
     log_err(message);                                                          \
-    return message;                                                            \
+    return (char *)message;                                                    \
   }
 #define mu_run_test(test)                                                      \
   debug("\n-----%s", " " #test);                                               \
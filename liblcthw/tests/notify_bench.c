@@ -0,0 +1,166 @@
+#include "bench.h"
+#include <lcthw/posix_ringbuffer.h>
+#include <pthread.h>
+#include <sys/epoll.h>
+#include <unistd.h>
+
+// A producer thread sends bursts of messages stamped with the time they were
+// written, with idle gaps in between so the consumer runs out of work and
+// has to notice the next burst. The wakeup latency is the age of the first
+// message of a burst when the consumer gets it, the CPU use is the
+// consumer's CPU time over the wall time.
+#define BURSTS 1000
+#define BURST_SIZE 16
+#define BURST_GAP_US 1000
+#define MSG_SIZE 64
+#define SLEEP_POLL_US 1000
+
+typedef enum { BUSY_POLL, SLEEP_POLL, FUTEX_WAIT, EPOLL_WAIT } Strategy;
+
+static const char *strategy_names[] = {
+    "busy poll", "sleep poll 1ms", "futex spin+park", "epoll eventfd"};
+
+static PosixRingBuffer *ring = NULL;
+
+static void *producer(void *arg) {
+  char msg[MSG_SIZE] = {0};
+  (void)arg;
+
+  for (int b = 0; b < BURSTS; b++) {
+    // jitter so the bursts don't line up with the sleep poll
+    usleep(BURST_GAP_US + (b * 7919) % 500);
+    for (int m = 0; m < BURST_SIZE; m++) {
+      uint64_t now = bench_monotonic_ns();
+      memcpy(msg, &now, sizeof(now));
+      PosixRingBuffer_write(ring, msg, MSG_SIZE);
+    }
+  }
+  return NULL;
+}
+
+static void wait_msg(Strategy strategy, int epoll, int event_fd) {
+  uint64_t count;
+  struct epoll_event ready;
+
+  switch (strategy) {
+  case BUSY_POLL:
+    while (PosixRingBuffer_available_data(ring) < MSG_SIZE) {
+    }
+    break;
+  case SLEEP_POLL:
+    while (PosixRingBuffer_available_data(ring) < MSG_SIZE) {
+      usleep(SLEEP_POLL_US);
+    }
+    break;
+  case FUTEX_WAIT:
+    PosixRingBuffer_wait_data(ring, MSG_SIZE, -1);
+    break;
+  case EPOLL_WAIT:
+    while (PosixRingBuffer_arm(ring, MSG_SIZE) < MSG_SIZE) {
+      epoll_wait(epoll, &ready, 1, -1);
+      if (read(event_fd, &count, sizeof(count)) < 0) {
+        // a spurious wake, the ring is checked again anyway
+      }
+    }
+    break;
+  }
+}
+
+static double thread_cpu_ns() {
+  struct timespec ts;
+  clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+  return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static void run_strategy(Strategy strategy) {
+  static double latencies[BURSTS];
+  char msg[MSG_SIZE];
+  char name[64];
+  int epoll = -1;
+  int event_fd = -1;
+  pthread_t thread;
+
+  ring = PosixRingBuffer_create_pow2(1 << 20);
+  if (strategy == FUTEX_WAIT || strategy == EPOLL_WAIT) {
+    PosixRingBuffer_enable_notify(ring);
+  }
+  if (strategy == EPOLL_WAIT) {
+    struct epoll_event event = {.events = EPOLLIN};
+    event_fd = PosixRingBuffer_eventfd(ring);
+    epoll = epoll_create1(0);
+    epoll_ctl(epoll, EPOLL_CTL_ADD, event_fd, &event);
+  }
+
+  // the producer inherits the counters, so they count both threads
+  PerfCounters_reset(&bench_perf);
+  bench_counters_start();
+  double cpu = thread_cpu_ns();
+  uint64_t start = bench_monotonic_ns();
+  pthread_create(&thread, NULL, producer, NULL);
+
+  for (int b = 0; b < BURSTS; b++) {
+    for (int m = 0; m < BURST_SIZE; m++) {
+      wait_msg(strategy, epoll, event_fd);
+      PosixRingBuffer_read(ring, msg, MSG_SIZE);
+      if (m == 0) {
+        uint64_t sent;
+        memcpy(&sent, msg, sizeof(sent));
+        latencies[b] = bench_monotonic_ns() - sent;
+      }
+    }
+  }
+
+  pthread_join(thread, NULL);
+  double cpu_pct =
+      (thread_cpu_ns() - cpu) / (double)(bench_monotonic_ns() - start) * 100;
+  bench_counters_stop();
+
+  qsort(latencies, BURSTS, sizeof(double), bench_cmp_double);
+  double p50 = latencies[BURSTS / 2];
+  double p99 = latencies[(int)ceil(BURSTS * 0.99) - 1];
+  double p999 = latencies[(int)ceil(BURSTS * 0.999) - 1];
+
+  snprintf(name, sizeof(name), "PosixRingBuffer wakeup, %s",
+           strategy_names[strategy]);
+  printf("%-44s p50 %9.1f us  p99 %9.1f us  p99.9 %9.1f us  cpu %5.1f%%\n",
+         name, p50 / 1e3, p99 / 1e3, p999 / 1e3, cpu_pct);
+  double per_msg[PERF_COUNTER_MAX];
+  bench_counters_per(per_msg, (double)BURSTS * BURST_SIZE);
+  if (bench_perf_state == 1) {
+    bench_counters_print(per_msg, PerfCounters_running_ratio(&bench_perf),
+                         "msg");
+  }
+  benches_run++;
+
+  const char *json = getenv("BENCH_JSON");
+  FILE *out = json && *json ? fopen(json, "a") : NULL;
+  if (out) {
+    fprintf(out,
+            "{\"suite\": \"%s\", \"name\": \"%s\", \"p50_ns\": %.3f, "
+            "\"p99_ns\": %.3f, \"p999_ns\": %.3f, \"cpu_pct\": %.2f",
+            bench_suite, name, p50, p99, p999, cpu_pct);
+    if (bench_perf_state == 1) {
+      bench_counters_json(out, per_msg,
+                          PerfCounters_running_ratio(&bench_perf), "msg");
+    }
+    fprintf(out, "}\n");
+    fclose(out);
+  }
+
+  if (epoll != -1) {
+    close(epoll);
+  }
+  PosixRingBuffer_destroy(ring);
+}
+
+void all_benches() {
+  printf("%d bursts of %d x %d bytes, %d us apart, %ld CPUs online\n", BURSTS,
+         BURST_SIZE, MSG_SIZE, BURST_GAP_US, sysconf(_SC_NPROCESSORS_ONLN));
+
+  run_strategy(BUSY_POLL);
+  run_strategy(SLEEP_POLL);
+  run_strategy(FUTEX_WAIT);
+  run_strategy(EPOLL_WAIT);
+}
+
+RUN_BENCHES(all_benches);
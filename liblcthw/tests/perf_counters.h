@@ -0,0 +1,201 @@
+#ifndef _perf_counters_h
+#define _perf_counters_h
+
+#include <stdint.h>
+#include <string.h>
+
+/**
+ * Hardware performance counters read through perf_event_open(2).
+ *
+ * Every counter is opened on its own so a PMU that lacks one event (or a VM
+ * that exposes none, or perf_event_paranoid forbidding them) only loses
+ * that counter. Unavailable counters keep fd == -1 and are skipped, callers
+ * check PerfCounters_available() before reporting anything.
+ *
+ * With more events than the PMU has registers the kernel multiplexes them,
+ * each only counts part of the time. Reads scale the counts up by the time
+ * enabled over the time running, PerfCounters_running_ratio tells how much
+ * of the region was really counted.
+ *
+ * Counters are inherited by threads created after they're opened and read
+ * as the total of all of them, so open them before starting any threads.
+ */
+
+typedef enum {
+  PERF_CYCLES = 0,
+  PERF_INSTRUCTIONS,
+  PERF_BRANCH_MISSES,
+  PERF_L1D_MISSES,
+  PERF_LLC_MISSES,
+  PERF_DTLB_MISSES,
+  PERF_PAGE_FAULTS,
+  PERF_COUNTER_MAX
+} PerfCounter;
+
+typedef struct PerfCounters {
+  int fds[PERF_COUNTER_MAX];
+  uint64_t values[PERF_COUNTER_MAX]; // Totals since the last reset, scaled.
+  // Nanoseconds each counter was enabled and really running, since the
+  // last reset.
+  uint64_t enabled[PERF_COUNTER_MAX];
+  uint64_t running[PERF_COUNTER_MAX];
+  // The kernel's times only ever grow, what they were at the last stop.
+  uint64_t last_enabled[PERF_COUNTER_MAX];
+  uint64_t last_running[PERF_COUNTER_MAX];
+} PerfCounters;
+
+static const char *perf_counter_names[PERF_COUNTER_MAX] = {
+    "cycles",      "instructions", "branch_misses", "l1d_misses",
+    "llc_misses",  "dtlb_misses",  "page_faults"};
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#define PERF_CACHE_EVENT(C)                                                    \
+  ((C) | (PERF_COUNT_HW_CACHE_OP_READ << 8) |                                  \
+   (PERF_COUNT_HW_CACHE_RESULT_MISS << 16))
+
+static inline int perf_counter_open(uint32_t type, uint64_t config) {
+  struct perf_event_attr attr;
+
+  memset(&attr, 0, sizeof(attr));
+  attr.size = sizeof(attr);
+  attr.type = type;
+  attr.config = config;
+  attr.disabled = 1;
+  // page faults are counted in the kernel, keep them
+  attr.exclude_kernel = type != PERF_TYPE_SOFTWARE;
+  attr.exclude_hv = 1;
+  attr.inherit = 1;
+  attr.read_format =
+      PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+  return (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+}
+
+/**
+ * Opens every counter this machine supports for the calling thread.
+ *
+ * @return the number of counters that could be opened.
+ */
+static inline int PerfCounters_open(PerfCounters *pc) {
+  static const struct {
+    uint32_t type;
+    uint64_t config;
+  } events[PERF_COUNTER_MAX] = {
+      {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+      {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+      {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+      {PERF_TYPE_HW_CACHE, PERF_CACHE_EVENT(PERF_COUNT_HW_CACHE_L1D)},
+      {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES},
+      {PERF_TYPE_HW_CACHE, PERF_CACHE_EVENT(PERF_COUNT_HW_CACHE_DTLB)},
+      {PERF_TYPE_SOFTWARE, PERF_COUNT_SW_PAGE_FAULTS},
+  };
+  int opened = 0;
+
+  for (int i = 0; i < PERF_COUNTER_MAX; i++) {
+    pc->fds[i] = perf_counter_open(events[i].type, events[i].config);
+    pc->values[i] = 0;
+    pc->enabled[i] = 0;
+    pc->running[i] = 0;
+    pc->last_enabled[i] = 0;
+    pc->last_running[i] = 0;
+    opened += pc->fds[i] != -1;
+  }
+
+  return opened;
+}
+
+static inline void PerfCounters_close(PerfCounters *pc) {
+  for (int i = 0; i < PERF_COUNTER_MAX; i++) {
+    if (pc->fds[i] != -1)
+      close(pc->fds[i]);
+    pc->fds[i] = -1;
+  }
+}
+
+static inline void PerfCounters_start(PerfCounters *pc) {
+  for (int i = 0; i < PERF_COUNTER_MAX; i++) {
+    if (pc->fds[i] != -1)
+      ioctl(pc->fds[i], PERF_EVENT_IOC_ENABLE, 0);
+  }
+}
+
+/**
+ * Stops the counters and adds what they counted since the last start to
+ * `pc->values`, scaled up for the time they were multiplexed out.
+ */
+static inline void PerfCounters_stop(PerfCounters *pc) {
+  for (int i = 0; i < PERF_COUNTER_MAX; i++) {
+    // the layout PERF_FORMAT_TOTAL_TIME_ENABLED | _RUNNING reads
+    struct {
+      uint64_t value;
+      uint64_t enabled;
+      uint64_t running;
+    } count;
+
+    if (pc->fds[i] == -1)
+      continue;
+
+    ioctl(pc->fds[i], PERF_EVENT_IOC_DISABLE, 0);
+    if (read(pc->fds[i], &count, sizeof(count)) == sizeof(count)) {
+      uint64_t enabled = count.enabled - pc->last_enabled[i];
+      uint64_t running = count.running - pc->last_running[i];
+
+      if (running > 0 && running < enabled)
+        count.value = (uint64_t)((double)count.value * enabled / running);
+      pc->values[i] += count.value;
+      pc->enabled[i] += enabled;
+      pc->running[i] += running;
+      pc->last_enabled[i] = count.enabled;
+      pc->last_running[i] = count.running;
+    }
+    // zeroes the count, not the times
+    ioctl(pc->fds[i], PERF_EVENT_IOC_RESET, 0);
+  }
+}
+#else
+static inline int PerfCounters_open(PerfCounters *pc) {
+  for (int i = 0; i < PERF_COUNTER_MAX; i++) {
+    pc->fds[i] = -1;
+    pc->values[i] = 0;
+  }
+  return 0;
+}
+
+static inline void PerfCounters_close(PerfCounters *pc) { (void)pc; }
+
+static inline void PerfCounters_start(PerfCounters *pc) { (void)pc; }
+
+static inline void PerfCounters_stop(PerfCounters *pc) { (void)pc; }
+#endif
+
+#define PerfCounters_available(P, C) ((P)->fds[(C)] != -1)
+
+static inline void PerfCounters_reset(PerfCounters *pc) {
+  memset(pc->values, 0, sizeof(pc->values));
+  memset(pc->enabled, 0, sizeof(pc->enabled));
+  memset(pc->running, 0, sizeof(pc->running));
+}
+
+/**
+ * The smallest share of its enabled time any counter really ran since the
+ * last reset: 1 when nothing was multiplexed, 0.5 when some counter's
+ * values are extrapolated from half of the region.
+ */
+static inline double PerfCounters_running_ratio(PerfCounters *pc) {
+  double ratio = 1;
+
+  for (int i = 0; i < PERF_COUNTER_MAX; i++) {
+    if (PerfCounters_available(pc, i) && pc->enabled[i] > 0 &&
+        (double)pc->running[i] / pc->enabled[i] < ratio)
+      ratio = (double)pc->running[i] / pc->enabled[i];
+  }
+
+  return ratio;
+}
+
+#endif
@@ -1,9 +1,12 @@
 #include "minunit.h"
 #include <assert.h>
+#include <limits.h>
 #include <lcthw/posix_ringbuffer.h>
+#include <pthread.h>
 #include <stddef.h>
 #include <stdio.h>
 #include <string.h>
+#include <sys/epoll.h>
 
 #define BUFFER_SIZE 4096
 
@@ -136,6 +139,334 @@ char *test_wraparound() {
   return NULL;
 }
 
+char *test_mirror() {
+  PosixRingBuffer *ring = PosixRingBuffer_create(BUFFER_SIZE);
+
+  // both halves are the same memory
+  ring->buffer[ring->length + 3] = 'x';
+  mu_assert(ring->buffer[3] == 'x', "Second half doesn't mirror the first.");
+  ring->buffer[5] = 'y';
+  mu_assert(ring->buffer[ring->length + 5] == 'y',
+            "First half doesn't mirror the second.");
+
+  PosixRingBuffer_destroy(ring);
+  return NULL;
+}
+
+char *test_pow2() {
+  int page_size = sysconf(_SC_PAGESIZE);
+  PosixRingBuffer *ring = PosixRingBuffer_create_pow2(3 * page_size);
+  mu_assert(ring != NULL, "Failed to create the power-of-two ring.");
+  mu_assert(ring->capacity == (size_t)page_size * 4,
+            "Capacity should round up to a power of two.");
+  mu_assert(PosixRingBuffer_available_space(ring) == page_size * 4,
+            "Every byte should be usable.");
+
+  char *data = malloc(ring->capacity);
+  char *read_data = malloc(ring->capacity);
+  for (size_t i = 0; i < ring->capacity; i++) {
+    data[i] = (char)(i * 31);
+  }
+
+  // start just short of the end so the writes run through the mirror
+  ring->head = ring->tail = ring->capacity * 3 - 100;
+  int rc = PosixRingBuffer_write(ring, data, ring->capacity + 1);
+  mu_assert(rc == (int)ring->capacity, "Write should stop when full.");
+  mu_assert(PosixRingBuffer_full(ring), "Ring should be full.");
+
+  rc = PosixRingBuffer_read(ring, read_data, ring->capacity);
+  mu_assert(rc == (int)ring->capacity, "Failed to read everything.");
+  mu_assert(memcmp(data, read_data, ring->capacity) == 0,
+            "Data mismatch across the end.");
+  mu_assert(PosixRingBuffer_empty(ring), "Ring should be empty.");
+
+  free(data);
+  free(read_data);
+  PosixRingBuffer_destroy(ring);
+  return NULL;
+}
+
+// Past what an int capacity could describe. Only the touched pages get
+// memory.
+char *test_pow2_huge() {
+  PosixRingBuffer *ring = PosixRingBuffer_create_pow2((size_t)1 << 32);
+  if (ring == NULL) {
+    printf("Skipping, can't map a 4 GB ring here.\n");
+    return NULL;
+  }
+
+  ring->head = ring->tail = ring->capacity - 8;
+  PosixRingBuffer_write(ring, "0123456789abcdef", 16);
+  mu_assert(ring->buffer[0] == '8', "Write didn't reach the start.");
+
+  char read_data[16];
+  PosixRingBuffer_read(ring, read_data, 16);
+  mu_assert(memcmp(read_data, "0123456789abcdef", 16) == 0,
+            "Data mismatch across the end of a 4 GB ring.");
+
+  ring->tail = ring->head + ring->capacity - 1;
+  mu_assert(PosixRingBuffer_available_data(ring) == INT_MAX,
+            "Counts past INT_MAX should clamp.");
+
+  PosixRingBuffer_destroy(ring);
+  return NULL;
+}
+
+// Writes across the end of `ring` and reads the same bytes back.
+static int round_trips(PosixRingBuffer *ring) {
+  char out[16];
+
+  ring->head = ring->tail = ring->capacity - 8;
+  PosixRingBuffer_write(ring, "0123456789abcdef", 16);
+  PosixRingBuffer_read(ring, out, 16);
+
+  return ring->buffer[0] == '8' && memcmp(out, "0123456789abcdef", 16) == 0;
+}
+
+char *test_options() {
+  PosixRingBufferOptions populate = {.flags = POSIX_RINGBUFFER_POPULATE};
+  PosixRingBuffer *ring = PosixRingBuffer_create_opts(BUFFER_SIZE, &populate);
+  mu_assert(ring != NULL, "Failed to create a populated ring.");
+  mu_assert(round_trips(ring), "Populated ring doesn't mirror.");
+  PosixRingBuffer_destroy(ring);
+
+  // a hint, so it works even where shared memory never gets huge pages
+  PosixRingBufferOptions thp = {.flags = POSIX_RINGBUFFER_THP |
+                                         POSIX_RINGBUFFER_POPULATE};
+  ring = PosixRingBuffer_create_opts(BUFFER_SIZE, &thp);
+  mu_assert(ring != NULL, "Failed to create a THP ring.");
+  // the capacity rounds up to one huge page here
+  mu_assert(ring->capacity > BUFFER_SIZE,
+            "THP ring should be at least a huge page.");
+  mu_assert((uintptr_t)ring->buffer % ring->capacity == 0,
+            "THP ring isn't aligned to a huge page.");
+  mu_assert(round_trips(ring), "THP ring doesn't mirror.");
+  PosixRingBuffer_destroy(ring);
+
+  // node 0 exists wherever NUMA does, but mbind may be filtered
+  PosixRingBufferOptions bind = {.flags = POSIX_RINGBUFFER_BIND |
+                                          POSIX_RINGBUFFER_POPULATE,
+                                 .numa_node = 0};
+  ring = PosixRingBuffer_create_opts(BUFFER_SIZE, &bind);
+  if (ring != NULL) {
+    mu_assert(round_trips(ring), "Bound ring doesn't mirror.");
+    PosixRingBuffer_destroy(ring);
+  } else {
+    printf("Skipping NUMA binding, mbind isn't available here.\n");
+  }
+
+  bind.numa_node = 1000;
+  mu_assert(PosixRingBuffer_create_opts(BUFFER_SIZE, &bind) == NULL,
+            "Binding to a node past the mask should fail.");
+
+  // needs a reserved pool, most machines have none
+  PosixRingBufferOptions hugetlb = {.flags = POSIX_RINGBUFFER_HUGETLB};
+  ring = PosixRingBuffer_create_opts(BUFFER_SIZE, &hugetlb);
+  if (ring != NULL) {
+    mu_assert(round_trips(ring), "Hugetlb ring doesn't mirror.");
+    PosixRingBuffer_destroy(ring);
+  } else {
+    printf("Skipping hugetlb, no huge pages reserved.\n");
+  }
+
+  return NULL;
+}
+
+typedef struct {
+  uint64_t seq;
+  double value;
+} Sample;
+
+// Pushes samples through `ring` as messages until it has wrapped a few
+// times, draining in batches and reading each sample in place.
+static char *check_msgs(PosixRingBuffer *ring) {
+  PosixRingBufferMsg msgs[16];
+  uint64_t written = 0;
+  uint64_t read = 0;
+
+  while (read < 10000) {
+    // odd payloads so records carry padding
+    Sample sample = {written, written * 0.5};
+    while (PosixRingBuffer_write_msg(ring, &sample,
+                                     sizeof(sample) - written % 3) == 0) {
+      sample.seq = ++written;
+      sample.value = written * 0.5;
+    }
+    mu_assert(written > read, "A message should fit an empty ring.");
+
+    int count = PosixRingBuffer_read_msgs(ring, msgs, 16);
+    mu_assert(count > 0 && count <= 16, "Batch should see queued messages.");
+    for (int i = 0; i < count; i++) {
+      mu_assert((uintptr_t)msgs[i].data % ring->msg_align == 0,
+                "Payload isn't aligned.");
+      mu_assert(msgs[i].length == sizeof(Sample) - read % 3,
+                "Wrong message length.");
+      const Sample *in_place = (const Sample *)msgs[i].data;
+      mu_assert(in_place->seq == read, "Messages out of order.");
+      read++;
+    }
+    mu_assert(PosixRingBuffer_release_msgs(ring, count) == count,
+              "Failed to release the batch.");
+  }
+
+  // drain, then releasing more than is there fails
+  while (PosixRingBuffer_read_msg(ring, msgs) == 1) {
+    mu_assert(((const Sample *)msgs[0].data)->seq == read++,
+              "Messages out of order while draining.");
+    PosixRingBuffer_release_msg(ring);
+  }
+  mu_assert(read == written, "Lost messages.");
+  mu_assert(PosixRingBuffer_empty(ring), "Ring should be empty.");
+  mu_assert(PosixRingBuffer_release_msg(ring) == -1,
+            "Released a message from an empty ring.");
+
+  return NULL;
+}
+
+char *test_msgs() {
+  PosixRingBuffer *ring = PosixRingBuffer_create(BUFFER_SIZE);
+  char *message = check_msgs(ring);
+  if (message) {
+    return message;
+  }
+
+  mu_assert(PosixRingBuffer_set_msg_align(ring, 6) == -1,
+            "Alignment must be a power of two.");
+  mu_assert(PosixRingBuffer_set_msg_align(ring, 64) == 0,
+            "Failed to set a cache line alignment.");
+  message = check_msgs(ring);
+  if (message) {
+    return message;
+  }
+
+  // zero length messages are records too
+  mu_assert(PosixRingBuffer_write_msg(ring, NULL, 0) == 0,
+            "Failed to write an empty message.");
+  mu_assert(PosixRingBuffer_set_msg_align(ring, 8) == -1,
+            "Realigned a ring holding data.");
+  PosixRingBufferMsg msg;
+  mu_assert(PosixRingBuffer_read_msg(ring, &msg) == 1 && msg.length == 0,
+            "Failed to read an empty message.");
+  PosixRingBuffer_release_msg(ring);
+  PosixRingBuffer_destroy(ring);
+
+  ring = PosixRingBuffer_create_pow2(BUFFER_SIZE);
+  ring->head = ring->tail = ((uint64_t)1 << 33) - 64;
+  message = check_msgs(ring);
+  if (message) {
+    return message;
+  }
+
+  // a message that can never fit
+  char *big = calloc(1, ring->capacity);
+  mu_assert(PosixRingBuffer_write_msg(ring, big, ring->capacity) == -1,
+            "A message bigger than the ring went in.");
+  free(big);
+
+  PosixRingBuffer_destroy(ring);
+  return NULL;
+}
+
+#define NOTIFY_BYTES (1 << 22)
+
+// Producer thread: streams NOTIFY_BYTES counting bytes in odd chunks,
+// sleeping whenever the ring is full.
+static void *notify_producer(void *arg) {
+  PosixRingBuffer *ring = arg;
+  char chunk[1000];
+  long sent = 0;
+
+  while (sent < NOTIFY_BYTES) {
+    int size = NOTIFY_BYTES - sent < (long)sizeof(chunk) ? NOTIFY_BYTES - sent
+                                                          : (int)sizeof(chunk);
+    for (int i = 0; i < size; i++) {
+      chunk[i] = (char)(sent + i);
+    }
+    if (PosixRingBuffer_wait_space(ring, size, 5000) < size) {
+      return (void *)1;
+    }
+    sent += PosixRingBuffer_write(ring, chunk, size);
+  }
+  return NULL;
+}
+
+char *test_notify() {
+  PosixRingBuffer *classic = PosixRingBuffer_create(BUFFER_SIZE);
+  mu_assert(PosixRingBuffer_enable_notify(classic) == -1,
+            "Only power-of-two rings notify.");
+  PosixRingBuffer_destroy(classic);
+
+  PosixRingBuffer *ring = PosixRingBuffer_create_pow2(BUFFER_SIZE);
+  mu_assert(PosixRingBuffer_wait_data(ring, 1, 0) == -1,
+            "Waiting needs notify enabled.");
+  mu_assert(PosixRingBuffer_enable_notify(ring) == 0,
+            "Failed to enable notify.");
+  mu_assert(PosixRingBuffer_wait_data(ring, 1, 10) == -1,
+            "Waiting on an empty ring should time out.");
+
+  pthread_t producer;
+  void *failed = NULL;
+  mu_assert(pthread_create(&producer, NULL, notify_producer, ring) == 0,
+            "Failed to start the producer.");
+
+  char got[700];
+  long received = 0;
+  while (received < NOTIFY_BYTES) {
+    mu_assert(PosixRingBuffer_wait_data(ring, 1, 5000) > 0,
+              "Producer stalled.");
+    int n = PosixRingBuffer_read(ring, got, sizeof(got));
+    for (int i = 0; i < n; i++) {
+      mu_assert(got[i] == (char)(received + i), "Bytes arrived out of order.");
+    }
+    received += n;
+  }
+
+  pthread_join(producer, &failed);
+  mu_assert(failed == NULL, "Producer timed out waiting for space.");
+  mu_assert(PosixRingBuffer_empty(ring), "Ring should be drained.");
+
+  PosixRingBuffer_destroy(ring);
+  return NULL;
+}
+
+char *test_eventfd() {
+  PosixRingBuffer *ring = PosixRingBuffer_create_pow2(BUFFER_SIZE);
+  int fd = PosixRingBuffer_eventfd(ring);
+  mu_assert(fd != -1, "Failed to get an eventfd.");
+  mu_assert(PosixRingBuffer_eventfd(ring) == fd, "Should be the same fd.");
+
+  int epoll = epoll_create1(0);
+  struct epoll_event event = {.events = EPOLLIN};
+  struct epoll_event ready;
+  mu_assert(epoll_ctl(epoll, EPOLL_CTL_ADD, fd, &event) == 0,
+            "Failed to register the eventfd.");
+
+  // unarmed, writes don't signal
+  PosixRingBuffer_write(ring, "a", 1);
+  mu_assert(epoll_wait(epoll, &ready, 1, 0) == 0,
+            "An unarmed ring signalled.");
+  mu_assert(PosixRingBuffer_arm(ring, 1) == 1,
+            "Arming with data there should say so.");
+
+  char c;
+  PosixRingBuffer_read(ring, &c, 1);
+  mu_assert(PosixRingBuffer_arm(ring, 1) == 0, "Ring should be empty.");
+  PosixRingBuffer_write(ring, "b", 1);
+  mu_assert(epoll_wait(epoll, &ready, 1, 0) == 1,
+            "An armed ring didn't signal.");
+
+  uint64_t count;
+  mu_assert(read(fd, &count, sizeof(count)) == sizeof(count) && count == 1,
+            "Wrong eventfd count.");
+  PosixRingBuffer_write(ring, "c", 1);
+  mu_assert(epoll_wait(epoll, &ready, 1, 0) == 0,
+            "The signal should disarm the ring.");
+
+  close(epoll);
+  PosixRingBuffer_destroy(ring);
+  return NULL;
+}
+
 char *all_tests() {
   mu_suite_start();
 
@@ -144,6 +475,13 @@ char *all_tests() {
   mu_run_test(test_overflow);
   mu_run_test(test_wraparound);
   mu_run_test(test_destroy);
+  mu_run_test(test_mirror);
+  mu_run_test(test_pow2);
+  mu_run_test(test_pow2_huge);
+  mu_run_test(test_options);
+  mu_run_test(test_msgs);
+  mu_run_test(test_notify);
+  mu_run_test(test_eventfd);
 
   return NULL;
 }
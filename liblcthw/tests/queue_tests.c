@@ -47,11 +47,37 @@ char *test_send_recv()
     return NULL;
 }
 
+char *test_send_recv_n()
+{
+    void *out[NUM_TESTS + 1] = {NULL};
+
+    mu_assert(Queue_send_n(queue, (void **)tests, NUM_TESTS) == 0,
+            "Queue_send_n failed.");
+    Queue_send(queue, tests[0]);
+    mu_assert(Queue_count(queue) == NUM_TESTS + 1, "Wrong count on send_n.");
+    mu_assert(Queue_peek(queue) == tests[0], "Wrong next value.");
+
+    mu_assert(Queue_recv_n(queue, out, 2) == 2, "Wrong recv_n count.");
+    mu_assert(out[0] == tests[0] && out[1] == tests[1],
+            "Wrong values on recv_n.");
+
+    // asking for more than there is takes what's left
+    mu_assert(Queue_recv_n(queue, out, NUM_TESTS + 1) == 2,
+            "recv_n should stop at the end.");
+    mu_assert(out[0] == tests[2] && out[1] == tests[0],
+            "Wrong values on short recv_n.");
+    mu_assert(Queue_recv_n(queue, out, 1) == 0, "Empty queue recv_n.");
+    mu_assert(Queue_count(queue) == 0, "Wrong count after recv_n.");
+
+    return NULL;
+}
+
 char *all_tests() {
     mu_suite_start();
 
     mu_run_test(test_create);
     mu_run_test(test_send_recv);
+    mu_run_test(test_send_recv_n);
     mu_run_test(test_destroy);
 
     return NULL;
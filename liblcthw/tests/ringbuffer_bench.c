@@ -0,0 +1,295 @@
+#include "bench.h"
+#include <lcthw/posix_ringbuffer.h>
+#include <lcthw/ringbuffer.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define TEST_BUFFER_SIZE (4096 * 10240)
+#define NUM_OPERATIONS 1000000
+#define MAX_CHUNK_SIZE 8192
+
+// Identical random operations for both implementations
+typedef struct {
+  int is_write;   // 1 for write, 0 for read
+  int chunk_size; // Size of data to read/write
+} Operation;
+
+static Operation *ops = NULL;
+static char write_data[MAX_CHUNK_SIZE];
+static char read_data[MAX_CHUNK_SIZE];
+static int chunk = 0;
+
+// Each case runs on a buffer in the classic mode and on one in power-of-two
+// mode, passed as `ctx`.
+
+// one op is a write of `chunk` bytes followed by a read of them
+static void run_plain_chunk(void *ctx, long iters) {
+  RingBuffer *plain = ctx;
+  for (long i = 0; i < iters; i++) {
+    RingBuffer_write(plain, write_data, chunk);
+    RingBuffer_read(plain, read_data, chunk);
+  }
+  bench_escape(read_data);
+}
+
+static void run_posix_chunk(void *ctx, long iters) {
+  PosixRingBuffer *posix = ctx;
+  for (long i = 0; i < iters; i++) {
+    PosixRingBuffer_write(posix, write_data, chunk);
+    PosixRingBuffer_read(posix, read_data, chunk);
+  }
+  bench_escape(read_data);
+}
+
+// one op is one of the random reads/writes, clamped to what fits
+static void run_plain_mixed(void *ctx, long iters) {
+  RingBuffer *plain = ctx;
+  for (long i = 0; i < iters; i++) {
+    Operation *op = &ops[i % NUM_OPERATIONS];
+    int size = op->chunk_size;
+
+    if (op->is_write) {
+      int available = RingBuffer_available_space(plain);
+      if (available <= 0)
+        continue;
+      RingBuffer_write(plain, write_data, size < available ? size : available);
+    } else {
+      int available = RingBuffer_available_data(plain);
+      if (available <= 0)
+        continue;
+      RingBuffer_read(plain, read_data, size < available ? size : available);
+    }
+  }
+  bench_escape(read_data);
+}
+
+static void run_posix_mixed(void *ctx, long iters) {
+  PosixRingBuffer *posix = ctx;
+  for (long i = 0; i < iters; i++) {
+    Operation *op = &ops[i % NUM_OPERATIONS];
+
+    if (op->is_write) {
+      PosixRingBuffer_write(posix, write_data, op->chunk_size);
+    } else {
+      PosixRingBuffer_read(posix, read_data, op->chunk_size);
+    }
+  }
+  bench_escape(read_data);
+}
+
+// one op is a record of `chunk` bytes into a full recorder, so every one
+// drops an old one first
+static void run_recorder(void *ctx, long iters) {
+  RingBuffer *recorder = ctx;
+  for (long i = 0; i < iters; i++) {
+    RingBuffer_record(recorder, write_data, chunk);
+  }
+  bench_escape(recorder->buffer);
+}
+
+// ---- messages of `chunk` bytes, 32 written then 32 read per op: framed by
+// hand on the byte API, copying each one out, against the message API
+// reading them in place
+
+#define MSG_BATCH 32
+
+static void run_posix_framed_copy(void *ctx, long iters) {
+  PosixRingBuffer *posix = ctx;
+  uint32_t length = chunk;
+  long sum = 0;
+
+  for (long i = 0; i < iters; i++) {
+    for (int m = 0; m < MSG_BATCH; m++) {
+      PosixRingBuffer_write(posix, (char *)&length, sizeof(length));
+      PosixRingBuffer_write(posix, write_data, length);
+    }
+    for (int m = 0; m < MSG_BATCH; m++) {
+      PosixRingBuffer_read(posix, (char *)&length, sizeof(length));
+      PosixRingBuffer_read(posix, read_data, length);
+      sum += read_data[0];
+    }
+  }
+  bench_escape(&sum);
+}
+
+static void run_posix_msgs(void *ctx, long iters) {
+  PosixRingBuffer *posix = ctx;
+  PosixRingBufferMsg msgs[MSG_BATCH];
+  long sum = 0;
+
+  for (long i = 0; i < iters; i++) {
+    for (int m = 0; m < MSG_BATCH; m++) {
+      PosixRingBuffer_write_msg(posix, write_data, chunk);
+    }
+    int count = PosixRingBuffer_read_msgs(posix, msgs, MSG_BATCH);
+    for (int m = 0; m < count; m++) {
+      sum += msgs[m].data[0];
+    }
+    PosixRingBuffer_release_msgs(posix, count);
+  }
+  bench_escape(&sum);
+}
+
+static void msg_benches(PosixRingBuffer *posix_pow2) {
+  int sizes[] = {16, 256};
+  char name[64];
+
+  // the mixed ops leave bytes behind that would read as garbage lengths
+  while (!PosixRingBuffer_empty(posix_pow2)) {
+    PosixRingBuffer_read(posix_pow2, read_data, MAX_CHUNK_SIZE);
+  }
+  PosixRingBuffer_set_msg_align(posix_pow2, POSIX_RINGBUFFER_MSG_ALIGN);
+
+  for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+    chunk = sizes[i];
+    snprintf(name, sizeof(name), "PosixRingBuffer pow2 framed copy/%d", chunk);
+    bench_run(.name = name, .run = run_posix_framed_copy, .ctx = posix_pow2,
+              .items_per_op = MSG_BATCH);
+    snprintf(name, sizeof(name), "PosixRingBuffer pow2 msgs in place/%d",
+             chunk);
+    bench_run(.name = name, .run = run_posix_msgs, .ctx = posix_pow2,
+              .items_per_op = MSG_BATCH);
+  }
+}
+
+// ---- backing options, a fresh ring per sample so the faults of the first
+// touch count against the options that leave them to the hot path
+
+typedef struct {
+  const char *name;
+  PosixRingBufferOptions options;
+  PosixRingBuffer *ring;
+} OptionsCase;
+
+static void options_setup(void *ctx, long iters) {
+  OptionsCase *c = ctx;
+  (void)iters;
+  c->ring = PosixRingBuffer_create_opts(TEST_BUFFER_SIZE, &c->options);
+  // the probe passed, but e.g. the huge page pool can run dry between
+  // samples, and the harness can't drop a sample once it started
+  if (c->ring == NULL) {
+    fprintf(stderr, "PosixRingBuffer %s: create failed mid-case\n", c->name);
+    exit(1);
+  }
+}
+
+static void options_teardown(void *ctx) {
+  OptionsCase *c = ctx;
+  PosixRingBuffer_destroy(c->ring);
+}
+
+static void run_options(void *ctx, long iters) {
+  OptionsCase *c = ctx;
+  run_posix_chunk(c->ring, iters);
+}
+
+static void options_benches() {
+  static OptionsCase cases[] = {
+      {"4K pages", {0, 0}, NULL},
+      {"4K pages+populate", {POSIX_RINGBUFFER_POPULATE, 0}, NULL},
+      {"THP+populate", {POSIX_RINGBUFFER_THP | POSIX_RINGBUFFER_POPULATE, 0},
+       NULL},
+      {"hugetlb+populate",
+       {POSIX_RINGBUFFER_HUGETLB | POSIX_RINGBUFFER_POPULATE, 0},
+       NULL},
+      {"NUMA node 0+populate",
+       {POSIX_RINGBUFFER_BIND | POSIX_RINGBUFFER_POPULATE, 0},
+       NULL},
+  };
+  char name[64];
+
+  chunk = 4096;
+  for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+    PosixRingBuffer *probe =
+        PosixRingBuffer_create_opts(TEST_BUFFER_SIZE, &cases[i].options);
+    if (probe == NULL) {
+      printf("PosixRingBuffer %s: unavailable here, skipped\n", cases[i].name);
+      continue;
+    }
+    PosixRingBuffer_destroy(probe);
+
+    snprintf(name, sizeof(name), "PosixRingBuffer %s write+read/4096",
+             cases[i].name);
+    bench_run(.name = name, .setup = options_setup, .run = run_options,
+              .teardown = options_teardown, .ctx = &cases[i],
+              .bytes_per_op = 2 * chunk);
+  }
+}
+
+void all_benches() {
+  srand(42);
+
+  ops = malloc(sizeof(Operation) * NUM_OPERATIONS);
+  for (int i = 0; i < NUM_OPERATIONS; i++) {
+    ops[i].is_write = rand() % 2 == 0;
+    ops[i].chunk_size = rand() % MAX_CHUNK_SIZE + 1;
+  }
+
+  for (int i = 0; i < MAX_CHUNK_SIZE; i++) {
+    write_data[i] = (char)(rand() % 256);
+  }
+
+  // created once, shared by every sample and touched up front so page
+  // faults don't end up in the numbers
+  RingBuffer *plain = RingBuffer_create(TEST_BUFFER_SIZE);
+  RingBuffer *plain_pow2 = RingBuffer_create_pow2(TEST_BUFFER_SIZE);
+  PosixRingBuffer *posix = PosixRingBuffer_create(TEST_BUFFER_SIZE);
+  PosixRingBuffer *posix_pow2 = PosixRingBuffer_create_pow2(TEST_BUFFER_SIZE);
+
+  memset(plain->buffer, 0, plain->length);
+  memset(plain_pow2->buffer, 0, plain_pow2->mask + 1);
+  memset(posix->buffer, 0, posix->capacity);
+  memset(posix_pow2->buffer, 0, posix_pow2->capacity);
+
+  chunk = 64;
+  bench_run(.name = "RingBuffer write+read/64", .run = run_plain_chunk,
+            .ctx = plain, .bytes_per_op = 2 * chunk);
+  bench_run(.name = "RingBuffer pow2 write+read/64", .run = run_plain_chunk,
+            .ctx = plain_pow2, .bytes_per_op = 2 * chunk);
+  bench_run(.name = "PosixRingBuffer write+read/64", .run = run_posix_chunk,
+            .ctx = posix, .bytes_per_op = 2 * chunk);
+  bench_run(.name = "PosixRingBuffer pow2 write+read/64",
+            .run = run_posix_chunk, .ctx = posix_pow2,
+            .bytes_per_op = 2 * chunk);
+
+  chunk = 4096;
+  bench_run(.name = "RingBuffer write+read/4096", .run = run_plain_chunk,
+            .ctx = plain, .bytes_per_op = 2 * chunk);
+  bench_run(.name = "RingBuffer pow2 write+read/4096", .run = run_plain_chunk,
+            .ctx = plain_pow2, .bytes_per_op = 2 * chunk);
+  bench_run(.name = "PosixRingBuffer write+read/4096", .run = run_posix_chunk,
+            .ctx = posix, .bytes_per_op = 2 * chunk);
+  bench_run(.name = "PosixRingBuffer pow2 write+read/4096",
+            .run = run_posix_chunk, .ctx = posix_pow2,
+            .bytes_per_op = 2 * chunk);
+
+  bench_run(.name = "RingBuffer mixed random ops", .run = run_plain_mixed,
+            .ctx = plain);
+  bench_run(.name = "RingBuffer pow2 mixed random ops", .run = run_plain_mixed,
+            .ctx = plain_pow2);
+  bench_run(.name = "PosixRingBuffer mixed random ops", .run = run_posix_mixed,
+            .ctx = posix);
+  bench_run(.name = "PosixRingBuffer pow2 mixed random ops",
+            .run = run_posix_mixed, .ctx = posix_pow2);
+
+  msg_benches(posix_pow2);
+
+  RingBuffer *recorder = RingBuffer_create_recorder(TEST_BUFFER_SIZE);
+  chunk = 64;
+  while (RingBuffer_dropped(recorder) == 0) {
+    RingBuffer_record(recorder, write_data, chunk);
+  }
+  bench_run(.name = "RingBuffer recorder overwrite/64", .run = run_recorder,
+            .ctx = recorder, .bytes_per_op = chunk);
+  RingBuffer_destroy(recorder);
+
+  RingBuffer_destroy(plain);
+  RingBuffer_destroy(plain_pow2);
+  PosixRingBuffer_destroy(posix);
+  PosixRingBuffer_destroy(posix_pow2);
+
+  options_benches();
+  free(ops);
+}
+
+RUN_BENCHES(all_benches);
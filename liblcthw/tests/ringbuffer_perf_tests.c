@@ -3,44 +3,13 @@
 #include <lcthw/dbg.h>
 #include <lcthw/posix_ringbuffer.h>
 #include <lcthw/ringbuffer.h>
-#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
-#include <sys/time.h>
 #include <time.h>
 
-#define TEST_BUFFER_SIZE 4096 * 10240
-#define NUM_OPERATIONS 1000000       // operations
 #define MAX_CHUNK_SIZE 8192          // Maximum chunk size 8KB
 
-// Use 64-bit integers to avoid overflow
-typedef struct {
-    int64_t bytes_written;
-    int64_t bytes_read;
-    double elapsed_time;
-} TestResult;
-
-// Generate identical random operations for both tests
-typedef struct {
-    int is_write;       // 1 for write, 0 for read
-    int chunk_size;     // Size of data to read/write
-} Operation;
-
-// Generate test operations once
-Operation *generate_test_operations(int count, unsigned int seed) {
-    Operation *ops = malloc(count * sizeof(Operation));
-    assert(ops != NULL);
-    
-    srand(seed);
-    for (int i = 0; i < count; i++) {
-        ops[i].is_write = (rand() % 2 == 0) ? 1 : 0;
-        ops[i].chunk_size = rand() % MAX_CHUNK_SIZE + 1;
-    }
-    
-    return ops;
-}
-
 // Helper function to generate random data
 void generate_random_data(char *buffer, int size, unsigned int *seed) {
     for (int i = 0; i < size; i++) {
@@ -48,143 +17,6 @@ void generate_random_data(char *buffer, int size, unsigned int *seed) {
     }
 }
 
-// Get current time in microseconds
-uint64_t get_time_usec() {
-    struct timeval tv;
-    gettimeofday(&tv, NULL);
-    return (uint64_t)tv.tv_sec * 1000000 + tv.tv_usec;
-}
-
-// Test the performance of the plain RingBuffer
-TestResult test_plain_ringbuffer_performance(Operation *ops, int num_ops, unsigned int data_seed) {
-    printf("Testing Plain RingBuffer Performance...\n");
-    
-    TestResult result = {0, 0, 0};
-    RingBuffer *buffer = RingBuffer_create(TEST_BUFFER_SIZE);
-    assert(buffer != NULL);
-    
-    char *write_data = malloc(MAX_CHUNK_SIZE);
-    char *read_data = malloc(MAX_CHUNK_SIZE);
-    assert(write_data != NULL && read_data != NULL);
-    
-    unsigned int seed = data_seed;
-    uint64_t start_time = get_time_usec();
-    
-    for (int i = 0; i < num_ops; i++) {
-        if (ops[i].is_write) {
-            // Write operation
-            int chunk_size = ops[i].chunk_size;
-            int available = RingBuffer_available_space(buffer);
-            
-            if (available <= 0) continue;
-            if (chunk_size > available) chunk_size = available;
-            
-            generate_random_data(write_data, chunk_size, &seed);
-            int written = RingBuffer_write(buffer, write_data, chunk_size);
-            
-            if (written > 0) {
-                result.bytes_written += written;
-            }
-        } else {
-            // Read operation
-            int chunk_size = ops[i].chunk_size;
-            int available = RingBuffer_available_data(buffer);
-            
-            if (available <= 0) continue;
-            if (chunk_size > available) chunk_size = available;
-            
-            int read = RingBuffer_read(buffer, read_data, chunk_size);
-            
-            if (read > 0) {
-                result.bytes_read += read;
-            }
-        }
-    }
-    
-    uint64_t end_time = get_time_usec();
-    result.elapsed_time = (end_time - start_time) / 1000000.0;
-    
-    printf("Plain RingBuffer Results:\n");
-    printf("  Total operations: %d\n", num_ops);
-    printf("  Total bytes written: %lld\n", (long long)result.bytes_written);
-    printf("  Total bytes read: %lld\n", (long long)result.bytes_read);
-    printf("  Elapsed time: %.3f seconds\n", result.elapsed_time);
-    printf("  Throughput: %.2f MB/s\n", 
-           ((double)result.bytes_written + (double)result.bytes_read) / 
-           (1024.0 * 1024.0 * result.elapsed_time));
-    
-    free(write_data);
-    free(read_data);
-    RingBuffer_destroy(buffer);
-    
-    return result;
-}
-
-// Test the performance of the PosixRingBuffer
-TestResult test_posix_ringbuffer_performance(Operation *ops, int num_ops, unsigned int data_seed) {
-    printf("\nTesting PosixRingBuffer Performance...\n");
-    
-    TestResult result = {0, 0, 0};
-    PosixRingBuffer *buffer = PosixRingBuffer_create(TEST_BUFFER_SIZE);
-    assert(buffer != NULL);
-    
-    char *write_data = malloc(MAX_CHUNK_SIZE);
-    char *read_data = malloc(MAX_CHUNK_SIZE);
-    assert(write_data != NULL && read_data != NULL);
-    
-    unsigned int seed = data_seed;
-    uint64_t start_time = get_time_usec();
-    
-    for (int i = 0; i < num_ops; i++) {
-        if (ops[i].is_write) {
-            // Write operation
-            int chunk_size = ops[i].chunk_size;
-            int available = PosixRingBuffer_available_space(buffer);
-            
-            if (available <= 0) continue;
-            if (chunk_size > available) chunk_size = available;
-            
-            generate_random_data(write_data, chunk_size, &seed);
-            int written = PosixRingBuffer_write(buffer, write_data, chunk_size);
-            
-            if (written > 0) {
-                result.bytes_written += written;
-            }
-        } else {
-            // Read operation
-            int chunk_size = ops[i].chunk_size;
-            int available = PosixRingBuffer_available_data(buffer);
-            
-            if (available <= 0) continue;
-            if (chunk_size > available) chunk_size = available;
-            
-            int read = PosixRingBuffer_read(buffer, read_data, chunk_size);
-            
-            if (read > 0) {
-                result.bytes_read += read;
-            }
-        }
-    }
-    
-    uint64_t end_time = get_time_usec();
-    result.elapsed_time = (end_time - start_time) / 1000000.0;
-    
-    printf("PosixRingBuffer Results:\n");
-    printf("  Total operations: %d\n", num_ops);
-    printf("  Total bytes written: %lld\n", (long long)result.bytes_written);
-    printf("  Total bytes read: %lld\n", (long long)result.bytes_read);
-    printf("  Elapsed time: %.3f seconds\n", result.elapsed_time);
-    printf("  Throughput: %.2f MB/s\n", 
-           ((double)result.bytes_written + (double)result.bytes_read) / 
-           (1024.0 * 1024.0 * result.elapsed_time));
-    
-    free(write_data);
-    free(read_data);
-    PosixRingBuffer_destroy(buffer);
-    
-    return result;
-}
-
 char *test_ringbuffer_consistency() {
     printf("\nRunning consistency test between implementations...\n");
   
@@ -301,63 +133,12 @@ char *test_ringbuffer_consistency() {
 
 char *all_tests() {
     mu_suite_start();
-    
-    // First run the consistency test
+
+    // The throughput comparison lives in tests/ringbuffer_bench.c, run it
+    // with `make bench`.
     mu_run_test(test_ringbuffer_consistency);
-    
-    // Generate operations for performance tests
-    unsigned int seed = time(NULL);
-    printf("\nUsing random seed: %u\n", seed);
-    
-    unsigned int data_seed = seed;
-    Operation *ops = generate_test_operations(NUM_OPERATIONS, seed);
-    
-    // Run performance tests with identical operations
-    TestResult plain_result = test_plain_ringbuffer_performance(ops, NUM_OPERATIONS, data_seed);
-    TestResult posix_result = test_posix_ringbuffer_performance(ops, NUM_OPERATIONS, data_seed);
-    
-    // Compare results
-    printf("\nPerformance Comparison:\n");
-    printf("  Plain RingBuffer: %.2f MB/s\n", 
-           ((double)plain_result.bytes_written + (double)plain_result.bytes_read) / 
-           (1024.0 * 1024.0 * plain_result.elapsed_time));
-    printf("  Posix RingBuffer: %.2f MB/s\n", 
-           ((double)posix_result.bytes_written + (double)posix_result.bytes_read) / 
-           (1024.0 * 1024.0 * posix_result.elapsed_time));
-    printf("  Speedup: %.2fx\n", 
-           ((double)posix_result.bytes_written + (double)posix_result.bytes_read) * plain_result.elapsed_time / 
-           (((double)plain_result.bytes_written + (double)plain_result.bytes_read) * posix_result.elapsed_time));
-    
-    free(ops);
+
     return NULL;
 }
 
 RUN_TESTS(all_tests);
-
-
-// Consistency test results:
-//   Plain buffer: wrote 151143 bytes, read 102491 bytes
-//   Posix buffer: wrote 151143 bytes, read 102491 bytes
-
-// Using random seed: 1742305647
-// Testing Plain RingBuffer Performance...
-// Plain RingBuffer Results:
-//   Total operations: 1000000
-//   Total bytes written: 133667395
-//   Total bytes read: 133282451
-//   Elapsed time: 0.804 seconds
-//   Throughput: 316.71 MB/s
-// 读写量明显要低很多，应该是由于该RingBuffer的实现中，如果检查到空闲空间不足会直接返回错误，而不是写入尽可能多的数据。
-
-// Testing PosixRingBuffer Performance...
-// PosixRingBuffer Results:
-//   Total operations: 1000000
-//   Total bytes written: 2048198886
-//   Total bytes read: 2043543178
-//   Elapsed time: 10.831 seconds
-//   Throughput: 360.29 MB/s
-
-// Performance Comparison:
-//   Plain RingBuffer: 316.71 MB/s
-//   Posix RingBuffer: 360.29 MB/s
-//   Speedup: 1.14x
\ No newline at end of file
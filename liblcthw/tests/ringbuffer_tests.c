@@ -2,7 +2,10 @@
 #include "minunit.h"
 #include <lcthw/ringbuffer.h>
 #include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
+#include <unistd.h>
 
 #define BUFFER_SIZE 10
 
@@ -85,6 +88,118 @@ char *test_gets() {
     return NULL;
 }
 
+char *test_pow2() {
+    RingBuffer *ring = RingBuffer_create_pow2(10);
+    mu_assert(ring != NULL, "Failed to create the power-of-two buffer.");
+    mu_assert(ring->mask == 15, "Capacity should round up to 16.");
+    mu_assert(RingBuffer_empty(ring), "Buffer should start empty.");
+    mu_assert(RingBuffer_available_space(ring) == 16, "Every byte should be usable.");
+
+    // counters near the top of their range, the data runs off the end
+    // of the buffer and the counters wrap around zero
+    ring->head = ring->tail = UINT64_MAX - 5;
+
+    char *data = "0123456789abcdef";
+    mu_assert(RingBuffer_write(ring, data, 16) == 16, "Failed to fill the buffer.");
+    mu_assert(RingBuffer_full(ring), "Buffer should be full.");
+    mu_assert(RingBuffer_write(ring, data, 1) == -1, "Write to a full buffer should fail.");
+    mu_assert(RingBuffer_available_data(ring) == 16, "Wrong data count.");
+
+    char read_data[17] = {0};
+    mu_assert(RingBuffer_read(ring, read_data, 10) == 10, "Failed to read.");
+    mu_assert(memcmp(read_data, data, 10) == 0, "Wrong data across the end.");
+
+    bstring rest = RingBuffer_gets(ring, 6);
+    mu_assert(rest != NULL && biseqcstr(rest, "abcdef"), "Wrong gets across the end.");
+    mu_assert(RingBuffer_empty(ring), "Buffer should be empty again.");
+    bdestroy(rest);
+
+    RingBuffer_destroy(ring);
+    return NULL;
+}
+
+char *test_recorder() {
+    RingBuffer *ring = RingBuffer_create_recorder(64);
+    mu_assert(ring != NULL, "Failed to create the recorder.");
+    mu_assert(RingBuffer_record(ring, "x", 61) == -1, "A record past the capacity went in.");
+
+    // 1000 records "000".."999" of 3 bytes, 7 bytes framed: the last 9 fit
+    char data[4];
+    for (int i = 0; i < 1000; i++) {
+        snprintf(data, sizeof(data), "%03d", i);
+        mu_assert(RingBuffer_record(ring, data, 3) == 3, "Recorder refused a record.");
+    }
+    mu_assert(RingBuffer_dropped(ring) == 991 * 3, "Wrong dropped byte count.");
+    mu_assert(RingBuffer_available_data(ring) == 9 * 7, "Wrong bytes held.");
+
+    // the snapshot is the framed records, and leaves them there
+    char path[] = "/tmp/lcthw-recorder-XXXXXX";
+    int fd = mkstemp(path);
+    mu_assert(fd != -1, "mkstemp failed.");
+    close(fd);
+    mu_assert(RingBuffer_snapshot(ring, path) == 0, "Snapshot failed.");
+
+    FILE *file = fopen(path, "rb");
+    char dump[128];
+    size_t dumped = fread(dump, 1, sizeof(dump), file);
+    fclose(file);
+    unlink(path);
+    mu_assert(dumped == 9 * 7, "Snapshot has the wrong size.");
+
+    char read_data[8];
+    for (int i = 991; i < 1000; i++) {
+        uint32_t length;
+        memcpy(&length, dump + (i - 991) * 7, sizeof(length));
+        snprintf(data, sizeof(data), "%03d", i);
+        mu_assert(length == 3 && memcmp(dump + (i - 991) * 7 + 4, data, 3) == 0,
+                  "Snapshot doesn't hold the newest records.");
+
+        mu_assert(RingBuffer_read_record(ring, read_data, 2) == -1,
+                  "Read a record into a short target.");
+        mu_assert(RingBuffer_read_record(ring, read_data, sizeof(read_data)) == 3,
+                  "Failed to read a record.");
+        mu_assert(memcmp(read_data, data, 3) == 0, "Records out of order.");
+    }
+    mu_assert(RingBuffer_read_record(ring, read_data, sizeof(read_data)) == RINGBUFFER_NO_RECORD,
+              "Read from an empty recorder.");
+
+    // an empty record is a record, draining doesn't stop at it
+    RingBuffer_record(ring, "ab", 2);
+    RingBuffer_record(ring, NULL, 0);
+    RingBuffer_record(ring, "cde", 3);
+    int lengths[4];
+    int records = 0;
+    int n = 0;
+    while (records < 4 && (n = RingBuffer_read_record(ring, read_data, sizeof(read_data))) >= 0) {
+        lengths[records++] = n;
+    }
+    mu_assert(records == 3 && n == RINGBUFFER_NO_RECORD, "Drain stopped early.");
+    mu_assert(lengths[0] == 2 && lengths[1] == 0 && lengths[2] == 3,
+              "Wrong records drained.");
+    mu_assert(memcmp(read_data, "cde", 3) == 0, "Wrong last record.");
+
+    // the copy step of a snapshot only touches memory
+    RingBuffer_record(ring, "xyz", 3);
+    size_t size = 0;
+    char *copy = RingBuffer_snapshot_copy(ring, &size);
+    mu_assert(copy != NULL && size == 7, "Snapshot copy has the wrong size.");
+    mu_assert(memcmp(copy + 4, "xyz", 3) == 0, "Snapshot copy is wrong.");
+    free(copy);
+    RingBuffer_read_record(ring, read_data, sizeof(read_data));
+
+    // one big record drops everything before it
+    RingBuffer_record(ring, "abc", 3);
+    RingBuffer_record(ring, "defgh", 5);
+    char big[60] = {0};
+    mu_assert(RingBuffer_record(ring, big, sizeof(big)) == sizeof(big),
+              "A record filling the recorder should fit.");
+    mu_assert(RingBuffer_dropped(ring) == 991 * 3 + 8, "Wrong dropped count after a big record.");
+    mu_assert(RingBuffer_full(ring), "Recorder should be exactly full.");
+
+    RingBuffer_destroy(ring);
+    return NULL;
+}
+
 char *all_tests() {
     mu_suite_start();
 
@@ -94,6 +209,8 @@ char *all_tests() {
     mu_run_test(test_wraparound);
     mu_run_test(test_gets);
     mu_run_test(test_destroy);
+    mu_run_test(test_pow2);
+    mu_run_test(test_recorder);
 
     return NULL;
 }
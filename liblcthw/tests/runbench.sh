@@ -0,0 +1,22 @@
+echo "Running benchmarks:"
+
+# every benchmark appends one JSON object per case to this file
+BENCH_JSON=${BENCH_JSON:-tests/bench.json}
+export BENCH_JSON
+rm -f $BENCH_JSON
+
+for i in tests/*_bench; do
+  if test -f $i; then
+    if ./$i 2>>tests/bench.log; then
+      echo $i DONE
+    else
+      echo "ERROR in benchmark $i: here's tests/bench.log"
+      echo "------"
+      tail tests/bench.log
+      exit 1
+    fi
+  fi
+done
+
+echo ""
+echo "Results written to $BENCH_JSON"
@@ -0,0 +1,217 @@
+#include "minunit.h"
+#include <lcthw/shm_ringbuffer.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#define MESSAGES 100000
+
+char *test_write_read() {
+  ShmRingBuffer *ring = ShmRingBuffer_create(NULL, 4096);
+  mu_assert(ring != NULL, "Failed to create the ring.");
+  mu_assert(ring->capacity == (size_t)sysconf(_SC_PAGESIZE),
+            "Capacity should round up to a page.");
+  mu_assert(ShmRingBuffer_available_data(ring) == 0, "Should be empty.");
+  mu_assert(ShmRingBuffer_available_space(ring) == (int)ring->capacity,
+            "Should have all the space.");
+
+  char out[64];
+  char in[64];
+  for (int i = 0; i < (int)sizeof(out); i++) {
+    out[i] = 'a' + i % 26;
+  }
+
+  // walk the indices around the end several times
+  for (size_t done = 0; done < ring->capacity * 3; done += sizeof(out)) {
+    mu_assert(ShmRingBuffer_write(ring, out, sizeof(out)) == sizeof(out),
+              "Short write.");
+    mu_assert(ShmRingBuffer_read(ring, in, sizeof(in)) == sizeof(in),
+              "Short read.");
+    mu_assert(memcmp(in, out, sizeof(out)) == 0, "Wrong bytes read.");
+  }
+
+  // writes stop when full, reads when empty
+  while (ShmRingBuffer_write(ring, out, sizeof(out)) > 0) {
+  }
+  mu_assert(ShmRingBuffer_available_space(ring) == 0, "Should be full.");
+  mu_assert(ShmRingBuffer_available_data(ring) == (int)ring->capacity,
+            "Full ring should hold capacity bytes.");
+  while (ShmRingBuffer_read(ring, in, sizeof(in)) > 0) {
+  }
+  mu_assert(ShmRingBuffer_available_data(ring) == 0, "Should be empty.");
+
+  ShmRingBuffer_destroy(ring);
+  return NULL;
+}
+
+char *test_timeout() {
+  ShmRingBuffer *ring = ShmRingBuffer_create(NULL, 4096);
+  mu_assert(ring != NULL, "Failed to create the ring.");
+
+  mu_assert(ShmRingBuffer_wait_data(ring, 1, 20) == -1,
+            "Waiting on an empty ring should time out.");
+  mu_assert(ShmRingBuffer_wait_space(ring, 1, 20) == (int)ring->capacity,
+            "Space should be there without waiting.");
+  mu_assert(ShmRingBuffer_wait_data(ring, ring->capacity + 1, 0) == -1,
+            "Can't wait for more than the ring holds.");
+
+  ShmRingBuffer_write(ring, "x", 1);
+  mu_assert(ShmRingBuffer_wait_data(ring, 1, 20) == 1,
+            "Data should be there without waiting.");
+
+  ShmRingBuffer_destroy(ring);
+  return NULL;
+}
+
+// Writes MESSAGES counters in odd sized chunks, blocking whenever the
+// ring is full. Runs in the child.
+static int produce(ShmRingBuffer *ring) {
+  uint32_t batch[7];
+  uint32_t next = 0;
+
+  while (next < MESSAGES) {
+    int count = 0;
+    while (count < 7 && next < MESSAGES) {
+      batch[count++] = next++;
+    }
+    int size = count * sizeof(uint32_t);
+    if (ShmRingBuffer_wait_space(ring, size, 5000) < size) {
+      return 1;
+    }
+    if (ShmRingBuffer_write(ring, (char *)batch, size) != size) {
+      return 1;
+    }
+  }
+
+  return 0;
+}
+
+static char *consume(ShmRingBuffer *ring, pid_t child) {
+  uint32_t value = 0;
+  int status = 0;
+
+  for (uint32_t expect = 0; expect < MESSAGES; expect++) {
+    mu_assert(ShmRingBuffer_wait_data(ring, sizeof(value), 5000) >=
+                  (int)sizeof(value),
+              "Producer stalled.");
+    mu_assert(ShmRingBuffer_read(ring, (char *)&value, sizeof(value)) ==
+                  sizeof(value),
+              "Short read.");
+    mu_assert(value == expect, "Values arrived out of order.");
+  }
+
+  mu_assert(waitpid(child, &status, 0) == child, "Lost the child.");
+  mu_assert(WIFEXITED(status) && WEXITSTATUS(status) == 0,
+            "Producer failed.");
+  mu_assert(ShmRingBuffer_available_data(ring) == 0, "Leftover data.");
+  return NULL;
+}
+
+char *test_attach_by_name() {
+  char name[64];
+  snprintf(name, sizeof(name), "/lcthw-test-%d", (int)getpid());
+
+  // a small ring so both sides block a lot
+  ShmRingBuffer *ring = ShmRingBuffer_create(name, 4096);
+  mu_assert(ring != NULL, "Failed to create the named ring.");
+  mu_assert(ShmRingBuffer_create(name, 4096) == NULL,
+            "A name can only be created once.");
+
+  pid_t child = fork();
+  mu_assert(child != -1, "fork failed.");
+  if (child == 0) {
+    ShmRingBuffer *other = ShmRingBuffer_attach(name);
+    _exit(other == NULL || produce(other));
+  }
+
+  char *message = consume(ring, child);
+  ShmRingBuffer_destroy(ring);
+  mu_assert(ShmRingBuffer_attach(name) == NULL,
+            "The creator should unlink the name.");
+  return message;
+}
+
+char *test_attach_by_fd() {
+  ShmRingBuffer *ring = ShmRingBuffer_create(NULL, 4096);
+  mu_assert(ring != NULL, "Failed to create the ring.");
+
+  pid_t child = fork();
+  mu_assert(child != -1, "fork failed.");
+  if (child == 0) {
+    // as a process that was handed the fd would
+    ShmRingBuffer *other = ShmRingBuffer_attach_fd(ShmRingBuffer_fd(ring));
+    _exit(other == NULL || produce(other));
+  }
+
+  char *message = consume(ring, child);
+  ShmRingBuffer_destroy(ring);
+  return message;
+}
+
+char *test_attach_garbage() {
+  FILE *file = tmpfile();
+  mu_assert(file != NULL, "tmpfile failed.");
+
+  mu_assert(ShmRingBuffer_attach_fd(fileno(file)) == NULL,
+            "An empty file isn't a ring.");
+
+  char junk[3 * 4096];
+  memset(junk, 'x', sizeof(junk));
+  fwrite(junk, 1, sizeof(junk), file);
+  fflush(file);
+  mu_assert(ShmRingBuffer_attach_fd(fileno(file)) == NULL,
+            "A file of junk isn't a ring.");
+
+  fclose(file);
+  return NULL;
+}
+
+char *test_corrupt_indices() {
+  ShmRingBuffer *ring = ShmRingBuffer_create(NULL, 4096);
+  mu_assert(ring != NULL, "Failed to create the ring.");
+  char data[64] = {0};
+
+  // a peer that moved its index past the other's
+  ring->header->head = 1;
+  mu_assert(ShmRingBuffer_write(ring, data, sizeof(data)) == -1,
+            "Head past the tail should be rejected.");
+  mu_assert(ShmRingBuffer_read(ring, data, sizeof(data)) == -1,
+            "Head past the tail should be rejected.");
+  mu_assert(ShmRingBuffer_available_data(ring) == -1,
+            "Head past the tail should be rejected.");
+  // without a timeout these would never return
+  mu_assert(ShmRingBuffer_wait_data(ring, 1, -1) == -1,
+            "Waiting on a corrupt ring should fail.");
+
+  // or claims more than the ring holds
+  ring->header->head = 0;
+  ring->header->tail = ring->capacity + 1;
+  mu_assert(ShmRingBuffer_read(ring, data, sizeof(data)) == -1,
+            "Tail a lap ahead should be rejected.");
+  mu_assert(ShmRingBuffer_available_space(ring) == -1,
+            "Tail a lap ahead should be rejected.");
+  // a spin count nobody would pick is clamped, not spun through
+  ring->header->space.spin = UINT32_MAX;
+  mu_assert(ShmRingBuffer_wait_space(ring, 1, -1) == -1,
+            "Waiting on a corrupt ring should fail.");
+
+  ShmRingBuffer_destroy(ring);
+  return NULL;
+}
+
+char *all_tests() {
+  mu_suite_start();
+
+  mu_run_test(test_write_read);
+  mu_run_test(test_timeout);
+  mu_run_test(test_attach_by_name);
+  mu_run_test(test_attach_by_fd);
+  mu_run_test(test_attach_garbage);
+  mu_run_test(test_corrupt_indices);
+
+  return NULL;
+}
+
+RUN_TESTS(all_tests);
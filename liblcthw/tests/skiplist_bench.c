@@ -0,0 +1,209 @@
+#include "bench.h"
+#include <lcthw/list.h>
+#include <lcthw/list_algos.h>
+#include <lcthw/skiplist.h>
+#include <pthread.h>
+#include <stdlib.h>
+
+#define KEYS 100000
+#define SORTED_KEYS 10000 // List_insert_sorted is O(n) per key, keep it small.
+#define RANGE 100
+#define THREADS 4
+
+static long keys[KEYS];
+static SkipList *skiplist = NULL;
+static List *sorted = NULL;
+static long build_keys = KEYS;
+
+static int long_cmp(const void *a, const void *b) {
+  long x = *(const long *)a;
+  long y = *(const long *)b;
+  return (x > y) - (x < y);
+}
+
+static void skiplist_new(void *ctx, long iters) {
+  (void)ctx;
+  (void)iters;
+  skiplist = SkipList_create(long_cmp);
+}
+
+static void skiplist_concurrent_new(void *ctx, long iters) {
+  (void)ctx;
+  (void)iters;
+  skiplist = SkipList_create_concurrent(long_cmp);
+}
+
+static void skiplist_free(void *ctx) {
+  (void)ctx;
+  SkipList_destroy(skiplist);
+}
+
+static void list_free(void *ctx) {
+  (void)ctx;
+  List_destroy(sorted);
+}
+
+// ---- one op builds a map of `build_keys` keys -------------------------------
+
+static void run_build_skiplist(void *ctx, long iters) {
+  (void)ctx;
+  for (long i = 0; i < iters; i++) {
+    SkipList_destroy(skiplist);
+    skiplist = SkipList_create(long_cmp);
+    for (long k = 0; k < build_keys; k++) {
+      SkipList_set(skiplist, &keys[k], &keys[k]);
+    }
+  }
+}
+
+static void run_build_sorted_list(void *ctx, long iters) {
+  (void)ctx;
+  for (long i = 0; i < iters; i++) {
+    sorted = List_create();
+    for (long k = 0; k < build_keys; k++) {
+      ListNode *node = calloc(1, sizeof(ListNode));
+      node->value = &keys[k];
+      List_insert_sorted(sorted, node, long_cmp);
+    }
+    if (i < iters - 1) {
+      List_destroy(sorted);
+    }
+  }
+}
+
+static void *set_worker(void *arg) {
+  long t = (long)arg;
+  for (long k = t; k < KEYS; k += THREADS) {
+    SkipList_set(skiplist, &keys[k], &keys[k]);
+  }
+  return NULL;
+}
+
+static void run_build_concurrent(void *ctx, long iters) {
+  (void)ctx;
+  pthread_t threads[THREADS];
+
+  for (long i = 0; i < iters; i++) {
+    SkipList_destroy(skiplist);
+    skiplist = SkipList_create_concurrent(long_cmp);
+
+    for (long t = 0; t < THREADS; t++) {
+      pthread_create(&threads[t], NULL, set_worker, (void *)t);
+    }
+    for (int t = 0; t < THREADS; t++) {
+      pthread_join(threads[t], NULL);
+    }
+  }
+}
+
+// ---- lookups in a map of KEYS keys ------------------------------------------
+
+static void filled(void *ctx, long iters) {
+  (void)ctx;
+  (void)iters;
+  skiplist = SkipList_create(long_cmp);
+  sorted = List_create();
+
+  for (long k = 0; k < KEYS; k++) {
+    SkipList_set(skiplist, &keys[k], &keys[k]);
+  }
+  SKIPLIST_FOREACH(skiplist, node) { List_push(sorted, node->key); }
+}
+
+static void filled_free(void *ctx) {
+  skiplist_free(ctx);
+  list_free(ctx);
+}
+
+static void run_get(void *ctx, long iters) {
+  (void)ctx;
+  for (long i = 0; i < iters; i++) {
+    void *val = SkipList_get(skiplist, &keys[(i * 7919) % KEYS]);
+    bench_do_not_optimize(val);
+  }
+}
+
+static int sum_key(void *ctx, void *key, void *value) {
+  (void)value;
+  *(long *)ctx += *(long *)key;
+  return 0;
+}
+
+// RANGE keys from a random starting key
+static void run_range_skiplist(void *ctx, long iters) {
+  (void)ctx;
+  long sum = 0;
+  for (long i = 0; i < iters; i++) {
+    SkipListNode *node = SkipList_seek(skiplist, &keys[(i * 7919) % KEYS]);
+    for (int n = 0; node != NULL && n < RANGE; n++) {
+      sum += *(long *)node->key;
+      node = SkipList_next(node);
+    }
+  }
+  bench_do_not_optimize(sum);
+}
+
+static void run_range_callback(void *ctx, long iters) {
+  (void)ctx;
+  long sum = 0;
+  for (long i = 0; i < iters; i++) {
+    long from = keys[(i * 7919) % KEYS];
+    long to = from + RANGE * (1L << 31) / KEYS;
+    SkipList_range(skiplist, &from, &to, sum_key, &sum);
+  }
+  bench_do_not_optimize(sum);
+}
+
+static void run_range_sorted_list(void *ctx, long iters) {
+  (void)ctx;
+  long sum = 0;
+  for (long i = 0; i < iters; i++) {
+    long from = keys[(i * 7919) % KEYS];
+    ListNode *node = sorted->first;
+    while (node != NULL && *(long *)node->value < from) {
+      node = node->next;
+    }
+    for (int n = 0; node != NULL && n < RANGE; n++) {
+      sum += *(long *)node->value;
+      node = node->next;
+    }
+  }
+  bench_do_not_optimize(sum);
+}
+
+void all_benches() {
+  srand(42);
+  for (long k = 0; k < KEYS; k++) {
+    keys[k] = ((long)rand() << 16 ^ rand()) & 0x7fffffff;
+  }
+
+  build_keys = SORTED_KEYS;
+  bench_run(.name = "List_insert_sorted build/10000",
+            .run = run_build_sorted_list, .teardown = list_free,
+            .items_per_op = SORTED_KEYS);
+  bench_run(.name = "SkipList_set build/10000", .setup = skiplist_new,
+            .run = run_build_skiplist, .teardown = skiplist_free,
+            .items_per_op = SORTED_KEYS);
+
+  build_keys = KEYS;
+  bench_run(.name = "SkipList_set build/100000", .setup = skiplist_new,
+            .run = run_build_skiplist, .teardown = skiplist_free,
+            .items_per_op = KEYS);
+  bench_run(.name = "SkipList_set concurrent x4 build/100000",
+            .setup = skiplist_concurrent_new, .run = run_build_concurrent,
+            .teardown = skiplist_free, .items_per_op = KEYS);
+
+  bench_run(.name = "SkipList_get/100000", .setup = filled, .run = run_get,
+            .teardown = filled_free);
+  bench_run(.name = "SkipList_seek+100/100000", .setup = filled,
+            .run = run_range_skiplist, .teardown = filled_free,
+            .items_per_op = RANGE);
+  bench_run(.name = "SkipList_range ~100/100000", .setup = filled,
+            .run = run_range_callback, .teardown = filled_free,
+            .items_per_op = RANGE);
+  bench_run(.name = "sorted List scan+100/100000", .setup = filled,
+            .run = run_range_sorted_list, .teardown = filled_free,
+            .items_per_op = RANGE);
+}
+
+RUN_BENCHES(all_benches);
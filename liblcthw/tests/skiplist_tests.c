@@ -0,0 +1,242 @@
+#include "minunit.h"
+#include <lcthw/bstrlib.h>
+#include <lcthw/skiplist.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define NUM_KEYS 1000
+#define NUM_THREADS 4
+
+static SkipList *list = NULL;
+static long keys[NUM_KEYS];
+
+static int long_cmp(const void *a, const void *b) {
+  long x = *(const long *)a;
+  long y = *(const long *)b;
+  return (x > y) - (x < y);
+}
+
+// Checks every level is in key order and level 0 holds `count` nodes.
+static int ordered(SkipList *l, int count) {
+  for (int i = 0; i < SKIPLIST_MAX_LEVEL; i++) {
+    SkipListNode *prev = NULL;
+    for (SkipListNode *cur = l->head->next[i]; cur; cur = cur->next[i]) {
+      if (prev && l->cmp(prev->key, cur->key) >= 0)
+        return 0;
+      if (i == 0)
+        count--;
+      prev = cur;
+    }
+  }
+
+  return count == 0;
+}
+
+static int sum_range(void *ctx, void *key, void *value) {
+  (void)value;
+  *(long *)ctx += *(long *)key;
+  return 0;
+}
+
+static int stop_at_third(void *ctx, void *key, void *value) {
+  (void)key;
+  (void)value;
+  return ++*(int *)ctx == 3 ? 42 : 0;
+}
+
+char *test_create() {
+  list = SkipList_create(long_cmp);
+  mu_assert(list != NULL, "Failed to create skip list.");
+  mu_assert(SkipList_count(list) == 0, "New list should be empty.");
+  mu_assert(SkipList_first(list) == NULL, "New list has no first node.");
+  mu_assert(SkipList_create(NULL) == NULL, "A compare function is needed.");
+
+  return NULL;
+}
+
+char *test_set_get() {
+  srand(42);
+
+  // even keys only, in random order, so odd keys can be looked for
+  for (int i = 0; i < NUM_KEYS; i++) {
+    keys[i] = 2 * i;
+  }
+  for (int i = NUM_KEYS - 1; i > 0; i--) {
+    int j = rand() % (i + 1);
+    long tmp = keys[i];
+    keys[i] = keys[j];
+    keys[j] = tmp;
+  }
+
+  for (int i = 0; i < NUM_KEYS; i++) {
+    mu_assert(SkipList_set(list, &keys[i], &keys[i]) == 0, "Set failed.");
+  }
+
+  mu_assert(SkipList_count(list) == NUM_KEYS, "Wrong count after set.");
+  mu_assert(ordered(list, NUM_KEYS), "Keys out of order.");
+
+  for (long k = 0; k < 2 * NUM_KEYS; k++) {
+    long *found = SkipList_get(list, &k);
+    if (k % 2) {
+      mu_assert(found == NULL, "Found a key that was never set.");
+    } else {
+      mu_assert(found != NULL && *found == k, "Key not found.");
+    }
+  }
+
+  // setting an existing key replaces its value
+  static long replacement = -1;
+  long k = 10;
+  mu_assert(SkipList_set(list, &k, &replacement) == 0, "Replace failed.");
+  mu_assert(SkipList_get(list, &k) == &replacement, "Value not replaced.");
+  mu_assert(SkipList_count(list) == NUM_KEYS, "Replace changed the count.");
+
+  long expect = 0;
+  SKIPLIST_FOREACH(list, cur) {
+    mu_assert(*(long *)cur->key == expect, "Iteration out of order.");
+    expect += 2;
+  }
+
+  return NULL;
+}
+
+char *test_range() {
+  long from = 99;
+  long to = 200;
+  long sum = 0;
+
+  SkipListNode *node = SkipList_seek(list, &from);
+  mu_assert(node && *(long *)node->key == 100, "Seek should round up.");
+
+  long past = 2 * NUM_KEYS;
+  mu_assert(SkipList_seek(list, &past) == NULL, "Seek past the end.");
+
+  // [100, 200) holds 100, 102 ... 198
+  mu_assert(SkipList_range(list, &from, &to, sum_range, &sum) == 0,
+            "Range failed.");
+  mu_assert(sum == (100 + 198) * 50 / 2, "Wrong range sum.");
+
+  sum = 0;
+  SkipList_range(list, NULL, NULL, sum_range, &sum);
+  mu_assert(sum == (long)(NUM_KEYS - 1) * NUM_KEYS, "Wrong full range sum.");
+
+  int calls = 0;
+  mu_assert(SkipList_range(list, NULL, NULL, stop_at_third, &calls) == 42,
+            "Range should return the callback's stop value.");
+  mu_assert(calls == 3, "Range didn't stop.");
+
+  return NULL;
+}
+
+char *test_delete() {
+  long missing = 1;
+  mu_assert(SkipList_delete(list, &missing) == NULL, "Deleted a missing key.");
+
+  for (long k = 0; k < 2 * NUM_KEYS; k += 4) {
+    mu_assert(SkipList_delete(list, &k) != NULL, "Delete failed.");
+  }
+
+  mu_assert(SkipList_count(list) == NUM_KEYS / 2, "Wrong count after delete.");
+  mu_assert(ordered(list, NUM_KEYS / 2), "Delete broke the order.");
+
+  for (long k = 0; k < 2 * NUM_KEYS; k += 2) {
+    void *found = SkipList_get(list, &k);
+    mu_assert((found == NULL) == (k % 4 == 0), "Wrong keys left.");
+  }
+
+  for (long k = 2; k < 2 * NUM_KEYS; k += 4) {
+    SkipList_delete(list, &k);
+  }
+
+  mu_assert(SkipList_count(list) == 0, "List should be empty.");
+  mu_assert(list->level == 1, "Empty list should drop its levels.");
+
+  SkipList_destroy(list);
+
+  return NULL;
+}
+
+char *test_bstring_keys() {
+  SkipList *names = SkipList_create((SkipList_compare)bstrcmp);
+  struct tagbstring b = bsStatic("bravo");
+  struct tagbstring a = bsStatic("alpha");
+  struct tagbstring c = bsStatic("charlie");
+  bstring lookup = bfromcstr("bravo");
+
+  SkipList_set(names, &b, "2");
+  SkipList_set(names, &c, "3");
+  SkipList_set(names, &a, "1");
+
+  mu_assert(strcmp(SkipList_get(names, lookup), "2") == 0,
+            "bstring key not found.");
+  mu_assert(SkipList_first(names)->key == &a, "bstrings out of order.");
+
+  bdestroy(lookup);
+  SkipList_destroy(names);
+
+  return NULL;
+}
+
+static long shared_keys[NUM_THREADS * NUM_KEYS];
+
+static void *insert_worker(void *arg) {
+  long t = (long)arg;
+
+  // threads interleave their keys so they keep landing next to each other,
+  // and every thread also sets the first keys to race on the same spots
+  for (long i = 0; i < NUM_KEYS; i++) {
+    long *key = &shared_keys[i * NUM_THREADS + t];
+    SkipList_set(list, key, key);
+    SkipList_set(list, &shared_keys[i % 16], &shared_keys[i % 16]);
+  }
+
+  return NULL;
+}
+
+char *test_concurrent_set() {
+  pthread_t threads[NUM_THREADS];
+
+  for (long i = 0; i < NUM_THREADS * NUM_KEYS; i++) {
+    shared_keys[i] = i;
+  }
+
+  list = SkipList_create_concurrent(long_cmp);
+  mu_assert(list != NULL, "Failed to create a concurrent list.");
+
+  for (long t = 0; t < NUM_THREADS; t++) {
+    pthread_create(&threads[t], NULL, insert_worker, (void *)t);
+  }
+  for (int t = 0; t < NUM_THREADS; t++) {
+    pthread_join(threads[t], NULL);
+  }
+
+  mu_assert(SkipList_count(list) == NUM_THREADS * NUM_KEYS,
+            "Concurrent sets lost or duplicated keys.");
+  mu_assert(ordered(list, NUM_THREADS * NUM_KEYS),
+            "Concurrent sets broke the order.");
+
+  for (long k = 0; k < NUM_THREADS * NUM_KEYS; k++) {
+    long *found = SkipList_get(list, &k);
+    mu_assert(found && *found == k, "Concurrently set key not found.");
+  }
+
+  SkipList_destroy(list);
+
+  return NULL;
+}
+
+char *all_tests() {
+  mu_suite_start();
+
+  mu_run_test(test_create);
+  mu_run_test(test_set_get);
+  mu_run_test(test_range);
+  mu_run_test(test_delete);
+  mu_run_test(test_bstring_keys);
+  mu_run_test(test_concurrent_set);
+
+  return NULL;
+}
+
+RUN_TESTS(all_tests);
@@ -47,11 +47,50 @@ char *test_push_pop()
     return NULL;
 }
 
+char *test_push_pop_n()
+{
+    void *out[NUM_TESTS + 1] = {NULL};
+    void *many[500];
+    int i = 0;
+
+    Stack_push(stack, tests[0]);
+    mu_assert(Stack_push_n(stack, (void **)tests, NUM_TESTS) == 0,
+            "Stack_push_n failed.");
+    mu_assert(Stack_count(stack) == NUM_TESTS + 1, "Wrong count on push_n.");
+    mu_assert(Stack_peek(stack) == tests[NUM_TESTS - 1], "Wrong top.");
+
+    // pop_n undoes push_n: values come back in the order they were pushed
+    mu_assert(Stack_pop_n(stack, out, NUM_TESTS) == NUM_TESTS,
+            "Wrong pop_n count.");
+    for(i = 0; i < NUM_TESTS; i++) {
+        mu_assert(out[i] == tests[i], "Wrong value on pop_n.");
+    }
+
+    mu_assert(Stack_pop_n(stack, out, NUM_TESTS + 1) == 1,
+            "pop_n should stop at the bottom.");
+    mu_assert(out[0] == tests[0], "Wrong value on short pop_n.");
+    mu_assert(Stack_pop_n(stack, out, 1) == 0, "Empty stack pop_n.");
+
+    // a batch bigger than the spare capacity grows it once
+    for(i = 0; i < 500; i++) {
+        many[i] = tests[i % NUM_TESTS];
+    }
+    mu_assert(Stack_push_n(stack, many, 500) == 0, "Big push_n failed.");
+    mu_assert(Stack_count(stack) == 500, "Wrong count on big push_n.");
+    mu_assert(stack->darray->max > 500, "No free slot left after push_n.");
+    mu_assert(Stack_pop_n(stack, many, 500) == 500, "Big pop_n failed.");
+    mu_assert(DArray_get(stack->darray, 0) == NULL,
+            "pop_n should clear the popped slots.");
+
+    return NULL;
+}
+
 char *all_tests() {
     mu_suite_start();
 
     mu_run_test(test_create);
     mu_run_test(test_push_pop);
+    mu_run_test(test_push_pop_n);
     mu_run_test(test_destroy);
 
     return NULL;
@@ -0,0 +1,114 @@
+#include "bench.h"
+#include <lcthw/threadpool.h>
+#include <stdio.h>
+#include <time.h>
+#include <unistd.h>
+
+// One op is one task of about `task_ns` of busy work, so ns/op falls with
+// the number of workers until the pool's own overhead dominates.
+#define MAX_ARGS 1024
+
+static ThreadPool *pool = NULL;
+static double spins_per_ns = 1.0;
+static long task_spins = 0;
+static void *args[MAX_ARGS];
+
+static void spin(long n) {
+  for (volatile long i = 0; i < n; i++) {
+  }
+}
+
+// Spins per nanosecond, from the fastest of a few timed runs.
+static void calibrate_spin() {
+  struct timespec start, end;
+  long n = 10000000;
+  double best = 0;
+
+  for (int i = 0; i < 5; i++) {
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    spin(n);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    double ns =
+        (end.tv_sec - start.tv_sec) * 1e9 + (end.tv_nsec - start.tv_nsec);
+    if (best == 0 || ns < best) {
+      best = ns;
+    }
+  }
+
+  spins_per_ns = n / best;
+}
+
+static void spin_range(void *ctx, long begin, long end) {
+  (void)ctx;
+  for (long i = begin; i < end; i++) {
+    spin(task_spins);
+  }
+}
+
+static void spin_task(void *arg) {
+  (void)arg;
+  spin(task_spins);
+}
+
+static void run_serial(void *ctx, long iters) {
+  spin_range(ctx, 0, iters);
+}
+
+static void run_parallel_for(void *ctx, long iters) {
+  (void)ctx;
+  ThreadPool_parallel_for(pool, 0, iters, 1, spin_range, NULL);
+}
+
+static void run_submit_batch(void *ctx, long iters) {
+  (void)ctx;
+  for (long i = 0; i < iters; i += MAX_ARGS) {
+    int n = iters - i < MAX_ARGS ? (int)(iters - i) : MAX_ARGS;
+    ThreadPool_submit_batch(pool, spin_task, args, n);
+  }
+  ThreadPool_wait(pool);
+}
+
+static void run_submit(void *ctx, long iters) {
+  (void)ctx;
+  for (long i = 0; i < iters; i++) {
+    ThreadPool_submit(pool, spin_task, NULL);
+  }
+  ThreadPool_wait(pool);
+}
+
+void all_benches() {
+  static const long task_ns[] = {100, 1000, 10000};
+  static const int threads[] = {1, 2, 4, 8};
+  char name[64];
+
+  calibrate_spin();
+  printf("online CPUs: %ld\n", sysconf(_SC_NPROCESSORS_ONLN));
+
+  for (size_t t = 0; t < sizeof(task_ns) / sizeof(task_ns[0]); t++) {
+    task_spins = (long)(task_ns[t] * spins_per_ns);
+
+    snprintf(name, sizeof(name), "serial %ldns tasks", task_ns[t]);
+    bench_run(.name = name, .run = run_serial);
+
+    for (size_t w = 0; w < sizeof(threads) / sizeof(threads[0]); w++) {
+      pool = ThreadPool_create(threads[w]);
+
+      snprintf(name, sizeof(name), "parallel_for %ldns tasks/%d", task_ns[t],
+               threads[w]);
+      bench_run(.name = name, .run = run_parallel_for);
+
+      snprintf(name, sizeof(name), "submit_batch %ldns tasks/%d", task_ns[t],
+               threads[w]);
+      bench_run(.name = name, .run = run_submit_batch);
+
+      snprintf(name, sizeof(name), "submit %ldns tasks/%d", task_ns[t],
+               threads[w]);
+      bench_run(.name = name, .run = run_submit);
+
+      ThreadPool_destroy(pool);
+    }
+  }
+}
+
+RUN_BENCHES(all_benches);
@@ -0,0 +1,142 @@
+#include "minunit.h"
+#include <lcthw/threadpool.h>
+#include <string.h>
+
+#define NUM_TASKS 10000
+#define NUM_INDEXES 100000
+
+static ThreadPool *pool = NULL;
+static long counter = 0;
+static int hits[NUM_INDEXES];
+
+static void count_task(void *arg) {
+  __atomic_add_fetch(&counter, (long)arg, __ATOMIC_RELAXED);
+}
+
+static void mark_range(void *ctx, long begin, long end) {
+  (void)ctx;
+  for (long i = begin; i < end; i++) {
+    __atomic_add_fetch(&hits[i], 1, __ATOMIC_RELAXED);
+  }
+}
+
+static int all_hit_once(long begin, long end) {
+  for (long i = 0; i < NUM_INDEXES; i++) {
+    if (hits[i] != (i >= begin && i < end))
+      return 0;
+  }
+  return 1;
+}
+
+// Submits from inside a task, so the tasks go on a worker's deque and it has
+// to grow past THREADPOOL_DEQUE_CAPACITY.
+static void fan_out_task(void *arg) {
+  (void)arg;
+  for (int i = 0; i < NUM_TASKS; i++) {
+    ThreadPool_submit(pool, count_task, (void *)1L);
+  }
+}
+
+static void nested_range(void *ctx, long begin, long end) {
+  (void)ctx;
+  for (long i = begin; i < end; i++) {
+    // each outer index runs an inner loop over its own slice
+    ThreadPool_parallel_for(pool, i * 100, (i + 1) * 100, 7, mark_range, NULL);
+  }
+}
+
+char *test_create() {
+  pool = ThreadPool_create(4);
+  mu_assert(pool != NULL, "Failed to create pool.");
+  mu_assert(pool->count == 4, "Wrong worker count.");
+  mu_assert(ThreadPool_create(-1) == NULL, "Negative count should fail.");
+
+  ThreadPool *sized = ThreadPool_create(0);
+  mu_assert(sized != NULL && sized->count >= 1, "Default size failed.");
+  ThreadPool_destroy(sized);
+
+  return NULL;
+}
+
+char *test_submit() {
+  counter = 0;
+
+  for (int i = 0; i < NUM_TASKS; i++) {
+    mu_assert(ThreadPool_submit(pool, count_task, (void *)1L) == 0,
+              "Submit failed.");
+  }
+  ThreadPool_wait(pool);
+  mu_assert(counter == NUM_TASKS, "Not every task ran once.");
+
+  void *args[256];
+  for (int i = 0; i < 256; i++) {
+    args[i] = (void *)(long)i;
+  }
+
+  counter = 0;
+  for (int i = 0; i < 10; i++) {
+    mu_assert(ThreadPool_submit_batch(pool, count_task, args, 256) == 0,
+              "Batch submit failed.");
+  }
+  ThreadPool_wait(pool);
+  mu_assert(counter == 10 * 255 * 256 / 2, "Batch tasks lost.");
+
+  counter = 0;
+  ThreadPool_submit(pool, fan_out_task, NULL);
+  ThreadPool_wait(pool);
+  mu_assert(counter == NUM_TASKS, "Tasks submitted by tasks lost.");
+
+  return NULL;
+}
+
+char *test_parallel_for() {
+  long grains[] = {1, 64, 1000, NUM_INDEXES * 2};
+
+  for (int g = 0; g < 4; g++) {
+    memset(hits, 0, sizeof(hits));
+    mu_assert(ThreadPool_parallel_for(pool, 0, NUM_INDEXES, grains[g],
+                                      mark_range, NULL) == 0,
+              "parallel_for failed.");
+    mu_assert(all_hit_once(0, NUM_INDEXES), "Index missed or run twice.");
+  }
+
+  memset(hits, 0, sizeof(hits));
+  ThreadPool_parallel_for(pool, 17, 17, 1, mark_range, NULL);
+  ThreadPool_parallel_for(pool, 100, 101, 0, mark_range, NULL);
+  mu_assert(all_hit_once(100, 101), "Empty or single ranges went wrong.");
+
+  mu_assert(ThreadPool_parallel_for(pool, 5, 4, 1, mark_range, NULL) == -1,
+            "Backwards range should fail.");
+
+  memset(hits, 0, sizeof(hits));
+  ThreadPool_parallel_for(pool, 0, NUM_INDEXES / 100, 3, nested_range, NULL);
+  mu_assert(all_hit_once(0, NUM_INDEXES), "Nested parallel_for went wrong.");
+
+  return NULL;
+}
+
+char *test_destroy() {
+  counter = 0;
+  for (int i = 0; i < 1000; i++) {
+    ThreadPool_submit(pool, count_task, (void *)1L);
+  }
+
+  // destroy finishes what was submitted first
+  ThreadPool_destroy(pool);
+  mu_assert(counter == 1000, "Destroy dropped tasks.");
+
+  return NULL;
+}
+
+char *all_tests() {
+  mu_suite_start();
+
+  mu_run_test(test_create);
+  mu_run_test(test_submit);
+  mu_run_test(test_parallel_for);
+  mu_run_test(test_destroy);
+
+  return NULL;
+}
+
+RUN_TESTS(all_tests);
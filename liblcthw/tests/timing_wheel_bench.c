@@ -0,0 +1,114 @@
+#include "bench.h"
+#include <lcthw/list.h>
+#include <lcthw/timing_wheel.h>
+#include <stdlib.h>
+
+#define TIMERS 1000000
+#define SPAN 100000
+
+static Timer *timers = NULL;
+static TimingWheel *wheel = NULL;
+static List *timeouts = NULL;
+static long fired = 0;
+
+static void count_fire(Timer *timer, void *data) {
+  (void)timer;
+  (void)data;
+  fired++;
+}
+
+static void wheel_new(void *ctx, long iters) {
+  (void)ctx;
+  (void)iters;
+  wheel = TimingWheel_create(0);
+}
+
+static void wheel_filled(void *ctx, long iters) {
+  (void)ctx;
+  wheel = TimingWheel_create(0);
+  for (long i = 0; i < iters; i++) {
+    TimingWheel_add(wheel, &timers[i % TIMERS], rand() % SPAN);
+  }
+}
+
+static void wheel_free(void *ctx) {
+  (void)ctx;
+  TimingWheel_destroy(wheel);
+}
+
+static void run_add(void *ctx, long iters) {
+  (void)ctx;
+  for (long i = 0; i < iters; i++) {
+    TimingWheel_add(wheel, &timers[i % TIMERS], i % SPAN);
+  }
+}
+
+static void run_cancel(void *ctx, long iters) {
+  (void)ctx;
+  for (long i = 0; i < iters; i++) {
+    TimingWheel_cancel(wheel, &timers[i % TIMERS]);
+  }
+}
+
+static void wheel_dense(void *ctx, long iters) {
+  (void)ctx;
+  wheel = TimingWheel_create(0);
+  for (long i = 0; i < iters; i++) {
+    TimingWheel_add(wheel, &timers[i % TIMERS], rand() % iters);
+  }
+}
+
+// one op is one tick with (on average) one timer expiring on it
+static void run_expire(void *ctx, long iters) {
+  (void)ctx;
+  for (long now = 0; now < iters; now++) {
+    TimingWheel_advance(wheel, now);
+  }
+}
+
+static void list_filled(void *ctx, long iters) {
+  (void)ctx;
+  timeouts = List_create();
+  for (long i = 0; i < iters; i++) {
+    timers[i % TIMERS].expires = rand() % SPAN;
+    List_push(timeouts, &timers[i % TIMERS]);
+  }
+}
+
+static void list_free(void *ctx) {
+  (void)ctx;
+  List_destroy(timeouts);
+}
+
+// the List we replace: every tick scans every timeout, one op is one check
+static void run_list_tick(void *ctx, long iters) {
+  (void)ctx;
+  (void)iters;
+  LIST_FOREACH(timeouts, first, next, cur) {
+    if (((Timer *)cur->value)->expires == SPAN / 2) {
+      fired++;
+    }
+  }
+}
+
+void all_benches() {
+  timers = malloc(sizeof(Timer) * TIMERS);
+  for (int i = 0; i < TIMERS; i++) {
+    Timer_init(&timers[i], count_fire, NULL);
+  }
+  srand(42);
+
+  bench_run(.name = "TimingWheel_add", .setup = wheel_new, .run = run_add,
+            .teardown = wheel_free);
+  bench_run(.name = "TimingWheel_cancel", .setup = wheel_filled,
+            .run = run_cancel, .teardown = wheel_free);
+  bench_run(.name = "TimingWheel_advance (per tick, 1 timer/tick)",
+            .setup = wheel_dense, .run = run_expire, .teardown = wheel_free);
+  bench_run(.name = "List timeout scan (per timer per tick)",
+            .setup = list_filled, .run = run_list_tick,
+            .teardown = list_free);
+
+  free(timers);
+}
+
+RUN_BENCHES(all_benches);
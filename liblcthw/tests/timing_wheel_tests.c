@@ -0,0 +1,164 @@
+#include "minunit.h"
+#include <lcthw/timing_wheel.h>
+
+static TimingWheel *wheel = NULL;
+static uint64_t last_fired = 0;
+static int fired_in_order = 1;
+
+static void record_fire(Timer *timer, void *data) {
+  int *counter = data;
+  (*counter)++;
+
+  if (timer->expires < last_fired) {
+    fired_in_order = 0;
+  }
+  last_fired = timer->expires;
+}
+
+char *test_create() {
+  wheel = TimingWheel_create(0);
+  mu_assert(wheel != NULL, "Failed to create wheel.");
+  mu_assert(TimingWheel_count(wheel) == 0, "Wheel should be empty.");
+
+  return NULL;
+}
+
+char *test_destroy() {
+  TimingWheel_destroy(wheel);
+
+  return NULL;
+}
+
+char *test_add_fire() {
+  int counter = 0;
+  Timer timer;
+  Timer_init(&timer, record_fire, &counter);
+
+  mu_assert(TimingWheel_add(wheel, &timer, 10) == 0, "Failed to add timer.");
+  mu_assert(Timer_pending(&timer), "Timer should be pending.");
+  mu_assert(TimingWheel_count(wheel) == 1, "Wrong count after add.");
+
+  mu_assert(TimingWheel_advance(wheel, 9) == 0, "Fired too early.");
+  mu_assert(counter == 0, "Callback ran too early.");
+
+  mu_assert(TimingWheel_advance(wheel, 10) == 1, "Should fire at 10.");
+  mu_assert(counter == 1, "Callback should have run once.");
+  mu_assert(!Timer_pending(&timer), "Timer should not be pending.");
+  mu_assert(TimingWheel_count(wheel) == 0, "Wrong count after fire.");
+
+  return NULL;
+}
+
+char *test_cancel() {
+  int counter = 0;
+  Timer timer;
+  Timer_init(&timer, record_fire, &counter);
+
+  TimingWheel_add(wheel, &timer, wheel->now + 1000);
+  mu_assert(TimingWheel_cancel(wheel, &timer) == 0, "Cancel failed.");
+  mu_assert(TimingWheel_cancel(wheel, &timer) == -1,
+            "Second cancel should fail.");
+  mu_assert(TimingWheel_count(wheel) == 0, "Wrong count after cancel.");
+
+  TimingWheel_advance(wheel, wheel->now + 2000);
+  mu_assert(counter == 0, "Cancelled timer fired.");
+
+  return NULL;
+}
+
+char *test_cascade() {
+  // spread timers over every level, including ones past the wheel's range
+  uint64_t deltas[] = {0,       1,         255,        256,      257,
+                       65535,   65536,     70000,      16777216, 20000000,
+                       1ULL << 33, (1ULL << 33) + 5};
+  int count = sizeof(deltas) / sizeof(deltas[0]);
+  Timer timers[count];
+  int counter = 0;
+  uint64_t base = wheel->now;
+
+  last_fired = 0;
+  fired_in_order = 1;
+
+  for (int i = 0; i < count; i++) {
+    Timer_init(&timers[i], record_fire, &counter);
+    TimingWheel_add(wheel, &timers[i], base + deltas[i]);
+  }
+
+  for (int i = 0; i < count; i++) {
+    // advance to one tick before each deadline, then onto it
+    if (deltas[i] > 0) {
+      TimingWheel_advance(wheel, base + deltas[i] - 1);
+      mu_assert(counter == i, "Timer fired before its deadline.");
+    }
+
+    TimingWheel_advance(wheel, base + deltas[i]);
+    mu_assert(counter == i + 1, "Timer did not fire at its deadline.");
+  }
+
+  mu_assert(fired_in_order, "Timers fired out of order.");
+  mu_assert(TimingWheel_count(wheel) == 0, "Wrong count after cascade.");
+
+  return NULL;
+}
+
+static void rearm(Timer *timer, void *data) {
+  int *counter = data;
+  (*counter)++;
+
+  if (*counter < 5) {
+    TimingWheel_add(wheel, timer, timer->expires + 100);
+  }
+}
+
+char *test_end_of_time() {
+  int counter = 0;
+  Timer timer;
+  Timer_init(&timer, record_fire, &counter);
+  TimingWheel *late = TimingWheel_create(UINT64_MAX - 1000);
+  mu_assert(late != NULL, "Failed to create wheel.");
+
+  TimingWheel_add(late, &timer, UINT64_MAX - 10);
+  mu_assert(TimingWheel_advance(late, UINT64_MAX) == 1,
+            "Should fire on the way to the end.");
+  mu_assert(TimingWheel_advance(late, UINT64_MAX) == 0,
+            "Advancing to the end again should return.");
+  mu_assert(counter == 1, "Callback should have run once.");
+
+  TimingWheel_destroy(late);
+  return NULL;
+}
+
+char *test_rearm_in_callback() {
+  int counter = 0;
+  Timer timer;
+  Timer_init(&timer, rearm, &counter);
+
+  uint64_t base = wheel->now;
+  TimingWheel_add(wheel, &timer, base + 100);
+
+  // a timer re-armed from its callback fires on a later advance
+  for (uint64_t now = base; now <= base + 1000; now += 10) {
+    TimingWheel_advance(wheel, now);
+  }
+
+  mu_assert(counter == 5, "Timer should have re-armed itself 4 times.");
+  mu_assert(!Timer_pending(&timer), "Timer should be done.");
+
+  return NULL;
+}
+
+char *all_tests() {
+  mu_suite_start();
+
+  mu_run_test(test_create);
+  mu_run_test(test_add_fire);
+  mu_run_test(test_cancel);
+  mu_run_test(test_cascade);
+  mu_run_test(test_rearm_in_callback);
+  mu_run_test(test_end_of_time);
+  mu_run_test(test_destroy);
+
+  return NULL;
+}
+
+RUN_TESTS(all_tests);
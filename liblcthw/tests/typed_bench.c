@@ -0,0 +1,191 @@
+#include "bench.h"
+#include <lcthw/darray.h>
+#include <lcthw/darray_typed.h>
+#include <lcthw/list.h>
+#include <lcthw/list_algos.h>
+#include <lcthw/list_typed.h>
+#include <stdint.h>
+
+// The macro-generated int64 containers against the generic ones holding
+// boxed int64s. Push ops are one value, sort ops sort a whole list of
+// SORT_SIZE values, reported per item.
+#define SORT_SIZE 10000
+
+#define I64_CMP(a, b) (((a) > (b)) - ((a) < (b)))
+
+DARRAY_DEFINE(I64Array, int64_t)
+LIST_DEFINE(I64List, int64_t)
+LIST_SORT_DEFINE(I64List, int64_t, I64_CMP)
+
+static DArray *array = NULL;
+static I64Array *typed_array = NULL;
+static List **lists = NULL;
+static I64List **typed_lists = NULL;
+static long made = 0;
+
+static int boxed_cmp(const void *a, const void *b) {
+  return I64_CMP(*(const int64_t *)a, *(const int64_t *)b);
+}
+
+static uint64_t next_value(uint64_t *state) {
+  *state ^= *state << 13;
+  *state ^= *state >> 7;
+  *state ^= *state << 17;
+  return *state;
+}
+
+// ---- push, one op is appending one value ----------------------------------
+
+static void darray_new(void *ctx, long iters) {
+  (void)ctx;
+  (void)iters;
+  array = DArray_create(sizeof(int64_t), 100);
+}
+
+static void darray_free(void *ctx) {
+  (void)ctx;
+  DArray_clear_destroy(array);
+}
+
+static void run_darray_push(void *ctx, long iters) {
+  (void)ctx;
+  for (long i = 0; i < iters; i++) {
+    int64_t *v = DArray_new(array);
+    *v = i;
+    DArray_push(array, v);
+  }
+}
+
+static void typed_array_new(void *ctx, long iters) {
+  (void)ctx;
+  (void)iters;
+  typed_array = I64Array_create(100);
+}
+
+static void typed_array_free(void *ctx) {
+  (void)ctx;
+  I64Array_destroy(typed_array);
+}
+
+static void run_typed_array_push(void *ctx, long iters) {
+  (void)ctx;
+  for (long i = 0; i < iters; i++) {
+    I64Array_push(typed_array, i);
+  }
+  bench_escape(typed_array->contents);
+}
+
+static void list_new(void *ctx, long iters) {
+  (void)ctx;
+  (void)iters;
+  lists = calloc(1, sizeof(List *));
+  lists[0] = List_create();
+  made = 1;
+}
+
+static void run_list_push(void *ctx, long iters) {
+  (void)ctx;
+  for (long i = 0; i < iters; i++) {
+    int64_t *v = malloc(sizeof(int64_t));
+    *v = i;
+    List_push(lists[0], v);
+  }
+}
+
+static void lists_free(void *ctx) {
+  (void)ctx;
+  for (long i = 0; i < made; i++) {
+    List_clear_destroy(lists[i]);
+  }
+  free(lists);
+}
+
+static void typed_list_new(void *ctx, long iters) {
+  (void)ctx;
+  (void)iters;
+  typed_lists = calloc(1, sizeof(I64List *));
+  typed_lists[0] = I64List_create();
+  made = 1;
+}
+
+static void run_typed_list_push(void *ctx, long iters) {
+  (void)ctx;
+  for (long i = 0; i < iters; i++) {
+    I64List_push(typed_lists[0], i);
+  }
+}
+
+static void typed_lists_free(void *ctx) {
+  (void)ctx;
+  for (long i = 0; i < made; i++) {
+    I64List_destroy(typed_lists[i]);
+  }
+  free(typed_lists);
+}
+
+// ---- sort, both get the same values in the same order ---------------------
+
+static void lists_unsorted(void *ctx, long iters) {
+  (void)ctx;
+  uint64_t state = 88172645463325252ULL;
+
+  lists = calloc(iters, sizeof(List *));
+  for (long i = 0; i < iters; i++) {
+    lists[i] = List_create();
+    for (int j = 0; j < SORT_SIZE; j++) {
+      int64_t *v = malloc(sizeof(int64_t));
+      *v = (int64_t)next_value(&state);
+      List_push(lists[i], v);
+    }
+  }
+  made = iters;
+}
+
+static void run_list_sort(void *ctx, long iters) {
+  (void)ctx;
+  for (long i = 0; i < iters; i++) {
+    List_sort(lists[i], boxed_cmp);
+  }
+}
+
+static void typed_lists_unsorted(void *ctx, long iters) {
+  (void)ctx;
+  uint64_t state = 88172645463325252ULL;
+
+  typed_lists = calloc(iters, sizeof(I64List *));
+  for (long i = 0; i < iters; i++) {
+    typed_lists[i] = I64List_create();
+    for (int j = 0; j < SORT_SIZE; j++) {
+      I64List_push(typed_lists[i], (int64_t)next_value(&state));
+    }
+  }
+  made = iters;
+}
+
+static void run_typed_list_sort(void *ctx, long iters) {
+  (void)ctx;
+  for (long i = 0; i < iters; i++) {
+    I64List_sort(typed_lists[i]);
+  }
+}
+
+void all_benches() {
+  bench_run(.name = "DArray_push boxed int64", .setup = darray_new,
+            .run = run_darray_push, .teardown = darray_free);
+  bench_run(.name = "I64Array_push", .setup = typed_array_new,
+            .run = run_typed_array_push, .teardown = typed_array_free);
+
+  bench_run(.name = "List_push boxed int64", .setup = list_new,
+            .run = run_list_push, .teardown = lists_free);
+  bench_run(.name = "I64List_push", .setup = typed_list_new,
+            .run = run_typed_list_push, .teardown = typed_lists_free);
+
+  bench_run(.name = "List_sort boxed int64", .setup = lists_unsorted,
+            .run = run_list_sort, .teardown = lists_free,
+            .items_per_op = SORT_SIZE);
+  bench_run(.name = "I64List_sort", .setup = typed_lists_unsorted,
+            .run = run_typed_list_sort, .teardown = typed_lists_free,
+            .items_per_op = SORT_SIZE);
+}
+
+RUN_BENCHES(all_benches);
@@ -0,0 +1,117 @@
+#include "minunit.h"
+#include <lcthw/waitq.h>
+#include <pthread.h>
+#include <time.h>
+#include <unistd.h>
+
+// A counter standing in for a ring's index.
+static int value = 0;
+
+static int count(void *ring) {
+  return __atomic_load_n((int *)ring, __ATOMIC_ACQUIRE);
+}
+
+static WaitQueue queue;
+
+static void *bump_later(void *arg) {
+  (void)arg;
+  usleep(20000);
+  __atomic_store_n(&value, 5, __ATOMIC_RELEASE);
+  WaitQueue_wake(&queue);
+  return NULL;
+}
+
+char *test_wait_wake() {
+  pthread_t thread;
+  WaitQueue_init(&queue, 0);
+  value = 0;
+
+  mu_assert(pthread_create(&thread, NULL, bump_later, NULL) == 0,
+            "Failed to start the waker.");
+  int n = WaitQueue_wait(&queue, count, &value, 5, 5000);
+  pthread_join(thread, NULL);
+
+  mu_assert(n == 5, "Woke up without the count reached.");
+  mu_assert(queue.waiting == 0, "The wake should lower the flag.");
+  return NULL;
+}
+
+char *test_timeout() {
+  struct timespec start, end;
+  WaitQueue_init(&queue, 0);
+  value = 1;
+
+  mu_assert(WaitQueue_wait(&queue, count, &value, 1, 0) == 1,
+            "A reached count shouldn't wait.");
+
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  mu_assert(WaitQueue_wait(&queue, count, &value, 2, 30) == -1,
+            "Should time out.");
+  clock_gettime(CLOCK_MONOTONIC, &end);
+
+  long ms = (end.tv_sec - start.tv_sec) * 1000 +
+            (end.tv_nsec - start.tv_nsec) / 1000000;
+  mu_assert(ms >= 29, "Timed out early.");
+  mu_assert(WaitQueue_wake(&queue) == 1,
+            "Only a wake lowers the flag of a timed out waiter.");
+  return NULL;
+}
+
+// Reaches 1 on the second poll.
+static int polls = 0;
+static int count_second(void *ring) {
+  (void)ring;
+  return polls++ > 0;
+}
+
+char *test_spin_budget() {
+  WaitQueue_init(&queue, 0);
+  value = 0;
+
+  // parking halves the budget, but not below the floor
+  queue.spin = WAITQUEUE_SPIN_MIN * 2;
+  WaitQueue_wait(&queue, count, &value, 1, 0);
+  mu_assert(queue.spin == WAITQUEUE_SPIN_MIN, "Parking should halve.");
+  WaitQueue_wait(&queue, count, &value, 1, 0);
+  mu_assert(queue.spin == WAITQUEUE_SPIN_MIN, "Should stop at the floor.");
+
+  // and from the floor polling that pays off still grows it
+  polls = 0;
+  mu_assert(WaitQueue_wait(&queue, count_second, NULL, 1, 0) == 1,
+            "Should see the count on the second poll.");
+  mu_assert(queue.spin == WAITQUEUE_SPIN_MIN * 2,
+            "Polling that paid off should double.");
+  return NULL;
+}
+
+char *test_arm() {
+  WaitQueue_init(&queue, 0);
+  value = 0;
+
+  mu_assert(WaitQueue_wake(&queue) == 0, "Nobody was waiting.");
+  mu_assert(WaitQueue_arm(&queue, count, &value, 1) == 0,
+            "Nothing should be there yet.");
+  mu_assert(queue.waiting == 1, "Arming should raise the flag.");
+
+  value = 1;
+  mu_assert(WaitQueue_wake(&queue) == 1, "The armed side should be woken.");
+  mu_assert(WaitQueue_wake(&queue) == 0, "A wake should disarm.");
+
+  mu_assert(WaitQueue_arm(&queue, count, &value, 1) == 1,
+            "Arming with the count reached should say so.");
+  mu_assert(queue.waiting == 0, "Nothing to wait for, no flag raised.");
+  return NULL;
+}
+
+char *all_tests() {
+  mu_suite_start();
+
+  mu_run_test(test_wait_wake);
+  mu_run_test(test_timeout);
+  mu_run_test(test_arm);
+  mu_run_test(test_spin_budget);
+
+  return NULL;
+}
+
+RUN_TESTS(all_tests);